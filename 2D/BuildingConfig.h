@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Car group restricted to a floor range (zoning for tall buildings). The
+// group's cars serve lowest .. highest plus the lobby and run express past
+// everything else; two zones sharing a floor make it a sky lobby where
+// passengers change cars.
+struct CarZone {
+	int carCount;   // cars of the group, taken in order after the previous zones
+    int lowest;
+    int highest;
+	float carSpeed; // metres per second, 0 = car_speed (express cars are usually faster)
+};
+
+// Building loaded at startup: floors, their heights, cars and door timings.
+// Defaults are the original 8-floor, 4-car building.
+struct BuildingConfig {
+    int floorCount;
+	std::vector<float> storeyHeights; // metres from floor i to floor i + 1 (floorCount - 1 values)
+    int carCount;
+	float carSpeed;          // metres per second
+	float carAccel;          // metres per second^2, 0 = full speed at once
+	float carJerk;           // metres per second^3, 0 = no jerk limit
+	float doorAnimDuration;  // open/close door animation in seconds
+	float doorOpenTime;      // how long the doors stay open, seconds
+	int carCapacity;         // passengers per car
+	float boardTime;         // seconds per passenger getting in
+	float alightTime;        // seconds per passenger getting out
+	float minDwellTime;      // doors open at least this long, and this long after the last passenger
+	float bypassLoad;        // share of capacity from which a car passes hall calls (1 = only when full)
+	int startFloor;          // floor the cars start at
+	int lobbyFloor;          // ground floor (PR), floors below it are basements
+	std::vector<CarZone> zones; // in car order; cars after the last zone serve every floor
+
+    BuildingConfig();
+
+    // Zoning: does car carIndex stop at floorIndex, and how fast it runs
+    bool servesFloor(int carIndex, int floorIndex) const;
+    float getCarSpeed(int carIndex) const;
+
+    // Lowest floor no car stops at, -1 if every floor is served
+    int firstUnservedFloor() const;
+
+    // Height of floor i above floor 0, metres
+    float getFloorElevation(int floorIndex) const;
+    float getBuildingHeight() const { return getFloorElevation(floorCount - 1); }
+    float getMinStoreyHeight() const;
+
+    // Label shown for a floor: SU below the lobby, PR, then 1, 2, ...
+    std::string getFloorLabel(int floorIndex) const;
+};
+
+// Read "key = value" lines ('#' starts a comment) over the defaults already in
+// config; keys missing from the file keep their value. Returns false if the file
+// can't be read or holds a bad value (the reason goes to stderr).
+//
+// Keys: floors, floor_height, storey_heights (one value per storey, bottom up),
+//       cars, car_speed, car_accel, car_jerk, door_anim_time, door_open_time, start_floor, lobby_floor,
+//       car_capacity, board_time, alight_time, min_dwell_time, bypass_load,
+//       zone (repeated: "zone = <cars> <lowest> <highest> [speed]", see CarZone)
+// car_capacity .. bypass_load are the passenger model of headless runs
+// (simulated passengers board and alight, the doors stay open as long as that
+// takes); the app's person gets door_open_time.
+bool loadBuildingConfig(const char* path, BuildingConfig& config);
@@ -5,18 +5,16 @@
 
 ButtonPanel::ButtonPanel() 
     : openButtonIndex(-1), closeButtonIndex(-1), stopButtonIndex(-1), ventilationButtonIndex(-1) {
-    for (int i = 0; i < FLOOR_COUNT; ++i) {
-        floorButtonIndex[i] = -1;
-    }
 }
 
-void ButtonPanel::initialize(int screenWidth, int screenHeight) {
-    createButtons(screenWidth, screenHeight);
+void ButtonPanel::initialize(int screenWidth, int screenHeight, int floorCount) {
+    createButtons(screenWidth, screenHeight, floorCount);
 }
 
-void ButtonPanel::createButtons(int screenWidth, int screenHeight) {
+void ButtonPanel::createButtons(int screenWidth, int screenHeight, int floorCount) {
     buttons.clear();
-    buttons.reserve(12);
+    buttons.reserve(floorCount + 4);
+    floorButtonIndex.assign(floorCount, -1);
 
     float midX = screenWidth / 2.0f;
     float panelCenterX = midX / 2.0f;
@@ -24,41 +22,49 @@ void ButtonPanel::createButtons(int screenWidth, int screenHeight) {
     float btnHeight = 80.0f;
     float rowSpacing = btnHeight + 15.0f;
 	float colOffset = 90.0f; // horizontal offset left/right from center (button columns)
+    float cellWidth = 2.0f * colOffset;
+
+    float floorStartY = (float)screenHeight - 160.0f;
+    float panelWidth = midX - 80.0f;
+    float bottomMargin = 40.0f;
+
+	// Floor buttons in a grid, lowest floors in the top row (2 columns for a
+	// small building). Taller buildings get more columns, and the cells shrink
+	// until the grid and the control rows below it fit on the screen.
+    int cols = 2;
+    int rows = (floorCount + cols - 1) / cols;
+    float scale = 1.0f;
+    for (bool fits = false; !fits && scale > 0.05f;) {
+        int maxCols = (int)(panelWidth / (cellWidth * scale));
+        for (cols = 2; cols <= maxCols || cols == 2; ++cols) {
+            rows = (floorCount + cols - 1) / cols;
+            float ctlBottom = floorStartY - rows * rowSpacing * scale - 1.5f * rowSpacing - btnHeight;
+            if (ctlBottom >= bottomMargin) {
+                fits = true;
+                break;
+            }
+        }
+        if (!fits) scale *= 0.95f;
+    }
+
+    float floorBtnWidth = btnWidth * scale;
+    float floorBtnHeight = btnHeight * scale;
+    for (int f = 0; f < floorCount; ++f) {
+        int row = f / cols;
+        int col = f % cols;
+        float cx = panelCenterX + (col - 0.5f * (cols - 1)) * cellWidth * scale;
+        float yTop = floorStartY - row * rowSpacing * scale;
+        floorButtonIndex[f] = addButton(cx - floorBtnWidth * 0.5f, yTop - floorBtnHeight,
+                                        cx + floorBtnWidth * 0.5f, yTop, ButtonType::Floor, f);
+    }
 
     float colLeftX0 = panelCenterX - colOffset - btnWidth * 0.5f;
     float colLeftX1 = colLeftX0 + btnWidth;
     float colRightX0 = panelCenterX + colOffset - btnWidth * 0.5f;
     float colRightX1 = colRightX0 + btnWidth;
 
-    float floorStartY = (float)screenHeight - 160.0f;
-
-	// Floor buttons 4 rows x 2 columns
-    // row 0: SU (left), PR (right)
-    float yTop0 = floorStartY;
-    float yBot0 = yTop0 - btnHeight;
-    floorButtonIndex[FLOOR_SU] = addButton(colLeftX0, yBot0, colLeftX1, yTop0, ButtonType::Floor, FLOOR_SU);
-    floorButtonIndex[FLOOR_PR] = addButton(colRightX0, yBot0, colRightX1, yTop0, ButtonType::Floor, FLOOR_PR);
-
-    // row 1: 1, 2
-    float yTop1 = floorStartY - rowSpacing;
-    float yBot1 = yTop1 - btnHeight;
-    floorButtonIndex[FLOOR_1] = addButton(colLeftX0, yBot1, colLeftX1, yTop1, ButtonType::Floor, FLOOR_1);
-    floorButtonIndex[FLOOR_2] = addButton(colRightX0, yBot1, colRightX1, yTop1, ButtonType::Floor, FLOOR_2);
-
-    // row 2: 3, 4
-    float yTop2 = floorStartY - 2.0f * rowSpacing;
-    float yBot2 = yTop2 - btnHeight;
-    floorButtonIndex[FLOOR_3] = addButton(colLeftX0, yBot2, colLeftX1, yTop2, ButtonType::Floor, FLOOR_3);
-    floorButtonIndex[FLOOR_4] = addButton(colRightX0, yBot2, colRightX1, yTop2, ButtonType::Floor, FLOOR_4);
-
-    // row 3: 5, 6
-    float yTop3 = floorStartY - 3.0f * rowSpacing;
-    float yBot3 = yTop3 - btnHeight;
-    floorButtonIndex[FLOOR_5] = addButton(colLeftX0, yBot3, colLeftX1, yTop3, ButtonType::Floor, FLOOR_5);
-    floorButtonIndex[FLOOR_6] = addButton(colRightX0, yBot3, colRightX1, yTop3, ButtonType::Floor, FLOOR_6);
-
-    // Control buttons (OPEN/CLOSE, STOP/VENT)
-    float ctlTop1 = floorStartY - 4.5f * rowSpacing;
+    // Control buttons (OPEN/CLOSE, STOP/VENT) half a row below the floor grid
+    float ctlTop1 = floorStartY - rows * rowSpacing * scale - 0.5f * rowSpacing;
     float ctlBot1 = ctlTop1 - btnHeight;
 
     openButtonIndex = addButton(colLeftX0, ctlBot1, colLeftX1, ctlTop1, ButtonType::OpenDoor, -1);
@@ -85,8 +91,7 @@ int ButtonPanel::addButton(float x0, float yBottom, float x1, float yTop, Button
 }
 
 void ButtonPanel::handleClick(float mouseX, float mouseY, bool personInElevator,
-                             ElevatorController& elevatorController, bool& ventilationOn,
-                             std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor) {
+                             ElevatorController& elevatorController, bool& ventilationOn) {
     for (size_t i = 0; i < buttons.size(); ++i) {
         Button& b = buttons[i];
 
@@ -96,10 +101,10 @@ void ButtonPanel::handleClick(float mouseX, float mouseY, bool personInElevator,
             switch (b.type) {
             case ButtonType::Floor: {
                 int fIdx = b.floorIndex;
-                if (fIdx >= 0 && fIdx < FLOOR_COUNT &&
-                    !isFloorAlreadyRequested(fIdx, hasTargetFloor, targetFloor, floorQueue) &&
+                if (fIdx >= 0 && fIdx < (int)floorButtonIndex.size() &&
+                    !elevatorController.getCalls().hasCarCall(fIdx) &&
                     fIdx != elevatorController.getElevator().currentFloor) {
-                    if (elevatorController.requestFloor(fIdx, floorQueue, hasTargetFloor, targetFloor)) {
+                    if (elevatorController.requestFloor(fIdx)) {
                         b.pressed = true;
                     }
                 }
@@ -143,12 +148,11 @@ void ButtonPanel::handleClick(float mouseX, float mouseY, bool personInElevator,
     }
 }
 
-bool ButtonPanel::isFloorAlreadyRequested(int floorIdx, bool hasTargetFloor, int targetFloor,
-                                         const std::vector<int>& floorQueue) const {
-    if (hasTargetFloor && targetFloor == floorIdx) return true;
-    for (int f : floorQueue) {
-        if (f == floorIdx) return true;
+void ButtonPanel::syncFloorButtons(const ElevatorController& elevatorController) {
+    for (int f = 0; f < (int)floorButtonIndex.size(); ++f) {
+        int idx = floorButtonIndex[f];
+        if (idx >= 0) {
+            buttons[idx].pressed = elevatorController.getCalls().hasCarCall(f);
+        }
     }
-    return false;
 }
-
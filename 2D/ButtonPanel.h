@@ -12,22 +12,21 @@ class ButtonPanel {
 public:
     ButtonPanel();
     
-    void initialize(int screenWidth, int screenHeight);
+    void initialize(int screenWidth, int screenHeight, int floorCount);
     
     // Handle mouse click on buttons
     void handleClick(float mouseX, float mouseY, bool personInElevator,
-                    ElevatorController& elevatorController, bool& ventilationOn,
-                    std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor);
+                    ElevatorController& elevatorController, bool& ventilationOn);
     
-    // Check if floor is already requested
-    bool isFloorAlreadyRequested(int floorIdx, bool hasTargetFloor, int targetFloor,
-                                 const std::vector<int>& floorQueue) const;
+    // Light the floor buttons for the requests of the car the panel now belongs to
+    void syncFloorButtons(const ElevatorController& elevatorController);
     
     // Getters
     std::vector<Button>& getButtons() { return buttons; }
     const std::vector<Button>& getButtons() const { return buttons; }
     
     int getFloorButtonIndex(int floor) const { return floorButtonIndex[floor]; }
+    const std::vector<int>& getFloorButtonIndices() const { return floorButtonIndex; }
     int getOpenButtonIndex() const { return openButtonIndex; }
     int getCloseButtonIndex() const { return closeButtonIndex; }
     int getStopButtonIndex() const { return stopButtonIndex; }
@@ -35,13 +34,13 @@ public:
 
 private:
     std::vector<Button> buttons;
-    int floorButtonIndex[FLOOR_COUNT];
+    std::vector<int> floorButtonIndex;
     int openButtonIndex;
     int closeButtonIndex;
     int stopButtonIndex;
     int ventilationButtonIndex;
     
-    void createButtons(int screenWidth, int screenHeight);
+    void createButtons(int screenWidth, int screenHeight, int floorCount);
     int addButton(float x0, float yBottom, float x1, float yTop, ButtonType type, int floorIdx);
 };
 
@@ -0,0 +1,246 @@
+#include "CallRegistry.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+int lowestSetBit(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+int highestSetBit(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(x);
+#endif
+}
+
+void FloorMask::clear() {
+    for (int w = 0; w < WORDS; ++w) {
+        words[w] = 0;
+    }
+}
+
+bool FloorMask::any() const {
+    for (int w = 0; w < WORDS; ++w) {
+        if (words[w]) return true;
+    }
+    return false;
+}
+
+int FloorMask::count() const {
+    int n = 0;
+    for (int w = 0; w < WORDS; ++w) {
+        for (uint64_t x = words[w]; x != 0; x &= x - 1) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+int FloorMask::lowestFrom(int floorIndex) const {
+    if (floorIndex < 0) floorIndex = 0;
+    if (floorIndex >= MAX_FLOORS) return -1;
+
+    int w = floorIndex >> 6;
+    uint64_t x = words[w] & (~0ull << (floorIndex & 63));
+    while (true) {
+        if (x) return (w << 6) + lowestSetBit(x);
+        if (++w == WORDS) return -1;
+        x = words[w];
+    }
+}
+
+int FloorMask::highestBelow(int floorIndex) const {
+    if (floorIndex <= 0) return -1;
+    if (floorIndex > MAX_FLOORS) floorIndex = MAX_FLOORS;
+
+    int last = floorIndex - 1;
+    int w = last >> 6;
+    int top = last & 63;
+    uint64_t x = words[w] & (top == 63 ? ~0ull : (2ull << top) - 1);
+    while (true) {
+        if (x) return (w << 6) + highestSetBit(x);
+        if (--w < 0) return -1;
+        x = words[w];
+    }
+}
+
+FloorMask FloorMask::operator|(const FloorMask& other) const {
+    FloorMask result;
+    for (int w = 0; w < WORDS; ++w) {
+        result.words[w] = words[w] | other.words[w];
+    }
+    return result;
+}
+
+CallRegistry::CallRegistry() {
+    clear();
+}
+
+void CallRegistry::clear() {
+    carCalls.clear();
+    hallUp.clear();
+    hallDown.clear();
+    queued.clear();
+    for (uint8_t& s : stamp) s = 0;
+    ringHead = 0;
+    ringSize = 0;
+}
+
+void CallRegistry::enqueue(int floorIndex) {
+    if (queued.test(floorIndex)) return; // still waiting in the ring, keeps its place
+
+    if (ringSize == MAX_FLOORS) {
+		// full: drop the stale entries (live ones are at most one per queued floor)
+        int kept = 0;
+        for (int i = 0; i < ringSize; ++i) {
+            uint16_t entry = ring[(ringHead + i) % MAX_FLOORS];
+            if (isLive(entry)) ring[(ringHead + kept++) % MAX_FLOORS] = entry;
+        }
+        ringSize = kept;
+    }
+
+    queued.set(floorIndex);
+    ring[(ringHead + ringSize) % MAX_FLOORS] = (uint16_t)(floorIndex | stamp[floorIndex] << 8);
+    ++ringSize;
+}
+
+bool CallRegistry::addCarCall(int floorIndex) {
+    if (floorIndex < 0 || floorIndex >= MAX_FLOORS) return false;
+
+    if (carCalls.test(floorIndex)) return false;
+
+    bool wasRequested = isRequested(floorIndex);
+    carCalls.set(floorIndex);
+    if (!wasRequested) enqueue(floorIndex);
+    return true;
+}
+
+bool CallRegistry::addHallCall(int floorIndex, CallDirection direction) {
+    if (floorIndex < 0 || floorIndex >= MAX_FLOORS) return false;
+
+    if (hasHallCall(floorIndex, direction)) return false;
+
+    bool wasRequested = isRequested(floorIndex);
+    if (direction != CallDirection::Down) hallUp.set(floorIndex);
+    if (direction != CallDirection::Up) hallDown.set(floorIndex);
+    if (!wasRequested) enqueue(floorIndex);
+    return true;
+}
+
+bool CallRegistry::hasHallCall(int floorIndex, CallDirection direction) const {
+    if (floorIndex < 0 || floorIndex >= MAX_FLOORS) return false;
+
+    switch (direction) {
+    case CallDirection::Up:
+        return hallUp.test(floorIndex);
+    case CallDirection::Down:
+        return hallDown.test(floorIndex);
+    case CallDirection::Any:
+    default:
+        return hallUp.test(floorIndex) && hallDown.test(floorIndex);
+    }
+}
+
+void CallRegistry::clearFloor(int floorIndex) {
+    if (floorIndex < 0 || floorIndex >= MAX_FLOORS) return;
+
+    carCalls.reset(floorIndex);
+    hallUp.reset(floorIndex);
+    hallDown.reset(floorIndex);
+    dequeueIfCleared(floorIndex);
+}
+
+void CallRegistry::clearStop(int floorIndex, CallDirection leaving) {
+    if (floorIndex < 0 || floorIndex >= MAX_FLOORS) return;
+
+    carCalls.reset(floorIndex);
+    if (leaving != CallDirection::Down) hallUp.reset(floorIndex);
+    if (leaving != CallDirection::Up) hallDown.reset(floorIndex);
+    dequeueIfCleared(floorIndex);
+}
+
+int CallRegistry::count() const {
+    return stops().count();
+}
+
+int CallRegistry::nextAbove(int floorIndex) const {
+    return stops().lowestFrom(floorIndex + 1);
+}
+
+int CallRegistry::nextBelow(int floorIndex) const {
+    return stops().highestBelow(floorIndex);
+}
+
+int CallRegistry::nextInDirection(int floorIndex, bool up, bool hallCalls) const {
+    if (!hallCalls) return up ? carCalls.lowestFrom(floorIndex + 1) : carCalls.highestBelow(floorIndex);
+
+    FloorMask along = carCalls | (up ? hallUp : hallDown);
+    int next = up ? along.lowestFrom(floorIndex + 1) : along.highestBelow(floorIndex);
+    if (next >= 0) return next;
+
+	// turn at the farthest opposite call ahead
+    if (up) {
+        int turn = hallDown.highestBelow(MAX_FLOORS);
+        return turn > floorIndex ? turn : -1;
+    }
+    int turn = hallUp.lowestFrom(0);
+    return (turn >= 0 && turn < floorIndex) ? turn : -1;
+}
+
+int CallRegistry::nextLookStop(int floorIndex, int& direction, bool hallCalls) const {
+    if (direction == 0) {
+		// no direction yet: go to the nearest stop
+        FloorMask candidates = hallCalls ? stops() : carCalls;
+        int above = candidates.lowestFrom(floorIndex + 1);
+        int below = candidates.highestBelow(floorIndex);
+        if (above < 0 && below < 0) return -1;
+        if (below < 0 || (above >= 0 && above - floorIndex <= floorIndex - below)) {
+            direction = 1;
+            return above;
+        }
+        direction = -1;
+        return below;
+    }
+
+	// keep going while there is something ahead, otherwise reverse
+    int next = nextInDirection(floorIndex, direction > 0, hallCalls);
+    if (next < 0) {
+        next = nextInDirection(floorIndex, direction < 0, hallCalls);
+        if (next >= 0) direction = -direction;
+    }
+    return next;
+}
+
+int CallRegistry::takeOldest() {
+    while (ringSize > 0) {
+        uint16_t entry = ring[ringHead];
+        ringHead = (ringHead + 1) % MAX_FLOORS;
+        --ringSize;
+        if (!isLive(entry)) continue; // cleared since, a new request queued at the back
+
+        int floorIndex = entry & 0xff;
+        queued.reset(floorIndex);
+        if (isRequested(floorIndex)) return floorIndex;
+    }
+    return -1;
+}
+
+int CallRegistry::getQueued(int out[MAX_FLOORS]) const {
+    int n = 0;
+    for (int i = 0; i < ringSize; ++i) {
+        uint16_t entry = ring[(ringHead + i) % MAX_FLOORS];
+        if (isLive(entry)) out[n++] = entry & 0xff;
+    }
+    return n;
+}
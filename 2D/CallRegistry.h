@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+
+// Direction of a hall call; Any for call buttons without direction
+enum class CallDirection {
+    Up,
+    Down,
+    Any
+};
+
+// Order in which a car serves its registered stops
+enum class SchedulingMode {
+	Fifo,   // strictly in request order
+	Look    // keep direction, serve every stop on the way, reverse at the last one
+};
+
+// Fixed-size set of floors, one bit per floor. Scans work a 64-bit word at a
+// time, so the cost grows with floors / 64.
+struct FloorMask {
+    static const int MAX_FLOORS = 256;
+    static const int WORDS = MAX_FLOORS / 64;
+
+    uint64_t words[WORDS];
+
+    void clear();
+    bool test(int floorIndex) const { return (words[floorIndex >> 6] >> (floorIndex & 63)) & 1u; }
+    void set(int floorIndex) { words[floorIndex >> 6] |= 1ull << (floorIndex & 63); }
+    void reset(int floorIndex) { words[floorIndex >> 6] &= ~(1ull << (floorIndex & 63)); }
+    bool any() const;
+    int count() const;
+
+    // Lowest set floor >= floorIndex / highest set floor < floorIndex, -1 if none
+    int lowestFrom(int floorIndex) const;
+    int highestBelow(int floorIndex) const;
+
+    FloorMask operator|(const FloorMask& other) const;
+};
+
+// Per-car registry of pending stops: one bit per floor for car calls and for
+// up/down hall calls. Insert, dedupe, clear on arrival and next stop above/below
+// the car are bit operations. A small ring remembers request order for FIFO
+// service.
+class CallRegistry {
+public:
+    static const int MAX_FLOORS = FloorMask::MAX_FLOORS;
+
+    CallRegistry();
+
+    void clear();
+
+    // Register a call, returns false if the floor already had that call
+    bool addCarCall(int floorIndex);
+    bool addHallCall(int floorIndex, CallDirection direction);
+
+    // Car arrived at the floor: drop every call registered there
+    void clearFloor(int floorIndex);
+
+    // Car stops at the floor and leaves heading `leaving`: drop its car call and
+    // the hall call that way, a hall call the other way waits for a later pass.
+    // Any (no further stops) drops everything like clearFloor().
+    void clearStop(int floorIndex, CallDirection leaving);
+
+    bool isRequested(int floorIndex) const {
+        return floorIndex >= 0 && floorIndex < MAX_FLOORS && (carCalls.test(floorIndex) || hallUp.test(floorIndex) || hallDown.test(floorIndex));
+    }
+    bool hasCarCall(int floorIndex) const { return floorIndex >= 0 && floorIndex < MAX_FLOORS && carCalls.test(floorIndex); }
+    bool hasHallCall(int floorIndex, CallDirection direction) const;
+    bool empty() const { return !stops().any(); }
+    int count() const;
+
+    // Nearest requested floor strictly above/below floorIndex, -1 if none
+    int nextAbove(int floorIndex) const;
+    int nextBelow(int floorIndex) const;
+
+    // Next LOOK stop from floorIndex travelling up/down: the nearest car call or
+    // same-direction hall call ahead, otherwise the farthest opposite hall call
+    // ahead (where the car turns). -1 if nothing is ahead. hallCalls false
+    // looks at car calls only (a full car passing the floors it is called to).
+    int nextInDirection(int floorIndex, bool up, bool hallCalls = true) const;
+
+    // LOOK step: next stop from floorIndex keeping direction (+1/-1), reversing
+    // when nothing is ahead; direction 0 goes to the nearest stop. Updates direction.
+    int nextLookStop(int floorIndex, int& direction, bool hallCalls = true) const;
+
+    // Oldest request still pending and not yet taken, -1 if none.
+    // The floor stays registered until clearFloor().
+    int takeOldest();
+
+    // Pending requests not yet taken, oldest first; returns how many were written
+    int getQueued(int out[MAX_FLOORS]) const;
+
+    // Bit masks (bit i = floor i)
+    FloorMask stops() const { return carCalls | hallUp | hallDown; }
+    const FloorMask& getCarCalls() const { return carCalls; }
+    const FloorMask& getHallUp() const { return hallUp; }
+    const FloorMask& getHallDown() const { return hallDown; }
+
+private:
+    FloorMask carCalls;
+    FloorMask hallUp;
+    FloorMask hallDown;
+	FloorMask queued;     // floors that have a live entry in the ring
+
+	// FIFO order of requests: floor | stamp << 8 per entry. Clearing a floor
+	// bumps its stamp, so its old entry goes stale where it is and is skipped
+	// (or dropped when the ring fills up) instead of being searched for.
+    static_assert(MAX_FLOORS <= 256, "ring entries keep the floor in 8 bits");
+    uint16_t ring[MAX_FLOORS];
+    uint8_t stamp[MAX_FLOORS];
+    int ringHead;
+    int ringSize;
+
+    void enqueue(int floorIndex);
+    bool isLive(uint16_t entry) const {
+        int floorIndex = entry & 0xff;
+        return queued.test(floorIndex) && stamp[floorIndex] == (entry >> 8);
+    }
+    // Nothing registered at the floor any more: its ring entry goes stale
+    void dequeueIfCleared(int floorIndex) {
+        if (queued.test(floorIndex) && !isRequested(floorIndex)) {
+            queued.reset(floorIndex);
+            ++stamp[floorIndex];
+        }
+    }
+};
+
+// Bit scan helpers (x must not be 0)
+int lowestSetBit(uint64_t x);
+int highestSetBit(uint64_t x);
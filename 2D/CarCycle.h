@@ -0,0 +1,61 @@
+#pragma once
+
+// Elevator state enumeration: the regular cycle is Idle -> Moving ->
+// DoorsOpening -> DoorsOpen -> DoorsClosing -> Idle, Stopped is the STOP button
+enum class ElevatorState {
+    Idle,
+    Moving,
+    DoorsOpening,
+    DoorsOpen,
+    DoorsClosing,
+    Stopped
+};
+
+// What a door step changed
+enum class DoorEvent {
+    None,
+	Opened,   // fully open, the timer starts at the open time
+	Closing,  // the open time ran out
+	Closed    // fully closed, the car is Idle
+};
+
+// Door part of the cycle over plain state, the same for every car model (the
+// app's cars and the batched training environment): ratio is 0 closed .. 1
+// open, timer the seconds the doors stay open. Only the door states change.
+
+// Transitions once ratio and timer have moved: fully open starts the timer at
+// openTime, an expired timer starts closing, fully closed makes the car Idle.
+// Inline, the batched environment runs it for every car every substep.
+inline DoorEvent doorTransition(ElevatorState& state, float& ratio, float& timer, float openTime) {
+    switch (state) {
+    case ElevatorState::DoorsOpening:
+        if (ratio >= 1.0f) {
+            ratio = 1.0f;
+            timer = openTime;
+            state = ElevatorState::DoorsOpen;
+            return DoorEvent::Opened;
+        }
+        break;
+    case ElevatorState::DoorsOpen:
+        if (timer <= 0.0f) {
+            timer = 0.0f;
+            state = ElevatorState::DoorsClosing;
+            return DoorEvent::Closing;
+        }
+        break;
+    case ElevatorState::DoorsClosing:
+        if (ratio <= 0.0f) {
+            ratio = 0.0f;
+            state = ElevatorState::Idle;
+            return DoorEvent::Closed;
+        }
+        break;
+    default:
+        break;
+    }
+    return DoorEvent::None;
+}
+
+// Move the doors dt seconds (a full open or close takes animDuration) and
+// apply doorTransition()
+DoorEvent stepDoors(ElevatorState& state, float& ratio, float& timer, float dt, float animDuration, float openTime);
@@ -1,12 +1,24 @@
 #pragma once
 
 // Global constants
-const int FLOOR_COUNT = 8; // SU, PR, 1, 2, 3, 4, 5, 6
-const float DOOR_ANIM_DURATION = 0.3f;   // open/close door animation in seconds
-const float BASE_DOOR_OPEN_TIME = 5.0f;  
+// Floors, cars, speeds and door timings come from the building config (see BuildingConfig.h)
+const char* const BUILDING_CONFIG_FILE = "building.cfg";
 const float PERSON_FLOOR_OFFSET = 10.0f;  // when person is on a floor, offset from the floor y position
 
+// Elevator bank
+const float CAR_SPACING = 50.0f;  // horizontal gap between neighbouring cars (room for the shafts)
+
+// The app simulates in fixed ticks on its own thread (SimThread.h) and draws the state
+// interpolated between the last two, so the frame rate (TARGET_FPS, e.g. 30 on slow kiosks)
+// doesn't change the simulation
+const double SIM_TICK_RATE = 240.0;
+const double SIM_TICK = 1.0 / SIM_TICK_RATE;
+const double MAX_FRAME_TIME = 0.25;  // longer stalls (window dragged, debugger) are not caught up
+
 // FPS limiter
 const double TARGET_FPS = 75.0;
 const double TARGET_FRAME_TIME = 1.0 / TARGET_FPS;
 
+// Headless runs lay the building out as on a 1080p screen
+const float HEADLESS_SCREEN_HEIGHT = 1080.0f;
+
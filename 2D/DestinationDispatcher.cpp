@@ -0,0 +1,165 @@
+#include "DestinationDispatcher.h"
+#include "PassengerPopulation.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+// Time a car loses to one more stop on top of the door cycle (braking and
+// accelerating again), seconds
+static const float STOP_LOSS = 4.0f;
+// Per passenger a car has no room for
+static const float OVERLOAD_PENALTY = 120.0f;
+// Improvement passes over the batch after the greedy placement
+static const int MAX_PASSES = 4;
+
+DestinationDispatcher::DestinationDispatcher(double batchWindow)
+    : batchWindow(batchWindow), openedAt(0.0), batches(0), batchSeconds(0.0) {
+}
+
+void DestinationDispatcher::enter(int passenger, int origin, int destination, double time) {
+    if (pending.empty()) openedAt = time;
+    pending.push_back({ passenger, origin, destination });
+}
+
+double DestinationDispatcher::getBatchTime() const {
+    return pending.empty() ? std::numeric_limits<double>::infinity() : openedAt + batchWindow;
+}
+
+float DestinationDispatcher::placementCost(const ElevatorBank& bank, const Group& g, int groupIndex, int car) const {
+    const ElevatorController& controller = bank.getCar(car).controller;
+    if (!controller.servesFloor(g.destination)) return std::numeric_limits<float>::infinity();
+    int carCount = bank.getCarCount();
+    int floorCount = bank.getFloorCount();
+
+	// the group's own wait
+    float cost = g.size * eta[(size_t)groupIndex * carCount + car];
+
+	// every stop the car doesn't make yet delays everyone it carries or has promised
+    const int* planned = &batchStops[(size_t)car * floorCount];
+    int newStops = 0;
+    if (!stops[car].test(g.origin) && planned[g.origin] == 0) ++newStops;
+    if (!stops[car].test(g.destination) && planned[g.destination] == 0) ++newStops;
+    float stopCost = 2.0f * controller.getDoorAnimDuration() + controller.getExpectedDwell() + STOP_LOSS;
+    cost += newStops * stopCost * (committed[car] + batchPeople[car] + 1);
+
+    int capacity = controller.getCapacity();
+    if (capacity > 0) {
+        int room = capacity - committed[car] - batchPeople[car];
+        if (room < g.size) cost += OVERLOAD_PENALTY * (g.size - std::max(room, 0));
+    }
+    return cost;
+}
+
+void DestinationDispatcher::place(Group& g, int car, int floorCount, int delta) {
+    g.car = car;
+    batchPeople[car] += delta * g.size;
+    batchStops[(size_t)car * floorCount + g.origin] += delta;
+    batchStops[(size_t)car * floorCount + g.destination] += delta;
+}
+
+void DestinationDispatcher::assignBatch(const ElevatorBank& bank, const PassengerPopulation& population,
+                                        std::vector<DestinationAssignment>& out) {
+    out.clear();
+    int carCount = bank.getCarCount();
+    if (pending.empty() || carCount == 0) return;
+    auto start = std::chrono::steady_clock::now();
+    int floorCount = bank.getFloorCount();
+
+	// groups: entries with the same origin and destination, in entry order
+    order.resize(pending.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        const Entry& ea = pending[a];
+        const Entry& eb = pending[b];
+        return ea.origin < eb.origin || (ea.origin == eb.origin && ea.destination < eb.destination);
+    });
+    groups.clear();
+    for (size_t k = 0; k < order.size();) {
+        const Entry& e = pending[order[k]];
+        size_t end = k + 1;
+        while (end < order.size() && pending[order[end]].origin == e.origin &&
+               pending[order[end]].destination == e.destination) {
+            ++end;
+        }
+        CallDirection direction = (e.destination > e.origin) ? CallDirection::Up : CallDirection::Down;
+        groups.push_back({ e.origin, e.destination, direction, (int)(end - k), -1, k });
+        k = end;
+    }
+
+	// what the cars already do: their calls, riders and passengers assigned earlier
+    stops.resize(carCount);
+    committed.assign(carCount, 0);
+    for (int c = 0; c < carCount; ++c) {
+        const ElevatorController& controller = bank.getCar(c).controller;
+        stops[c] = controller.getCalls().stops();
+        committed[c] = controller.getLoad();
+    }
+    for (int id : population.getWaiting()) {
+        int c = population.assignedCar[id];
+        if (c < 0 || c >= carCount) continue;
+        stops[c].set(population.originFloor[id]);
+        stops[c].set(population.legFloor[id]);
+        ++committed[c];
+    }
+    batchPeople.assign(carCount, 0);
+    batchStops.assign((size_t)carCount * floorCount, 0);
+
+    eta.resize(groups.size() * carCount);
+    for (size_t g = 0; g < groups.size(); ++g) {
+        for (int c = 0; c < carCount; ++c) {
+            eta[g * carCount + c] = EtaDispatcher::estimateArrivalTime(bank.getCar(c), bank.getFloors(),
+                                                                       groups[g].origin, groups[g].direction);
+        }
+    }
+
+	// greedy: largest groups pick first
+    groupOrder.resize(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) groupOrder[g] = (int)g;
+    std::stable_sort(groupOrder.begin(), groupOrder.end(), [this](int a, int b) {
+        return groups[a].size > groups[b].size;
+    });
+    for (int g : groupOrder) {
+        int best = 0;
+        float bestCost = placementCost(bank, groups[g], g, 0);
+        for (int c = 1; c < carCount; ++c) {
+            float cost = placementCost(bank, groups[g], g, c);
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = c;
+            }
+        }
+        place(groups[g], best, floorCount, 1);
+    }
+
+	// improve: take one group out and put it back where it costs least, until nothing moves
+    for (int pass = 0; pass < MAX_PASSES && groups.size() > 1; ++pass) {
+        bool moved = false;
+        for (int g : groupOrder) {
+            int from = groups[g].car;
+            place(groups[g], from, floorCount, -1);
+            int best = from;
+            float bestCost = placementCost(bank, groups[g], g, from);
+            for (int c = 0; c < carCount; ++c) {
+                if (c == from) continue;
+                float cost = placementCost(bank, groups[g], g, c);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    best = c;
+                }
+            }
+            place(groups[g], best, floorCount, 1);
+            moved = moved || (best != from);
+        }
+        if (!moved) break;
+    }
+
+    for (const Group& g : groups) {
+        for (int m = 0; m < g.size; ++m) {
+            out.push_back({ pending[order[g.first + m]].passenger, g.car, g.origin, g.direction });
+        }
+    }
+    pending.clear();
+
+    ++batches;
+    batchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ElevatorBank.h"
+#include "CallRegistry.h"
+#include <vector>
+
+class PassengerPopulation;
+
+// Car given to a passenger who keyed in a destination
+struct DestinationAssignment {
+    int passenger;
+    int car;
+    int origin;
+    CallDirection direction;
+};
+
+// Destination dispatch: instead of pressing up/down, passengers enter their
+// destination at a hall kiosk and are told which car to take. Entries are
+// collected for a short batching window (the first entry opens it), then the
+// whole batch is assigned at once. Passengers with the same origin and
+// destination travel as one group; each group goes to the car where it adds
+// the least waiting time plus delay from extra stops, so groups heading to the
+// same floors end up sharing cars. Groups are placed greedily (largest first),
+// then moved one at a time to a better car until no move helps. In a zoned
+// bank the destination is the end of the passenger's current leg and only
+// cars serving both floors are considered.
+class DestinationDispatcher {
+public:
+    explicit DestinationDispatcher(double batchWindow = 1.5);
+
+    // Passenger entered `destination` at `origin`
+    void enter(int passenger, int origin, int destination, double time);
+
+    // When the open batch is due, infinity when nothing is pending
+    double getBatchTime() const;
+    bool isDue(double time) const { return time >= getBatchTime(); }
+
+    // Assign every pending entry (out: one entry per passenger, the caller
+    // registers the hall calls and tells the passengers). Passengers in
+    // `population` already assigned and still waiting count as promised stops
+    // and places of their cars.
+    void assignBatch(const ElevatorBank& bank, const PassengerPopulation& population,
+                     std::vector<DestinationAssignment>& out);
+
+    long long getBatchCount() const { return batches; }
+	double getBatchSeconds() const { return batchSeconds; }  // wall time of all assignments
+
+private:
+    struct Entry {
+        int passenger;
+        int origin;
+        int destination;
+    };
+    struct Group {
+        int origin;
+        int destination;
+        CallDirection direction;
+        int size;
+        int car;
+        size_t first;   // members are entries[order[first .. first + size)]
+    };
+
+    double batchWindow;
+    double openedAt;
+    std::vector<Entry> pending;
+
+	// reused between batches
+    std::vector<size_t> order;
+    std::vector<Group> groups;
+	std::vector<int> groupOrder;     // largest group first
+	std::vector<float> eta;          // group * carCount + car
+	std::vector<FloorMask> stops;    // per car: stops it already makes
+	std::vector<int> committed;      // per car: riders plus promised waiting passengers
+	std::vector<int> batchPeople;    // per car: passengers of this batch
+	std::vector<int> batchStops;     // car * floorCount + floor: groups of this batch stopping there
+
+    long long batches;
+    double batchSeconds;
+
+    float placementCost(const ElevatorBank& bank, const Group& g, int groupIndex, int car) const;
+    void place(Group& g, int car, int floorCount, int delta);
+};
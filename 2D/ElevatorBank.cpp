@@ -0,0 +1,259 @@
+#include "ElevatorBank.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+// A stopped car (STOP pressed) can't tell when it will move again
+static const float STOPPED_CAR_PENALTY = 600.0f;
+// A full car passes hall calls until enough riders got off
+static const float FULL_CAR_PENALTY = 120.0f;
+
+float EtaDispatcher::estimateArrivalTime(const Car& car, const std::vector<Floor>& floors, int floorIndex,
+                                         CallDirection direction) {
+    const ElevatorController& controller = car.controller;
+    if (!controller.servesFloor(floorIndex)) return std::numeric_limits<float>::infinity();
+    const Elevator& elevator = controller.getElevator();
+    float doorAnim = controller.getDoorAnimDuration();
+    float doorOpen = controller.getExpectedDwell();
+	// door cycle at a stop: open animation, dwell, close animation
+    float doorCycle = 2.0f * doorAnim + doorOpen;
+
+	// time before the car can leave its current position
+    float t = 0.0f;
+    switch (elevator.state) {
+    case ElevatorState::DoorsOpening:
+        t = (1.0f - elevator.doorOpenRatio) * doorAnim + doorOpen + doorAnim;
+        break;
+    case ElevatorState::DoorsOpen:
+        t = elevator.doorOpenTimer + doorAnim;
+        break;
+    case ElevatorState::DoorsClosing:
+        t = elevator.doorOpenRatio * doorAnim;
+        break;
+    case ElevatorState::Stopped:
+        t = STOPPED_CAR_PENALTY;
+        break;
+    default:
+        break;
+    }
+    bool full = controller.isBypassing();
+    if (full) t += FULL_CAR_PENALTY;
+
+	// already here, free to go the passenger's way and with room: only the doors need to open
+    CallDirection leaving = controller.leavingDirection();
+    bool rightWay = (direction == CallDirection::Any || leaving == CallDirection::Any || leaving == direction);
+    if (floorIndex == elevator.currentFloor && elevator.state != ElevatorState::Moving &&
+        elevator.state != ElevatorState::Stopped && rightWay && !full) {
+        return 0.0f;
+    }
+
+	// walk the car's stops in service order; a LOOK car also stops on the way
+	// if it can still brake for the call and the call goes its way. The first
+	// leg continues the car's current run, every later one is a rest-to-rest run.
+    int stops[CallRegistry::MAX_FLOORS];
+    int stopCount = controller.getServiceOrder(stops);
+    bool stopsOnTheWay = (controller.getSchedulingMode() == SchedulingMode::Look);
+    float callY = floors[floorIndex].yTop;
+
+    float y = elevator.y;
+    for (int i = 0; i < stopCount; ++i) {
+        int stop = stops[i];
+        float stopY = floors[stop].yTop;
+        bool sameWay = (direction == CallDirection::Any || (direction == CallDirection::Up) == (stopY > y));
+        if (stopsOnTheWay && sameWay && (callY - y) * (stopY - callY) > 0.0f) {
+            float leg = (i == 0) ? controller.timeToReach(floors, floorIndex) : controller.travelTime(std::fabs(callY - y));
+            if (!std::isinf(leg)) return t + leg;
+        }
+        t += (i == 0) ? controller.timeToReach(floors, stop) : controller.travelTime(std::fabs(stopY - y));
+        if (stop == floorIndex) return t;
+        t += doorCycle;
+        y = stopY;
+    }
+
+    return t + (stopCount == 0 ? controller.timeToReach(floors, floorIndex) : controller.travelTime(std::fabs(callY - y)));
+}
+
+int EtaDispatcher::assignHallCall(const ElevatorBank& bank, int floorIndex, CallDirection direction, int legFloor) {
+    int best = 0;
+    float bestTime = 0.0f;
+    for (int i = 0; i < bank.getCarCount(); ++i) {
+        float t = estimateArrivalTime(bank.getCar(i), bank.getFloors(), floorIndex, direction);
+        if (legFloor >= 0 && !bank.getCar(i).controller.servesFloor(legFloor)) t = std::numeric_limits<float>::infinity();
+        if (i == 0 || t < bestTime) {
+            best = i;
+            bestTime = t;
+        }
+    }
+    return best;
+}
+
+ElevatorBank::ElevatorBank() : dispatcher(new EtaDispatcher()), floors(nullptr) {
+}
+
+void ElevatorBank::initialize(int carCount, const std::vector<Floor>& floors, float firstCarX, float carSpacing,
+                              float floorSpacing, int startFloor, float elevatorWidth, float elevatorHeight) {
+    this->floors = &floors;
+    noFloorButtons.assign(floors.size(), -1);
+    cars.clear();
+    cars.resize(carCount < 1 ? 1 : carCount);
+
+    for (size_t i = 0; i < cars.size(); ++i) {
+        Car& car = cars[i];
+        car.controller.initialize(floors, firstCarX + carSpacing * i, floorSpacing, startFloor,
+                                  elevatorWidth, elevatorHeight);
+    }
+}
+
+void ElevatorBank::setMotion(const MotionLimits& limits, float doorAnimDuration, float doorOpenTime) {
+    for (Car& car : cars) {
+        car.controller.setMotion(limits, doorAnimDuration, doorOpenTime);
+    }
+}
+
+void ElevatorBank::setLoadModel(int capacity, float boardTime, float alightTime, float minDwellTime, float bypassLoad) {
+    for (Car& car : cars) {
+        car.controller.setLoadModel(capacity, boardTime, alightTime, minDwellTime, bypassLoad);
+    }
+}
+
+void ElevatorBank::setDispatcher(std::unique_ptr<Dispatcher> newDispatcher) {
+    if (newDispatcher) {
+        dispatcher = std::move(newDispatcher);
+    }
+}
+
+void ElevatorBank::update(float deltaTime, int panelCar, bool& ventilationOn,
+                          const std::vector<int>& floorButtonIndex, std::vector<Button>& buttons,
+                          int ventilationButtonIndex) {
+    for (int i = 0; i < (int)cars.size(); ++i) {
+        Car& car = cars[i];
+        if (i == panelCar) {
+            car.controller.update(deltaTime, *floors, ventilationOn, floorButtonIndex, buttons, ventilationButtonIndex);
+        }
+        else {
+            updateCar(i, deltaTime);
+        }
+    }
+}
+
+void ElevatorBank::updateCar(int carIndex, float deltaTime) {
+    bool noVentilation = false;
+    cars[carIndex].controller.update(deltaTime, *floors, noVentilation, noFloorButtons, noButtons, -1);
+}
+
+int ElevatorBank::hallCall(int floorIndex, CallDirection direction, int legFloor) {
+    if (floorIndex < 0 || floorIndex >= getFloorCount() || cars.empty()) return -1;
+
+	// a car already holding the call takes it (a directional call only joins the same direction)
+    for (int i = 0; i < (int)cars.size(); ++i) {
+        const ElevatorController& controller = cars[i].controller;
+        if (legFloor >= 0 && !controller.servesFloor(legFloor)) continue;
+        bool holds = (direction == CallDirection::Any) ? controller.isFloorRequested(floorIndex)
+                                                       : controller.getCalls().hasHallCall(floorIndex, direction);
+        if (holds) return i;
+    }
+
+    int carIndex = dispatcher->assignHallCall(*this, floorIndex, direction, legFloor);
+    if (carIndex < 0 || carIndex >= (int)cars.size()) carIndex = 0;
+
+    ElevatorController& controller = cars[carIndex].controller;
+    if (!controller.servesFloor(floorIndex)) return -1; // no car stops there
+    if (legFloor >= 0 && !controller.servesFloor(legFloor)) return -1;
+    controller.requestHallCall(floorIndex, direction);
+    return carIndex;
+}
+
+int ElevatorBank::nextLegFloor(int originFloor, int destinationFloor) const {
+    FloorMask fromOrigin;
+    FloorMask toDestination;
+    fromOrigin.clear();
+    toDestination.clear();
+    for (const Car& car : cars) {
+        const FloorMask& served = car.controller.getServedFloors();
+        bool origin = car.controller.servesFloor(originFloor);
+        bool destination = car.controller.servesFloor(destinationFloor);
+        if (origin && destination) return destinationFloor;
+        if (origin) fromOrigin = fromOrigin | served;
+        if (destination) toDestination = toDestination | served;
+    }
+
+	// change cars where the two rides together are shortest, nearer the destination on a tie
+    int best = destinationFloor;
+    int bestLength = -1;
+    for (int f = 0; f < getFloorCount(); ++f) {
+        if (!fromOrigin.test(f) || !toDestination.test(f)) continue;
+        int length = std::abs(f - originFloor) + std::abs(destinationFloor - f);
+        if (bestLength < 0 || length < bestLength ||
+            (length == bestLength && std::abs(destinationFloor - f) < std::abs(destinationFloor - best))) {
+            best = f;
+            bestLength = length;
+        }
+    }
+    return best;
+}
+
+void ElevatorBank::assignHallCall(int carIndex, int floorIndex, CallDirection direction) {
+    if (carIndex < 0 || carIndex >= (int)cars.size()) return;
+    if (floorIndex < 0 || floorIndex >= getFloorCount()) return;
+
+    ElevatorController& controller = cars[carIndex].controller;
+    if (controller.getCalls().hasHallCall(floorIndex, direction)) return;
+    controller.requestHallCall(floorIndex, direction);
+}
+
+bool ElevatorBank::carCall(int carIndex, int floorIndex) {
+    if (carIndex < 0 || carIndex >= (int)cars.size()) return false;
+    if (floorIndex < 0 || floorIndex >= getFloorCount()) return false;
+
+    ElevatorController& controller = cars[carIndex].controller;
+    if (controller.getCalls().hasCarCall(floorIndex)) return true;
+    return controller.requestFloor(floorIndex);
+}
+
+void ElevatorBank::transferPassengers(int carIndex, int alighting, int boarding) {
+    if (carIndex < 0 || carIndex >= (int)cars.size()) return;
+    cars[carIndex].controller.transferPassengers(alighting, boarding);
+}
+
+bool ElevatorBank::saveState(BankSnapshot& out) const {
+    if ((int)cars.size() > BankSnapshot::MAX_CARS) return false;
+    out.carCount = (int)cars.size();
+    for (int i = 0; i < out.carCount; ++i) {
+        out.cars[i] = cars[i].controller;
+    }
+    std::fill(out.waitingUp, out.waitingUp + BankSnapshot::MAX_FLOORS, (uint16_t)0);
+    std::fill(out.waitingDown, out.waitingDown + BankSnapshot::MAX_FLOORS, (uint16_t)0);
+    std::fill(&out.riding[0][0], &out.riding[0][0] + BankSnapshot::MAX_CARS * BankSnapshot::MAX_FLOORS, (uint16_t)0);
+    return true;
+}
+
+int ElevatorBank::carInFrontOf(float left, float right) const {
+    float center = 0.5f * (left + right);
+    float halfWidth = 0.5f * (right - left);
+    for (int i = 0; i < (int)cars.size(); ++i) {
+        const Elevator& e = cars[i].controller.getElevator();
+        if (center >= e.x - halfWidth - 2.0f && center <= e.x + e.width) return i;
+    }
+    return -1;
+}
+
+void ElevatorBank::getElevators(std::vector<Elevator>& out) const {
+    out.resize(cars.size());
+    for (size_t i = 0; i < cars.size(); ++i) {
+        out[i] = cars[i].controller.getElevator();
+    }
+}
+
+void ElevatorBank::setSchedulingMode(SchedulingMode mode) {
+    for (Car& car : cars) {
+        car.controller.setSchedulingMode(mode);
+    }
+}
+
+bool ElevatorBank::hasPendingRequests() const {
+    for (const Car& car : cars) {
+        if (car.controller.hasTarget() || !car.controller.getCalls().empty()) return true;
+    }
+    return false;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Types.h"
+#include "Constants.h"
+#include "ElevatorController.h"
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class ElevatorBank;
+
+// One car of the bank (its controller owns the car's call registry)
+struct Car {
+    ElevatorController controller;
+};
+
+// Every car of a bank as one flat block: no pointers, no heap, so forking the
+// world for a what-if rollout is a plain memcpy. Floors are not included, they
+// never change during a run. The passengers are counts: how many wait at each
+// floor per way and how many ride in each car to each floor (all 0 unless a
+// PassengerPopulation filled them in, see countPassengers()).
+struct BankSnapshot {
+    static const int MAX_CARS = 16;
+    static const int MAX_FLOORS = CallRegistry::MAX_FLOORS;
+
+    int carCount;
+    ElevatorController cars[MAX_CARS];
+    uint16_t waitingUp[MAX_FLOORS];
+    uint16_t waitingDown[MAX_FLOORS];
+	uint16_t riding[MAX_CARS][MAX_FLOORS];  // per car, by the floor they get off at
+};
+static_assert(std::is_trivially_copyable<BankSnapshot>::value, "BankSnapshot must stay memcpy-able");
+
+// Group dispatcher: decides which car serves a hall call
+class Dispatcher {
+public:
+    virtual ~Dispatcher() {}
+
+    // Index of the car that should serve a hall call at floorIndex going
+    // `direction`; in a zoned bank only cars also serving legFloor (when >= 0)
+    virtual int assignHallCall(const ElevatorBank& bank, int floorIndex, CallDirection direction, int legFloor) = 0;
+};
+
+// Assigns every hall call to the car with the lowest estimated time of arrival
+class EtaDispatcher : public Dispatcher {
+public:
+    int assignHallCall(const ElevatorBank& bank, int floorIndex, CallDirection direction, int legFloor) override;
+
+    // Seconds until the car could open its doors at floorIndex for a passenger
+    // going `direction`, serving its queue in order first (plus a penalty for a
+    // car too full to stop); infinity if the car doesn't serve the floor
+    static float estimateArrivalTime(const Car& car, const std::vector<Floor>& floors, int floorIndex,
+                                     CallDirection direction = CallDirection::Any);
+};
+
+// N cars side by side, sharing the hall calls through a dispatcher
+class ElevatorBank {
+public:
+    ElevatorBank();
+
+    void initialize(int carCount, const std::vector<Floor>& floors, float firstCarX, float carSpacing,
+                    float floorSpacing, int startFloor, float elevatorWidth, float elevatorHeight);
+
+    // Motion limits (pixels, seconds) and door timings (seconds) of every car
+    void setMotion(const MotionLimits& limits, float doorAnimDuration, float doorOpenTime);
+
+    // Passenger model of every car (see ElevatorController::setLoadModel)
+    void setLoadModel(int capacity, float boardTime, float alightTime, float minDwellTime, float bypassLoad);
+
+    // Replace the group dispatcher (EtaDispatcher by default)
+    void setDispatcher(std::unique_ptr<Dispatcher> newDispatcher);
+
+    // Update all cars; the button panel and ventilation belong to panelCar only
+    void update(float deltaTime, int panelCar, bool& ventilationOn,
+                const std::vector<int>& floorButtonIndex, std::vector<Button>& buttons,
+                int ventilationButtonIndex);
+
+    // Update a single car without the panel (event-driven runs)
+    void updateCar(int carIndex, float deltaTime);
+
+    // Hall call from a floor (up/down button, Any for a single call button),
+    // returns the car it was assigned to, -1 if no car stops there. In a zoned
+    // bank each zone has its own buttons: legFloor (when >= 0) is where the
+    // passenger rides to, and only cars stopping there take the call.
+    int hallCall(int floorIndex, CallDirection direction = CallDirection::Any, int legFloor = -1);
+
+    // Zoned banks: where a passenger from originFloor to destinationFloor rides
+    // first. The destination if one car serves both floors, else the transfer
+    // floor (sky lobby or lobby) between a car from the origin and a car to the
+    // destination that makes the shortest journey.
+    int nextLegFloor(int originFloor, int destinationFloor) const;
+
+    // Hall call given straight to a car (destination dispatch decides outside the bank)
+    void assignHallCall(int carIndex, int floorIndex, CallDirection direction);
+
+    // Car call from inside a car (button panel)
+    bool carCall(int carIndex, int floorIndex);
+
+    // Passengers through the doors of a car standing open (see ElevatorController::transferPassengers)
+    void transferPassengers(int carIndex, int alighting, int boarding);
+
+    // Same scheduling mode for every car (each car can still be changed on its own)
+    void setSchedulingMode(SchedulingMode mode);
+
+    // Car whose doorway the given horizontal span stands in front of, -1 if none
+    int carInFrontOf(float left, float right) const;
+
+    // Getters
+    int getCarCount() const { return (int)cars.size(); }
+    Car& getCar(int index) { return cars[index]; }
+    const Car& getCar(int index) const { return cars[index]; }
+    const std::vector<Floor>& getFloors() const { return *floors; }
+    int getFloorCount() const { return (int)floors->size(); }
+    void getElevators(std::vector<Elevator>& out) const;
+
+    bool hasPendingRequests() const;
+
+    // Copy every car into out, with no passengers; false if the bank has more
+    // than BankSnapshot::MAX_CARS cars
+    bool saveState(BankSnapshot& out) const;
+
+private:
+    std::vector<Car> cars;
+    std::unique_ptr<Dispatcher> dispatcher;
+    const std::vector<Floor>* floors;
+
+    // throwaway panel state for cars without the panel
+    std::vector<Button> noButtons;
+    std::vector<int> noFloorButtons;
+};
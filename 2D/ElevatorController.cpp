@@ -1,56 +1,126 @@
 #include "ElevatorController.h"
 #include "ButtonPanel.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
-ElevatorController::ElevatorController() : doorExtendedThisCycle(false) {
+ElevatorController::ElevatorController()
+    : hasTargetFloor(false), targetFloor(0), travelDirection(0), stopDirection(CallDirection::Any),
+      schedulingMode(SchedulingMode::Fifo),
+      retargetPending(false), doorExtendedThisCycle(false), doorCycle(0), verbose(true),
+      doorAnimDuration(0.3f), doorOpenTime(5.0f),
+      capacity(0), boardTime(0.0f), alightTime(0.0f), minDwellTime(0.0f), bypassLoad(1.0f),
+      limits(260.0f, 0.0f, 0.0f),
+      motionTime(0.0f), moveStartY(0.0f), moveDirection(1.0f) {
+    elevator.speed = 0.0f;
+    elevator.load = 0;
+    for (uint64_t& word : served.words) word = ~0ull;
 }
 
-void ElevatorController::initialize(const Floor floors[FLOOR_COUNT], float elevatorX, float floorSpacing, int startFloor, float elevatorWidth, float elevatorHeight) {
+void ElevatorController::initialize(const std::vector<Floor>& floors, float elevatorX, float floorSpacing, int startFloor, float elevatorWidth, float elevatorHeight) {
     elevator.x = elevatorX;
     elevator.width = elevatorWidth;
     elevator.height = elevatorHeight;
     elevator.currentFloor = startFloor;
     elevator.y = floors[startFloor].yTop;
     elevator.state = ElevatorState::Idle;
-    elevator.speed = 260.0f;
+    elevator.speed = 0.0f;
     elevator.doorOpenTimer = 0.0f;
     elevator.doorOpenRatio = 0.0f;
+    elevator.load = 0;
     doorExtendedThisCycle = false;
+    calls.clear();
+    hasTargetFloor = false;
+    targetFloor = startFloor;
+    travelDirection = 0;
+    stopDirection = CallDirection::Any;
+    retargetPending = false;
+    motion.plan(0.0f, limits);
+    motionTime = 0.0f;
 }
 
-void ElevatorController::update(float deltaTime, const Floor floors[FLOOR_COUNT], std::vector<int>& floorQueue,
-                               bool& hasTargetFloor, int& targetFloor, bool& ventilationOn,
-                               int floorButtonIndex[FLOOR_COUNT], std::vector<Button>& buttons,
+void ElevatorController::setMotion(const MotionLimits& motionLimits, float animDuration, float openTime) {
+    limits = motionLimits;
+    doorAnimDuration = animDuration;
+    doorOpenTime = openTime;
+}
+
+void ElevatorController::setLoadModel(int maxPassengers, float perBoarding, float perAlighting, float minDwell,
+                                      float bypassShare) {
+    capacity = maxPassengers > 0 ? maxPassengers : 0;
+    boardTime = perBoarding;
+    alightTime = perAlighting;
+    minDwellTime = minDwell;
+    bypassLoad = bypassShare;
+}
+
+void ElevatorController::transferPassengers(int alighting, int boarding) {
+    elevator.load += boarding - alighting;
+    if (elevator.load < 0) elevator.load = 0;
+
+	// one at a time through the door: the work queues up behind what is still
+	// going on and the doors close minDwellTime after the last one
+    if (capacity > 0 && elevator.state == ElevatorState::DoorsOpen) {
+        float work = alighting * alightTime + boarding * boardTime;
+        elevator.doorOpenTimer = std::max(elevator.doorOpenTimer, minDwellTime) + work;
+    }
+}
+
+int ElevatorController::getFreeSpace() const {
+    if (capacity <= 0) return std::numeric_limits<int>::max();
+    return elevator.load < capacity ? capacity - elevator.load : 0;
+}
+
+bool ElevatorController::isBypassing() const {
+    return capacity > 0 && elevator.load >= bypassLoad * capacity;
+}
+
+float ElevatorController::getExpectedDwell() const {
+	// about one passenger each way at a stop
+    return capacity > 0 ? minDwellTime + boardTime + alightTime : doorOpenTime;
+}
+
+float ElevatorController::openDwell() const {
+    return capacity > 0 ? minDwellTime : doorOpenTime;
+}
+
+void ElevatorController::update(float deltaTime, const std::vector<Floor>& floors, bool& ventilationOn,
+                               const std::vector<int>& floorButtonIndex, std::vector<Button>& buttons,
                                int ventilationButtonIndex) {
 	// If elevator is in  idle and has no target floor,
 	// something is in the waiting queue, take the next floor from the queue.
-    if (elevator.state == ElevatorState::Idle &&
-        !hasTargetFloor &&
-        !floorQueue.empty()) {
-        targetFloor = floorQueue.front();
-        floorQueue.erase(floorQueue.begin());
-        hasTargetFloor = true;
+    if (elevator.state == ElevatorState::Idle && !hasTargetFloor) {
+		stopDirection = CallDirection::Any; // doors closed with nowhere to go: free again
+        takeNextTarget();
+
+		// the next stop is where the car stands (a call registered while the
+		// doors were open), or nothing else is left and a hall call for the
+		// other direction waits here: open for it now
+        bool here = hasTargetFloor ? targetFloor == elevator.currentFloor : calls.isRequested(elevator.currentFloor);
+        if (here) {
+            hasTargetFloor = false;
+            travelDirection = 0;
+            calls.clearFloor(elevator.currentFloor);
+            openDoors();
+        }
     }
 
 	// If elevator is idle and has a target floor different from current, start moving
     if (elevator.state == ElevatorState::Idle &&
         hasTargetFloor && targetFloor != elevator.currentFloor) {
-        elevator.state = ElevatorState::Moving;
+        startMove(floors);
     }
 
     switch (elevator.state) {
     case ElevatorState::Moving:
-        processMovingState(deltaTime, floors, floorQueue, hasTargetFloor, targetFloor,
-                          ventilationOn, floorButtonIndex, buttons, ventilationButtonIndex);
+        processMovingState(deltaTime, floors, ventilationOn, floorButtonIndex, buttons,
+                          ventilationButtonIndex);
         break;
     case ElevatorState::DoorsOpening:
-        processDoorsOpeningState(deltaTime);
-        break;
     case ElevatorState::DoorsOpen:
-        processDoorsOpenState(deltaTime);
-        break;
     case ElevatorState::DoorsClosing:
-        processDoorsClosingState(deltaTime);
+        processDoors(deltaTime);
         break;
     case ElevatorState::Stopped:
 		// stopped, nothing to do
@@ -62,24 +132,184 @@ void ElevatorController::update(float deltaTime, const Floor floors[FLOOR_COUNT]
     }
 }
 
-void ElevatorController::processMovingState(float deltaTime, const Floor floors[FLOOR_COUNT],
-                                           std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor,
-                                           bool& ventilationOn, int floorButtonIndex[FLOOR_COUNT],
-                                           std::vector<Button>& buttons, int ventilationButtonIndex) {
+void ElevatorController::takeNextTarget() {
+    int next;
+    if (schedulingMode == SchedulingMode::Look) {
+		// at a stop the announced direction wins over the way the car came in
+        int direction = travelDirection;
+        if (stopDirection != CallDirection::Any) direction = (stopDirection == CallDirection::Up) ? 1 : -1;
+		// a full car only drops off, unless hall calls are all it has left
+        bool hallCalls = !isBypassing();
+        next = calls.nextLookStop(elevator.currentFloor, direction, hallCalls);
+        if (next < 0 && !hallCalls) next = calls.nextLookStop(elevator.currentFloor, direction);
+    }
+    else {
+        next = calls.takeOldest();
+        if (next < 0 && !calls.empty()) {
+			// stops picked up while the car ran LOOK have no place in the FIFO ring
+            int direction = 0;
+            next = calls.nextLookStop(elevator.currentFloor, direction);
+        }
+    }
+
+    hasTargetFloor = (next >= 0);
+    if (hasTargetFloor) {
+        targetFloor = next;
+        travelDirection = (next > elevator.currentFloor) ? 1 : -1;
+    }
+    else {
+        travelDirection = 0;
+    }
+}
+
+void ElevatorController::startMove(const std::vector<Floor>& floors) {
     float targetY = floors[targetFloor].yTop;
-    float dir = (targetY > elevator.y) ? 1.0f : -1.0f;
-    float step = elevator.speed * deltaTime * dir;
-    elevator.y += step;
+    moveStartY = elevator.y;
+    moveDirection = (targetY > elevator.y) ? 1.0f : -1.0f;
+    motion.plan(std::fabs(targetY - elevator.y), limits);
+    motionTime = 0.0f;
+    elevator.state = ElevatorState::Moving;
+    stopDirection = CallDirection::Any;
+}
+
+bool ElevatorController::retargetMotion(const std::vector<Floor>& floors, int floorIndex) {
+	// distance from where the run started, along the direction of travel
+    float runDistance = (floors[floorIndex].yTop - moveStartY) * moveDirection;
+    return runDistance >= 0.0f && motion.retarget(motionTime, runDistance, limits);
+}
+
+void ElevatorController::retargetAhead(const std::vector<Floor>& floors) {
+    bool up = travelDirection > 0;
+    bool hallCalls = !isBypassing();
+
+	// first LOOK stop the car can still brake for (passed floors fail too)
+    int candidate = calls.nextInDirection(elevator.currentFloor, up, hallCalls);
+    while (candidate >= 0 && candidate != targetFloor && !retargetMotion(floors, candidate)) {
+        candidate = calls.nextInDirection(candidate, up, hallCalls);
+    }
+
+    if (candidate >= 0 && (up ? candidate < targetFloor : candidate > targetFloor)) {
+        targetFloor = candidate;
+    }
+}
+
+float ElevatorController::timeToNextTransition(const std::vector<Floor>& floors) const {
+    const float never = std::numeric_limits<float>::infinity();
+
+    switch (elevator.state) {
+    case ElevatorState::Moving:
+        return motion.getDuration() - motionTime;
+    case ElevatorState::DoorsOpening:
+        return (1.0f - elevator.doorOpenRatio) * doorAnimDuration;
+    case ElevatorState::DoorsOpen:
+        return elevator.doorOpenTimer;
+    case ElevatorState::DoorsClosing:
+        return elevator.doorOpenRatio * doorAnimDuration;
+    case ElevatorState::Stopped:
+        return never; // until STOP is pressed again
+    case ElevatorState::Idle:
+    default:
+        if (hasTargetFloor && targetFloor != elevator.currentFloor) {
+			// update() starts moving right away
+            return travelTime(std::fabs(floors[targetFloor].yTop - elevator.y));
+        }
+        return calls.empty() ? never : 0.0f;
+    }
+}
+
+float ElevatorController::timeToReach(const std::vector<Floor>& floors, int floorIndex) const {
+    if (elevator.state != ElevatorState::Moving) {
+        return travelTime(std::fabs(floors[floorIndex].yTop - elevator.y));
+    }
+    if (floorIndex == targetFloor) {
+        return motion.getDuration() - motionTime;
+    }
+
+    float runDistance = (floors[floorIndex].yTop - moveStartY) * moveDirection;
+    MotionProfile run = motion;
+    if (runDistance < 0.0f || !run.retarget(motionTime, runDistance, limits)) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return run.getDuration() - motionTime;
+}
+
+int ElevatorController::getServiceOrder(int out[CallRegistry::MAX_FLOORS]) const {
+    int n = 0;
+    if (hasTargetFloor) {
+        out[n++] = targetFloor;
+    }
+
+    if (schedulingMode == SchedulingMode::Fifo) {
+        int queued[CallRegistry::MAX_FLOORS];
+        int queuedCount = calls.getQueued(queued);
+        for (int i = 0; i < queuedCount && n < CallRegistry::MAX_FLOORS; ++i) {
+            if (!hasTargetFloor || queued[i] != targetFloor) out[n++] = queued[i];
+        }
+        return n;
+    }
+
+	// LOOK: sweep a copy of the registry
+    CallRegistry remaining = calls;
+    int floorIndex = elevator.currentFloor;
+    int direction = travelDirection;
+    if (hasTargetFloor) {
+        remaining.clearFloor(targetFloor);
+        floorIndex = targetFloor;
+    }
+    remaining.clearFloor(floorIndex);
+
+    while (n < CallRegistry::MAX_FLOORS) {
+        int next = remaining.nextLookStop(floorIndex, direction);
+        if (next < 0) break;
+        direction = (next > floorIndex) ? 1 : -1;
+        out[n++] = next;
+        remaining.clearFloor(next);
+        floorIndex = next;
+    }
+    return n;
+}
+
+void ElevatorController::setSchedulingMode(SchedulingMode mode) {
+    schedulingMode = mode;
+    if (mode == SchedulingMode::Look) {
+        if (elevator.state == ElevatorState::Moving || elevator.state == ElevatorState::Stopped) {
+            retargetPending = true;
+        }
+        else if (hasTargetFloor) {
+            takeNextTarget();
+        }
+    }
+}
+
+void ElevatorController::processMovingState(float deltaTime, const std::vector<Floor>& floors, bool& ventilationOn,
+                                           const std::vector<int>& floorButtonIndex, std::vector<Button>& buttons,
+                                           int ventilationButtonIndex) {
+    if (retargetPending) {
+        retargetPending = false;
+        retargetAhead(floors);
+    }
 
-	// so it does not overshoot the target
-    if ((dir > 0.0f && elevator.y >= targetY) ||
-        (dir < 0.0f && elevator.y <= targetY)) {
-        elevator.y = targetY;
-        elevator.currentFloor = targetFloor;
+	// position straight from the profile, so step size doesn't matter
+    motionTime += deltaTime;
+    if (motionTime < motion.getDuration()) {
+        elevator.y = moveStartY + moveDirection * motion.positionAt(motionTime);
+        elevator.speed = motion.velocityAt(motionTime);
+    }
+    else {
+        int arrivedFloor = targetFloor;
+        elevator.y = floors[arrivedFloor].yTop;
+        elevator.speed = 0.0f;
+        elevator.currentFloor = arrivedFloor;
+
+		// FIFO serves the floor for everyone waiting there; LOOK clears the
+		// hall calls once it knows which way it leaves (below)
+        if (schedulingMode == SchedulingMode::Fifo) {
+            calls.clearFloor(arrivedFloor);
+        }
 
 		// unpress the floor button for the arrived floor
-        if (targetFloor >= 0 && targetFloor < FLOOR_COUNT) {
-            int fb = floorButtonIndex[targetFloor];
+        if (arrivedFloor >= 0 && arrivedFloor < (int)floorButtonIndex.size()) {
+            int fb = floorButtonIndex[arrivedFloor];
             if (fb >= 0 && fb < (int)buttons.size()) {
                 buttons[fb].pressed = false;
             }
@@ -91,14 +321,21 @@ void ElevatorController::processMovingState(float deltaTime, const Floor floors[
             buttons[ventilationButtonIndex].pressed = false;
         }
 
-		// take next target floor from the queue, if any
-        if (!floorQueue.empty()) {
-            targetFloor = floorQueue.front();
-            floorQueue.erase(floorQueue.begin());
-            hasTargetFloor = true;
+		// LOOK announces which way it serves this stop: on along its run if
+		// someone waits to go that way, turned around if only the other way waits
+		// and nothing is left ahead
+        if (schedulingMode == SchedulingMode::Look) {
+            bool up = moveDirection > 0.0f;
+            CallDirection along = up ? CallDirection::Up : CallDirection::Down;
+            CallDirection back = up ? CallDirection::Down : CallDirection::Up;
+            if (calls.hasHallCall(arrivedFloor, along)) stopDirection = along;
+            else if (calls.hasHallCall(arrivedFloor, back) && calls.nextInDirection(arrivedFloor, up) < 0) stopDirection = back;
         }
-        else {
-            hasTargetFloor = false;
+
+		// take next target floor from the queue, if any
+        takeNextTarget();
+        if (schedulingMode == SchedulingMode::Look) {
+            calls.clearStop(arrivedFloor, leavingDirection());
         }
 
 		// start door opening animation
@@ -108,34 +345,45 @@ void ElevatorController::processMovingState(float deltaTime, const Floor floors[
     }
 }
 
-void ElevatorController::processDoorsOpeningState(float deltaTime) {
-    elevator.doorOpenRatio += deltaTime / DOOR_ANIM_DURATION;
-    if (elevator.doorOpenRatio >= 1.0f) {
-        elevator.doorOpenRatio = 1.0f;
-        elevator.state = ElevatorState::DoorsOpen;
-        elevator.doorOpenTimer = BASE_DOOR_OPEN_TIME;
+void ElevatorController::processDoors(float deltaTime) {
+    DoorEvent event = stepDoors(elevator.state, elevator.doorOpenRatio, elevator.doorOpenTimer, deltaTime,
+                                doorAnimDuration, openDwell());
+    if (event == DoorEvent::Opened) {
 		doorExtendedThisCycle = false; // new cycle of door open
+        ++doorCycle;
     }
 }
 
-void ElevatorController::processDoorsOpenState(float deltaTime) {
-    elevator.doorOpenTimer -= deltaTime;
-    if (elevator.doorOpenTimer <= 0.0f) {
-        elevator.doorOpenTimer = 0.0f;
-        elevator.state = ElevatorState::DoorsClosing;
+bool ElevatorController::requestFloor(int floorIndex) {
+    if (!servesFloor(floorIndex)) {
+        if (verbose) {
+            std::cout << "Lift ne staje na spratu: " << floorIndex << std::endl;
+        }
+        return false;
     }
+    return registerStop(floorIndex, false, CallDirection::Any);
 }
 
-void ElevatorController::processDoorsClosingState(float deltaTime) {
-    elevator.doorOpenRatio -= deltaTime / DOOR_ANIM_DURATION;
-    if (elevator.doorOpenRatio <= 0.0f) {
-        elevator.doorOpenRatio = 0.0f;
-        elevator.state = ElevatorState::Idle;
-    }
+bool ElevatorController::requestHallCall(int floorIndex, CallDirection direction) {
+    if (!servesFloor(floorIndex)) return false;
+    return registerStop(floorIndex, true, direction);
+}
+
+CallDirection ElevatorController::leavingDirection() const {
+    if (schedulingMode == SchedulingMode::Fifo) return CallDirection::Any;
+    if (stopDirection != CallDirection::Any) return stopDirection;
+    if (!hasTargetFloor || targetFloor == elevator.currentFloor) return CallDirection::Any;
+    return targetFloor > elevator.currentFloor ? CallDirection::Up : CallDirection::Down;
 }
 
-bool ElevatorController::requestFloor(int floorIndex, std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor) {
-    if (floorIndex == elevator.currentFloor) {
+bool ElevatorController::registerStop(int floorIndex, bool hallCall, CallDirection direction) {
+    bool leavingFloor = (elevator.state == ElevatorState::Moving || elevator.state == ElevatorState::Stopped);
+	// a LOOK car about to leave the other way doesn't open for the call, it
+	// comes back for it; a full car doesn't hold its doors for people who can't get in
+    CallDirection leaving = leavingDirection();
+    bool otherWay = hallCall && direction != CallDirection::Any && leaving != CallDirection::Any && leaving != direction;
+    bool full = hallCall && isBypassing();
+    if (floorIndex == elevator.currentFloor && !leavingFloor && !otherWay && !full) {
 		// Elevator is already on my floor -> only manage doors
         if (elevator.state == ElevatorState::Idle ||
             elevator.state == ElevatorState::DoorsClosing) {
@@ -147,30 +395,25 @@ bool ElevatorController::requestFloor(int floorIndex, std::vector<int>& floorQue
         return true;
     }
     else {
-		// Elevator is NOT on my floor -> standardly add request
-        if (!hasTargetFloor) {
-            if (elevator.state == ElevatorState::Idle) {
-				// elevator idle -> set target floor and start moving
-                targetFloor = floorIndex;
-                hasTargetFloor = true;
-            }
-            else if (elevator.state == ElevatorState::DoorsOpen || 
-                     elevator.state == ElevatorState::DoorsClosing ||
-                     elevator.state == ElevatorState::DoorsOpening) {
-				// doors are open/closing -> set target floor
-                targetFloor = floorIndex;
-                hasTargetFloor = true;
+		// Elevator is NOT on my floor -> register the stop, the next free
+		// moment (idle or arrival) takes it from the registry
+        if (hallCall) {
+            calls.addHallCall(floorIndex, direction);
+        }
+        else {
+            calls.addCarCall(floorIndex);
+        }
+        if (schedulingMode == SchedulingMode::Look) {
+            if (leavingFloor) {
+                retargetPending = true;
             }
-            else {
-				// already moving -> add floor to queue
-                floorQueue.push_back(floorIndex);
+            else if (hasTargetFloor) {
+                takeNextTarget(); // still at a floor, the new stop may come first
             }
         }
-        else {
-			// already has target floor -> add to queue
-            floorQueue.push_back(floorIndex);
+        if (verbose) {
+            std::cout << "Lift pozvan na sprat: " << floorIndex << std::endl;
         }
-        std::cout << "Lift pozvan na sprat: " << floorIndex << std::endl;
         return true;
     }
 }
@@ -178,7 +421,7 @@ bool ElevatorController::requestFloor(int floorIndex, std::vector<int>& floorQue
 void ElevatorController::openDoors() {
     elevator.state = ElevatorState::DoorsOpening;
     elevator.doorOpenRatio = 0.0f;
-    elevator.doorOpenTimer = BASE_DOOR_OPEN_TIME;
+    elevator.doorOpenTimer = openDwell();
     doorExtendedThisCycle = false;
 }
 
@@ -190,12 +433,15 @@ void ElevatorController::closeDoors() {
 }
 
 void ElevatorController::extendDoorTimer() {
-    elevator.doorOpenTimer = BASE_DOOR_OPEN_TIME;
+	// with the load model the boarding itself keeps the doors open
+    elevator.doorOpenTimer = (capacity > 0) ? std::max(elevator.doorOpenTimer, minDwellTime) : doorOpenTime;
 }
 
 void ElevatorController::toggleStop() {
     if (elevator.state == ElevatorState::Moving) {
+		// emergency stop; the run is planned again from here when released
         elevator.state = ElevatorState::Stopped;
+        elevator.speed = 0.0f;
     }
     else if (elevator.state == ElevatorState::Stopped) {
         elevator.state = ElevatorState::Idle;
@@ -2,6 +2,8 @@
 
 #include "Types.h"
 #include "Constants.h"
+#include "CallRegistry.h"
+#include "MotionProfile.h"
 #include <vector>
 
 // Controls elevator state and movement
@@ -9,16 +11,52 @@ class ElevatorController {
 public:
     ElevatorController();
     
-    void initialize(const Floor floors[FLOOR_COUNT], float elevatorX, float floorSpacing, int startFloor, float elevatorWidth, float elevatorHeight);
+    void initialize(const std::vector<Floor>& floors, float elevatorX, float floorSpacing, int startFloor, float elevatorWidth, float elevatorHeight);
+
+    // Speed, acceleration and jerk limits (pixels, seconds) and door timings (seconds)
+    void setMotion(const MotionLimits& limits, float doorAnimDuration, float doorOpenTime);
+
+    // Passenger model: at most `capacity` passengers, and the doors stay open
+    // minDwellTime plus boardTime / alightTime per passenger through them
+    // instead of the flat doorOpenTime. From bypassLoad (share of capacity) on,
+    // a LOOK car passes hall calls and serves only its car calls.
+    void setLoadModel(int capacity, float boardTime, float alightTime, float minDwellTime, float bypassLoad);
+
+    // Floors the car stops at (zoning); calls for other floors are refused.
+    // Every floor by default.
+    void setServedFloors(const FloorMask& floors) { served = floors; }
+    const FloorMask& getServedFloors() const { return served; }
+    bool servesFloor(int floorIndex) const {
+        return floorIndex >= 0 && floorIndex < CallRegistry::MAX_FLOORS && served.test(floorIndex);
+    }
+
+    // Passengers got off / on while the doors are open: updates the load and,
+    // with the load model, holds the doors until they are through
+    void transferPassengers(int alighting, int boarding);
     
     // Update elevator state based on deltaTime
-    void update(float deltaTime, const Floor floors[FLOOR_COUNT], std::vector<int>& floorQueue, 
-                bool& hasTargetFloor, int& targetFloor, bool& ventilationOn,
-                int floorButtonIndex[FLOOR_COUNT], std::vector<Button>& buttons,
+    void update(float deltaTime, const std::vector<Floor>& floors, bool& ventilationOn,
+                const std::vector<int>& floorButtonIndex, std::vector<Button>& buttons,
                 int ventilationButtonIndex);
     
-    // Request floor (from button panel or person call)
-    bool requestFloor(int floorIndex, std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor);
+    // Seconds until the next state change (arrival, doors fully open, door timer
+    // expiry, doors closed) if nothing else happens; infinity when the car waits
+    // for a call. Closed form from the motion profile and door timings.
+    float timeToNextTransition(const std::vector<Floor>& floors) const;
+
+    // Seconds until the car could stop at floorIndex driving straight there: from
+    // standstill, or by ending its current run there; infinity if it is moving and
+    // can no longer brake for that floor. Door time is not included.
+    float timeToReach(const std::vector<Floor>& floors, int floorIndex) const;
+
+    // Seconds for a run of `distance` pixels from standstill to standstill
+    float travelTime(float distance) const { return MotionProfile::travelTime(distance, limits); }
+
+    // Request floor from the button panel (car call)
+    bool requestFloor(int floorIndex);
+
+    // Call from a floor (hall call)
+    bool requestHallCall(int floorIndex, CallDirection direction = CallDirection::Any);
     
     // Door control
     void openDoors();
@@ -27,24 +65,86 @@ public:
     
     // Stop control
     void toggleStop();
+
+    // Service order of registered stops (FIFO or LOOK), can change at any time
+    void setSchedulingMode(SchedulingMode mode);
+    SchedulingMode getSchedulingMode() const { return schedulingMode; }
+
+    // Stops in the order the car will serve them if no new calls arrive,
+    // current target first; returns how many were written
+    int getServiceOrder(int out[CallRegistry::MAX_FLOORS]) const;
     
     // Getters
     Elevator& getElevator() { return elevator; }
     const Elevator& getElevator() const { return elevator; }
+    const CallRegistry& getCalls() const { return calls; }
+    const MotionLimits& getMotionLimits() const { return limits; }
+    const MotionProfile& getMotionProfile() const { return motion; }
+    float getDoorAnimDuration() const { return doorAnimDuration; }
+    float getDoorOpenTime() const { return doorOpenTime; }
+    int getLoad() const { return elevator.load; }
+    int getCapacity() const { return capacity; }
+	int getFreeSpace() const;        // places left, a large number without the load model
+	bool isBypassing() const;        // loaded past the bypass threshold
+	float getExpectedDwell() const;  // door open time at a typical stop, for estimates
+    bool hasTarget() const { return hasTargetFloor; }
+    int getTargetFloor() const { return targetFloor; }
+    int getTravelDirection() const { return travelDirection; }
+
+    // Way the car serves its current stop: the direction LOOK announced on
+    // arrival, else toward its target; Any when it is free to go either way
+    // (no target, or FIFO, which takes everyone)
+    CallDirection leavingDirection() const;
+
+    // Floor is the current target or waiting in the registry
+    bool isFloorRequested(int floorIndex) const { return calls.isRequested(floorIndex); }
     
     bool isDoorExtendedThisCycle() const { return doorExtendedThisCycle; }
+	// counts the times the doors finished opening; tells one door cycle from the next
+    unsigned int getDoorCycle() const { return doorCycle; }
     void setDoorExtendedThisCycle(bool value) { doorExtendedThisCycle = value; }
 
+    // Console log of requests (off in headless runs)
+    void setVerbose(bool value) { verbose = value; }
+
 private:
     Elevator elevator;
+    CallRegistry calls;
+    FloorMask served;
+    bool hasTargetFloor;
+    int targetFloor;
+	int travelDirection;     // +1 up, -1 down, 0 no target
+	CallDirection stopDirection; // LOOK: direction announced at the current stop, Any while free
+    SchedulingMode schedulingMode;
+	bool retargetPending;    // LOOK: a new call may lie between the car and its target
     bool doorExtendedThisCycle;
+    unsigned int doorCycle;
+    bool verbose;
+    float doorAnimDuration;
+    float doorOpenTime;
+
+	// passenger model, capacity 0 = off (flat doorOpenTime, no limit)
+    int capacity;
+    float boardTime;
+    float alightTime;
+    float minDwellTime;
+    float bypassLoad;
+
+    MotionLimits limits;
+	MotionProfile motion;   // current run, valid while Moving
+	float motionTime;       // seconds since the run started
+	float moveStartY;       // where the run started
+	float moveDirection;    // +1 up, -1 down
     
-    void processMovingState(float deltaTime, const Floor floors[FLOOR_COUNT], 
-                           std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor,
-                           bool& ventilationOn, int floorButtonIndex[FLOOR_COUNT],
-                           std::vector<Button>& buttons, int ventilationButtonIndex);
-    void processDoorsOpeningState(float deltaTime);
-    void processDoorsOpenState(float deltaTime);
-    void processDoorsClosingState(float deltaTime);
+	float openDwell() const;    // door timer when the doors are fully open
+    void startMove(const std::vector<Floor>& floors);
+    bool retargetMotion(const std::vector<Floor>& floors, int floorIndex);
+    bool registerStop(int floorIndex, bool hallCall, CallDirection direction);
+    void takeNextTarget();
+    void retargetAhead(const std::vector<Floor>& floors);
+    void processMovingState(float deltaTime, const std::vector<Floor>& floors, bool& ventilationOn,
+                           const std::vector<int>& floorButtonIndex, std::vector<Button>& buttons,
+                           int ventilationButtonIndex);
+	void processDoors(float deltaTime);  // DoorsOpening, DoorsOpen, DoorsClosing (CarCycle.h)
 };
 
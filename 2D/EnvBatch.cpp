@@ -0,0 +1,304 @@
+#include "EnvBatch.h"
+#include <algorithm>
+#include <cmath>
+
+static const int16_t NO_CAR = -1;
+static const int16_t PENDING = -2;  // hall call waiting for an action
+
+EnvBatch::EnvBatch(int envCount, const BuildingConfig& building, const EnvSettings& settings)
+    : envCount(envCount < 1 ? 1 : envCount), carCount(building.carCount), floorCount(building.floorCount),
+      settings(settings), time(0.0), arrived(0), delivered(0) {
+    floorHeight.resize(floorCount);
+    for (int f = 0; f < floorCount; ++f) {
+        floorHeight[f] = building.getFloorElevation(f);
+    }
+    buildingHeight = building.getBuildingHeight();
+    maxSpeed = building.carSpeed;
+	accel = (building.carAccel > 0.0f) ? building.carAccel : 1e6f;  // 0: full speed at once
+    doorRate = 1.0f / building.doorAnimDuration;
+    doorOpenTime = building.doorOpenTime;
+    lobbyFloor = building.lobbyFloor;
+
+    int cars = this->envCount * carCount;
+    position.resize(cars);
+    speed.resize(cars);
+    targetHeight.resize(cars);
+    moving.resize(cars);
+    doorRatio.resize(cars);
+    doorDirection.resize(cars);
+    doorTimer.resize(cars);
+    state.resize(cars);
+    currentFloor.resize(cars);
+    targetFloor.resize(cars);
+    travelDirection.resize(cars);
+    calls.resize(cars);
+    riders.resize((size_t)cars * floorCount);
+    riderCount.resize(cars);
+
+    waiting.resize((size_t)this->envCount * floorCount);
+    assignedCar.resize((size_t)this->envCount * floorCount);
+    unassignedEntry.resize((size_t)this->envCount * floorCount);
+
+    rngs.resize(this->envCount);
+    nextArrival.resize(this->envCount);
+    unassigned.resize(this->envCount);
+    unassignedHead.resize(this->envCount);
+    waitingTotal.resize(this->envCount);
+}
+
+void EnvBatch::reset(const unsigned* seeds, float* observations) {
+    time = 0.0;
+    arrived = 0;
+    delivered = 0;
+
+    float lobbyHeight = floorHeight[lobbyFloor];
+    for (int i = 0; i < envCount * carCount; ++i) {
+        position[i] = lobbyHeight;
+        speed[i] = 0.0f;
+        targetHeight[i] = lobbyHeight;
+        moving[i] = 0.0f;
+        doorRatio[i] = 0.0f;
+        doorDirection[i] = 0.0f;
+        doorTimer[i] = 0.0f;
+        state[i] = (uint8_t)ElevatorState::Idle;
+        currentFloor[i] = (int16_t)lobbyFloor;
+        targetFloor[i] = (int16_t)lobbyFloor;
+        travelDirection[i] = 0;
+        calls[i].clear();
+        riderCount[i] = 0;
+    }
+    std::fill(riders.begin(), riders.end(), (uint16_t)0);
+    std::fill(waiting.begin(), waiting.end(), (uint16_t)0);
+    std::fill(assignedCar.begin(), assignedCar.end(), NO_CAR);
+
+    std::exponential_distribution<double> interArrival(settings.callsPerHour / 3600.0);
+    for (int e = 0; e < envCount; ++e) {
+        rngs[e].seed(seeds[e]);
+        unassigned[e].clear();
+        unassignedHead[e] = 0;
+        waitingTotal[e] = 0;
+        nextArrival[e] = interArrival(rngs[e]);
+    }
+    writeObservations(observations);
+}
+
+void EnvBatch::step(const int* actions, float* observations, float* rewards) {
+    for (int e = 0; e < envCount; ++e) {
+        rewards[e] = 0.0f;
+        int car = actions[e];
+        if (unassignedHead[e] == (int)unassigned[e].size() || car < 0 || car >= carCount) continue;
+
+        int floor = unassigned[e][unassignedHead[e]];
+        calls[e * carCount + car].addHallCall(floor, CallDirection::Any);
+        assignedCar[e * floorCount + floor] = (int16_t)car;
+        skipTakenCalls(e);
+    }
+
+    int substeps = std::max(1, (int)std::lround(settings.stepSeconds / settings.dt));
+    float dt = (float)(settings.stepSeconds / substeps);
+    for (int s = 0; s < substeps; ++s) {
+        time += dt;
+        for (int e = 0; e < envCount; ++e) {
+            spawnPassengers(e, time);
+        }
+
+        integrate(dt);
+        for (int i = 0; i < envCount * carCount; ++i) {
+            updateCar(i);
+        }
+
+        for (int e = 0; e < envCount; ++e) {
+            rewards[e] -= waitingTotal[e] * dt;
+        }
+    }
+    writeObservations(observations);
+}
+
+void EnvBatch::integrate(float dt) {
+	// every car of every building in one pass; no branches, so it vectorizes
+    int n = envCount * carCount;
+    float* pos = position.data();
+    float* spd = speed.data();
+    const float* target = targetHeight.data();
+    const float* mov = moving.data();
+    float* door = doorRatio.data();
+    const float* doorDir = doorDirection.data();
+    float* timer = doorTimer.data();
+
+    float dv = accel * dt;
+    float twoAccel = 2.0f * accel;
+    float doorStep = doorRate * dt;
+    float vmax = maxSpeed;
+    for (int i = 0; i < n; ++i) {
+        float d = target[i] - pos[i];
+        float dist = std::fabs(d);
+		// accelerate up to full speed, but never faster than still lets it brake at the target
+        float v = std::min(std::min(spd[i] + dv, vmax), std::sqrt(twoAccel * dist)) * mov[i];
+        float travel = std::min(v * dt, dist);
+        pos[i] += (d < 0.0f) ? -travel : travel;
+        spd[i] = v;
+
+        float r = door[i] + doorDir[i] * doorStep;
+        door[i] = std::min(std::max(r, 0.0f), 1.0f);
+        timer[i] -= dt;
+    }
+}
+
+void EnvBatch::updateCar(int i) {
+    ElevatorState carState = (ElevatorState)state[i];
+    switch (carState) {
+    case ElevatorState::Moving:
+        if (position[i] == targetHeight[i]) arrive(i);
+        return;
+
+    case ElevatorState::Idle: {
+        if (calls[i].isRequested(currentFloor[i])) {
+            targetFloor[i] = currentFloor[i];
+            arrive(i);
+            return;
+        }
+        int direction = travelDirection[i];
+        int next = calls[i].nextLookStop(currentFloor[i], direction);
+        travelDirection[i] = (int8_t)(next < 0 ? 0 : direction);
+        if (next >= 0) {
+            targetFloor[i] = (int16_t)next;
+            targetHeight[i] = floorHeight[next];
+            moving[i] = 1.0f;
+            state[i] = (uint8_t)ElevatorState::Moving;
+        }
+        return;
+    }
+
+    case ElevatorState::DoorsOpen:
+        board(i);
+        break;
+
+    default:
+        break;
+    }
+
+	// integrate() moved ratio and timer; the transitions are the app's (CarCycle.h)
+    DoorEvent event = doorTransition(carState, doorRatio[i], doorTimer[i], doorOpenTime);
+    state[i] = (uint8_t)carState;
+    switch (event) {
+    case DoorEvent::Opened:
+        doorDirection[i] = 0.0f;
+        board(i);
+        break;
+    case DoorEvent::Closing:
+        doorDirection[i] = -1.0f;
+        break;
+    case DoorEvent::Closed:
+        doorDirection[i] = 0.0f;
+        break;
+    default:
+        break;
+    }
+}
+
+void EnvBatch::arrive(int i) {
+    int floor = targetFloor[i];
+    currentFloor[i] = (int16_t)floor;
+    position[i] = floorHeight[floor];
+    targetHeight[i] = floorHeight[floor];
+    speed[i] = 0.0f;
+    moving[i] = 0.0f;
+    calls[i].clearFloor(floor);
+
+    uint16_t& alighting = riders[(size_t)i * floorCount + floor];
+    delivered += alighting;
+    riderCount[i] = (uint16_t)(riderCount[i] - alighting);
+    alighting = 0;
+
+    state[i] = (uint8_t)ElevatorState::DoorsOpening;
+    doorDirection[i] = 1.0f;
+}
+
+void EnvBatch::board(int i) {
+    int env = i / carCount;
+    int floor = currentFloor[i];
+    size_t slot = (size_t)env * floorCount + floor;
+    int count = waiting[slot];
+    if (count == 0) return;
+
+	// everyone waiting gets in and picks a destination
+    std::uniform_int_distribution<int> otherFloor(0, floorCount - 2);
+    for (int p = 0; p < count; ++p) {
+        int destination = otherFloor(rngs[env]);
+        if (destination >= floor) ++destination;
+        ++riders[(size_t)i * floorCount + destination];
+        calls[i].addCarCall(destination);
+    }
+    riderCount[i] = (uint16_t)(riderCount[i] + count);
+    waiting[slot] = 0;
+    waitingTotal[env] -= count;
+    calls[i].clearFloor(floor);  // the open car served the hall call
+
+    bool pending = assignedCar[slot] == PENDING;
+    assignedCar[slot] = NO_CAR;
+    if (pending) skipTakenCalls(env);
+}
+
+void EnvBatch::skipTakenCalls(int env) {
+    std::vector<int16_t>& queue = unassigned[env];
+    int& head = unassignedHead[env];
+    const int16_t* assigned = &assignedCar[(size_t)env * floorCount];
+    const int* entry = &unassignedEntry[(size_t)env * floorCount];
+    while (head < (int)queue.size() && (assigned[queue[head]] != PENDING || entry[queue[head]] != head)) {
+        ++head;
+    }
+
+	// once half of it is behind the head, move the pending calls to the front
+    if (2 * head < (int)queue.size()) return;
+    int kept = 0;
+    for (int k = head; k < (int)queue.size(); ++k) {
+        int floor = queue[k];
+        if (assigned[floor] == PENDING && entry[floor] == k) {
+            queue[kept] = (int16_t)floor;
+            unassignedEntry[(size_t)env * floorCount + floor] = kept++;
+        }
+    }
+    queue.resize(kept);
+    head = 0;
+}
+
+void EnvBatch::spawnPassengers(int env, double until) {
+    std::mt19937& rng = rngs[env];
+    std::exponential_distribution<double> interArrival(settings.callsPerHour / 3600.0);
+    std::uniform_int_distribution<int> anyFloor(0, floorCount - 1);
+    while (nextArrival[env] <= until) {
+        int floor = anyFloor(rng);
+        size_t slot = (size_t)env * floorCount + floor;
+        ++waiting[slot];
+        ++waitingTotal[env];
+        ++arrived;
+        if (assignedCar[slot] == NO_CAR) {
+            assignedCar[slot] = PENDING;
+            unassignedEntry[slot] = (int)unassigned[env].size();
+            unassigned[env].push_back((int16_t)floor);
+        }
+        nextArrival[env] += interArrival(rng);
+    }
+}
+
+void EnvBatch::writeObservations(float* observations) const {
+    int size = getObservationSize();
+    for (int e = 0; e < envCount; ++e) {
+        float* o = observations + (size_t)e * size;
+        for (int c = 0; c < carCount; ++c) {
+            int i = e * carCount + c;
+            o[c] = position[i] / buildingHeight;
+            o[carCount + c] = speed[i] / maxSpeed;
+            o[2 * carCount + c] = doorRatio[i];
+            o[3 * carCount + c] = state[i] / 5.0f;
+            o[4 * carCount + c] = riderCount[i] / 10.0f;
+        }
+
+        float* f = o + 5 * carCount;
+        for (int k = 0; k < floorCount; ++k) {
+            f[k] = waiting[(size_t)e * floorCount + k] / 10.0f;
+            f[floorCount + k] = 0.0f;
+        }
+        if (unassignedHead[e] < (int)unassigned[e].size()) f[floorCount + unassigned[e][unassignedHead[e]]] = 1.0f;
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "BuildingConfig.h"
+#include "CallRegistry.h"
+#include "Types.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// How the buildings of a batch run
+struct EnvSettings {
+	double stepSeconds = 1.0;     // simulated time per step()
+	double dt = 0.05;             // integration substep
+	double callsPerHour = 120.0;  // passenger arrivals per building
+};
+
+// E independent copies of one building stepped together, for training
+// dispatch policies. Cars of all buildings live in structure-of-arrays (car
+// index = env * carCount + car), so the position and door integration of the
+// whole batch runs as straight float loops the compiler vectorizes (AVX2 in
+// the Release build). The cars go through the usual ElevatorState cycle, the
+// door transitions are the app's own (doorTransition(), CarCycle.h); runs are
+// plain acceleration-limited (no jerk) and stops come from a CallRegistry per
+// car in LOOK order.
+//
+// Each step the policy answers the oldest unassigned hall call of every
+// building (actions[env] = car, anything else leaves it pending). Passengers
+// board whichever car opens at their floor and ride to a random other floor.
+// Reward is minus the passenger-seconds spent waiting at the floors during the step.
+//
+// Observation of one env (getObservationSize() floats), blocks of carCount:
+// position / building height, speed / max speed, door ratio, state / 5,
+// riders / 10; then blocks of floorCount: waiting / 10, pending hall call (one-hot).
+class EnvBatch {
+public:
+    EnvBatch(int envCount, const BuildingConfig& building, const EnvSettings& settings = EnvSettings());
+
+    int getEnvCount() const { return envCount; }
+    int getCarCount() const { return carCount; }
+    int getFloorCount() const { return floorCount; }
+    int getObservationSize() const { return 5 * carCount + 2 * floorCount; }
+
+	// Start every building empty with its cars at the lobby; seeds[env] drives its
+	// passengers. observations: envCount * getObservationSize() floats, written in place.
+    void reset(const unsigned* seeds, float* observations);
+
+	// Apply one action per env, run stepSeconds, write observations and rewards (envCount floats)
+    void step(const int* actions, float* observations, float* rewards);
+
+	// Totals since reset over all envs
+    long long getArrivedCount() const { return arrived; }
+    long long getDeliveredCount() const { return delivered; }
+
+private:
+    int envCount;
+    int carCount;
+    int floorCount;
+    EnvSettings settings;
+    std::vector<float> floorHeight;  // metres above floor 0
+    float buildingHeight;
+    float maxSpeed;
+    float accel;
+    float doorRate;                  // door ratio per second
+    float doorOpenTime;
+    int lobbyFloor;
+
+	// cars, SoA over envCount * carCount
+    std::vector<float> position;     // metres
+    std::vector<float> speed;
+	std::vector<float> targetHeight;  // metres, valid while Moving
+	std::vector<float> moving;        // 1 while Moving, else 0 (keeps the motion loop branch-free)
+    std::vector<float> doorRatio;
+	std::vector<float> doorDirection; // +1 opening, -1 closing, 0 otherwise
+	std::vector<float> doorTimer;     // seconds left open
+    std::vector<uint8_t> state;       // ElevatorState
+    std::vector<int16_t> currentFloor;
+    std::vector<int16_t> targetFloor;
+    std::vector<int8_t> travelDirection;
+    std::vector<CallRegistry> calls;
+	std::vector<uint16_t> riders;     // per car and destination floor
+    std::vector<uint16_t> riderCount;
+
+	// floors, envCount * floorCount
+    std::vector<uint16_t> waiting;
+	std::vector<int16_t> assignedCar; // car answering the floor's hall call, -1 none
+	std::vector<int> unassignedEntry; // index of the floor's entry in unassigned while pending
+
+	// per env
+    std::vector<std::mt19937> rngs;
+    std::vector<double> nextArrival;
+	// hall calls waiting for an action, oldest first from unassignedHead; entries
+	// of floors served or assigned meanwhile stay behind and are skipped
+    std::vector<std::vector<int16_t>> unassigned;
+    std::vector<int> unassignedHead;
+    std::vector<int> waitingTotal;
+    double time;
+
+    long long arrived;
+    long long delivered;
+
+    void integrate(float dt);
+    void updateCar(int car);
+    void arrive(int car);
+    void board(int car);
+    void spawnPassengers(int env, double until);
+    void skipTakenCalls(int env);
+    void writeObservations(float* observations) const;
+};
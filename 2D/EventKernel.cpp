@@ -0,0 +1,183 @@
+#include "EventKernel.h"
+#include <cmath>
+
+// A car event runs update() a hair past the closed-form time, so float
+// rounding can't leave the car just short of its transition
+static const float TRANSITION_SLACK = 1e-5f;
+// Zero-time updates allowed at one instant (Idle -> pick target -> Moving)
+static const int MAX_SETTLE_STEPS = 4;
+
+EventKernel::EventKernel(ElevatorBank& bank)
+    : bank(bank), now(0.0), nextSequence(0), processedCount(0) {
+    reset();
+}
+
+void EventKernel::reset(double startTime) {
+    events = std::priority_queue<SimEvent, std::vector<SimEvent>, Later>();
+    now = startTime;
+    nextSequence = 0;
+    processedCount = 0;
+    carTime.assign(bank.getCarCount(), startTime);
+    carGeneration.assign(bank.getCarCount(), 0);
+    rescheduleAllCars();
+}
+
+void EventKernel::push(double time, SimEventType type, int car, int floorIndex, unsigned generation,
+                       CallDirection direction, int legFloor) {
+    SimEvent e;
+    e.time = time;
+    e.type = type;
+    e.car = car;
+    e.floor = floorIndex;
+    e.direction = direction;
+    e.legFloor = legFloor;
+    e.generation = generation;
+    e.sequence = nextSequence++;
+    events.push(e);
+}
+
+void EventKernel::scheduleHallCall(double time, int floorIndex, CallDirection direction, int legFloor) {
+    push(time < now ? now : time, SimEventType::HallCall, -1, floorIndex, 0, direction, legFloor);
+}
+
+void EventKernel::scheduleCarCall(double time, int carIndex, int floorIndex) {
+    push(time < now ? now : time, SimEventType::CarCall, carIndex, floorIndex, 0);
+}
+
+void EventKernel::scheduleDestinationCall(double time, int floorIndex) {
+    push(time < now ? now : time, SimEventType::DestinationCall, -1, floorIndex, 0);
+}
+
+void EventKernel::scheduleTimer(double time) {
+    push(time < now ? now : time, SimEventType::Timer, -1, -1, 0);
+}
+
+void EventKernel::syncCar(int carIndex, double time) {
+    double dt = time - carTime[carIndex];
+    if (dt > 0.0) {
+        bank.updateCar(carIndex, (float)dt);
+    }
+    carTime[carIndex] = time;
+}
+
+void EventKernel::syncAllCars(double time) {
+    for (int i = 0; i < bank.getCarCount(); ++i) {
+        syncCar(i, time);
+    }
+}
+
+void EventKernel::scheduleCar(int carIndex) {
+    const ElevatorController& controller = bank.getCar(carIndex).controller;
+	// a zero step applies what a call just changed (start moving, LOOK retarget)
+    bank.updateCar(carIndex, 0.0f);
+    float dt = controller.timeToNextTransition(bank.getFloors());
+    for (int i = 0; dt <= 0.0f && i < MAX_SETTLE_STEPS; ++i) {
+        bank.updateCar(carIndex, 0.0f);
+        dt = controller.timeToNextTransition(bank.getFloors());
+    }
+
+	// any event already queued for this car is now stale
+    unsigned generation = ++carGeneration[carIndex];
+    if (dt <= 0.0f || std::isinf(dt)) return; // waits for a call
+
+    SimEventType type;
+    switch (controller.getElevator().state) {
+    case ElevatorState::DoorsOpening:
+        type = SimEventType::DoorsOpened;
+        break;
+    case ElevatorState::DoorsOpen:
+        type = SimEventType::DoorTimerExpired;
+        break;
+    case ElevatorState::DoorsClosing:
+        type = SimEventType::DoorsClosed;
+        break;
+    default:
+        type = SimEventType::CarArrival;
+        break;
+    }
+    push(carTime[carIndex] + dt, type, carIndex, controller.getTargetFloor(), generation);
+}
+
+void EventKernel::rescheduleAllCars() {
+    for (int i = 0; i < bank.getCarCount(); ++i) {
+        scheduleCar(i);
+    }
+}
+
+int EventKernel::hallCall(int floorIndex, CallDirection direction, int legFloor) {
+	// the dispatcher compares every car, so all of them must be current
+    syncAllCars(now);
+    int carIndex = bank.hallCall(floorIndex, direction, legFloor);
+    rescheduleAllCars();
+    return carIndex;
+}
+
+void EventKernel::assignHallCall(int carIndex, int floorIndex, CallDirection direction) {
+    if (carIndex < 0 || carIndex >= bank.getCarCount()) return;
+
+    syncCar(carIndex, now);
+    bank.assignHallCall(carIndex, floorIndex, direction);
+    scheduleCar(carIndex);
+}
+
+bool EventKernel::carCall(int carIndex, int floorIndex) {
+    if (carIndex < 0 || carIndex >= bank.getCarCount()) return false;
+
+    syncCar(carIndex, now);
+    bool accepted = bank.carCall(carIndex, floorIndex);
+    scheduleCar(carIndex);
+    return accepted;
+}
+
+void EventKernel::transferPassengers(int carIndex, int alighting, int boarding) {
+    if (carIndex < 0 || carIndex >= bank.getCarCount()) return;
+
+    syncCar(carIndex, now);
+    bank.transferPassengers(carIndex, alighting, boarding);
+    scheduleCar(carIndex);
+}
+
+bool EventKernel::processNext(double endTime, SimEvent& processed) {
+    while (!events.empty() && events.top().time <= endTime) {
+        SimEvent e = events.top();
+        events.pop();
+
+        bool carEvent = (e.type == SimEventType::CarArrival || e.type == SimEventType::DoorsOpened ||
+                         e.type == SimEventType::DoorTimerExpired || e.type == SimEventType::DoorsClosed);
+        if (carEvent && e.generation != carGeneration[e.car]) {
+            continue; // the car was rescheduled after this was queued
+        }
+
+        now = e.time;
+        switch (e.type) {
+        case SimEventType::HallCall:
+            e.car = hallCall(e.floor, e.direction, e.legFloor);
+            break;
+        case SimEventType::CarCall:
+            carCall(e.car, e.floor);
+            break;
+        case SimEventType::DestinationCall:
+            break;
+        case SimEventType::Timer:
+            syncAllCars(now);
+            break;
+        default:
+            bank.updateCar(e.car, (float)(now - carTime[e.car]) + TRANSITION_SLACK);
+            carTime[e.car] = now;
+            e.floor = bank.getCar(e.car).controller.getElevator().currentFloor;
+            scheduleCar(e.car);
+            break;
+        }
+
+        ++processedCount;
+        processed = e;
+        return true;
+    }
+
+	// nothing before endTime: bring everything up to it
+    if (endTime > now) {
+        now = endTime;
+        syncAllCars(now);
+    }
+    return false;
+}
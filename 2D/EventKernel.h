@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Types.h"
+#include "Constants.h"
+#include "ElevatorBank.h"
+#include <queue>
+#include <vector>
+
+// Kinds of events the kernel processes
+enum class SimEventType {
+    CarArrival,        // car reached its target floor
+    DoorsOpened,       // doors fully open
+    DoorTimerExpired,  // doors start closing
+    DoorsClosed,       // doors fully closed
+    HallCall,          // passenger arrival at a floor
+    CarCall,           // passenger request from inside a car
+	DestinationCall,   // passenger keys in a destination at a floor (no car assigned here)
+	Timer              // wake-up for the caller (batched dispatch), every car brought up to it
+};
+
+struct SimEvent {
+    double time;
+    SimEventType type;
+	int car;             // car events and car calls, -1 otherwise
+	int floor;           // floor of the call or arrival
+	CallDirection direction; // hall calls
+	int legFloor;        // hall calls: where the passenger rides to, -1 if any car will do
+	unsigned generation; // car events: stale once the car is rescheduled
+	unsigned long long sequence; // ties at the same time keep insertion order
+};
+
+// Discrete-event driver for an ElevatorBank: instead of stepping every frame,
+// each car has one pending event at the time of its next state change
+// (closed form, see ElevatorController::timeToNextTransition). The clock jumps
+// from event to event, so idle periods cost nothing.
+class EventKernel {
+public:
+    explicit EventKernel(ElevatorBank& bank);
+
+    // Drop all pending events and restart the clock
+    void reset(double startTime = 0.0);
+
+    // Calls at a future time (passenger arrivals)
+    void scheduleHallCall(double time, int floorIndex, CallDirection direction = CallDirection::Any, int legFloor = -1);
+    void scheduleCarCall(double time, int carIndex, int floorIndex);
+    void scheduleDestinationCall(double time, int floorIndex);
+    void scheduleTimer(double time);
+
+    // Calls at the current time (e.g. in reaction to a processed event)
+    int hallCall(int floorIndex, CallDirection direction = CallDirection::Any, int legFloor = -1);
+	void assignHallCall(int carIndex, int floorIndex, CallDirection direction); // no dispatcher
+    bool carCall(int carIndex, int floorIndex);
+	void transferPassengers(int carIndex, int alighting, int boarding); // moves the car's door event
+
+    // Process the next event up to endTime. Returns false (with the clock and
+    // all cars moved to endTime) when nothing is left before endTime.
+    bool processNext(double endTime, SimEvent& processed);
+
+    // Getters
+    double getTime() const { return now; }
+    long long getProcessedCount() const { return processedCount; }
+    size_t getPendingCount() const { return events.size(); }
+
+private:
+    struct Later {
+        bool operator()(const SimEvent& a, const SimEvent& b) const {
+            return a.time > b.time || (a.time == b.time && a.sequence > b.sequence);
+        }
+    };
+
+    ElevatorBank& bank;
+    std::priority_queue<SimEvent, std::vector<SimEvent>, Later> events;
+    std::vector<double> carTime;         // time each car was last brought up to
+    std::vector<unsigned> carGeneration;
+    double now;
+    unsigned long long nextSequence;
+    long long processedCount;
+
+    void push(double time, SimEventType type, int car, int floorIndex, unsigned generation,
+              CallDirection direction = CallDirection::Any, int legFloor = -1);
+    void syncCar(int carIndex, double time);
+    void syncAllCars(double time);
+    void scheduleCar(int carIndex);
+    void rescheduleAllCars();
+};
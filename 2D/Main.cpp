@@ -1,7 +1,9 @@
 ﻿#include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <fstream>
 #include <iostream>
+#include <string>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -11,16 +13,34 @@
 #include "Helpers.h"
 #include "Types.h"
 #include "Constants.h"
+#include "BuildingConfig.h"
 #include "Renderer.h"
+#include "TextureAtlas.h"
 #include "ElevatorController.h"
+#include "ElevatorBank.h"
 #include "PersonController.h"
 #include "ButtonPanel.h"
-
-// Global deltaTime (seconds)
-float deltaTime = 0.0f;
+#include "Simulation.h"
+#include "Statistics.h"
+#include "SimThread.h"
+
+// The scene keeps its screen coordinates and is stretched over the new size;
+// the cached static layers are drawn again at the next frame
+static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    if (width <= 0 || height <= 0) return; // minimized
+    glViewport(0, 0, width, height);
+    Renderer* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
+    if (renderer) renderer->invalidateStaticLayer();
+}
 
 int main()
 {
+    // Building (floors, cars, speeds, door timings)
+    BuildingConfig building;
+    if (!loadBuildingConfig(BUILDING_CONFIG_FILE, building)) {
+        std::cout << "Koristim podrazumevanu zgradu." << std::endl;
+    }
+
     // GLFW init
     if (!glfwInit()) {
         return endProgram("GLFW nije uspeo da se inicijalizuje.");
@@ -87,79 +107,132 @@ int main()
     shader.setMat4("uProjection", projection);
     shader.setInt("uTexture", 0);
 
+	// button panel, one instanced draw
+    Shader panelShader("panel.vert", "panel.frag");
+    panelShader.use();
+    panelShader.setMat4("uProjection", projection);
+    panelShader.setInt("uTexture", 0);
+
     // Initialize floors
-    Floor floors[FLOOR_COUNT];
+    std::vector<Floor> floors;
     float buildingBottomY = 100.0f;
     float buildingTopY = (float)screenHeight - 160.0f;
     float floorThickness = 8.0f;
-    float floorSpacing = (buildingTopY - buildingBottomY) / (FLOOR_COUNT - 1);
+    float pixelsPerMetre = layoutFloors(floors, building, buildingBottomY, buildingTopY, floorThickness);
+    float floorSpacing = building.getMinStoreyHeight() * pixelsPerMetre;
 
-    for (int i = 0; i < FLOOR_COUNT; ++i) {
-        float centerY = buildingBottomY + floorSpacing * i;
-        floors[i].yBottom = centerY - floorThickness * 0.5f;
-        floors[i].yTop = centerY + floorThickness * 0.5f;
-    }
-
-    // Initialize elevator
+    // Initialize elevator bank (cars side by side, the last one at the right edge)
     float shaftMarginRight = 40.0f;
     float elevatorScale = 1.8f;
     float elevatorRightX = (float)screenWidth - shaftMarginRight;
-    float elevatorX = elevatorRightX - (60.0f * elevatorScale);
     float elevatorHeight = floorSpacing * 0.6f * elevatorScale;
-
-    ElevatorController elevatorController;
     float elevatorWidth = 60.0f * elevatorScale;
-    elevatorController.initialize(floors, elevatorX, floorSpacing, FLOOR_1, elevatorWidth, elevatorHeight);
+    float carSpacing = elevatorWidth + CAR_SPACING;
+    float lastElevatorX = elevatorRightX - elevatorWidth;
+    float firstElevatorX = lastElevatorX - carSpacing * (building.carCount - 1);
+
+    ElevatorBank bank;
+    bank.initialize(building.carCount, floors, firstElevatorX, carSpacing, floorSpacing, building.startFloor,
+                    elevatorWidth, elevatorHeight);
+    MotionLimits limits(building.carSpeed * pixelsPerMetre, building.carAccel * pixelsPerMetre,
+                        building.carJerk * pixelsPerMetre);
+    bank.setMotion(limits, building.doorAnimDuration, building.doorOpenTime);
+    applyZones(bank, building, pixelsPerMetre);
+    std::vector<Elevator> elevators;
+    bank.getElevators(elevators);
+    std::vector<FloorMask> servedFloors(bank.getCarCount());
+    for (int i = 0; i < bank.getCarCount(); ++i) {
+        servedFloors[i] = bank.getCar(i).controller.getServedFloors();
+    }
 
-    // Initialize corridor
+    // Initialize corridor (the person walks along the doorways of all cars)
     float midX = screenWidth / 2.0f;
     float corridorLeftX = midX + 60.0f;
-    float corridorRightX = elevatorX - 20.0f;
+    float corridorRightX = lastElevatorX - 20.0f;
 
     // Initialize person
     PersonController personController;
-    personController.initialize(floors, corridorLeftX, elevatorHeight, FLOOR_PR);
+    personController.initialize(floors, corridorLeftX, elevatorHeight, building.lobbyFloor);
 
     // Initialize button panel
     ButtonPanel buttonPanel;
-    buttonPanel.initialize(screenWidth, screenHeight);
+    buttonPanel.initialize(screenWidth, screenHeight, building.floorCount);
 
     // Initialize renderer
     Renderer renderer(screenWidth, screenHeight);
     renderer.initialize(floors, corridorLeftX, corridorRightX, 
-                       elevatorController.getElevator(), buildingBottomY, buildingTopY);
-
-    // Load textures
-    unsigned int overlayTexture = loadImageToTexture("textures/ime.png");
-    unsigned int elevatorTexture = loadImageToTexture("textures/elevator_open.png");
-    unsigned int doorTexture = loadImageToTexture("textures/elevator_door.png");
-    unsigned int personTexture = loadImageToTexture("textures/person.png");
-    unsigned int personTextureLeft = loadImageToTexture("textures/person_left.png");
-    unsigned int buildingTexture = loadImageToTexture("textures/small_brick_wall.png");
-
-    unsigned int floorLabelTextures[FLOOR_COUNT];
-    floorLabelTextures[FLOOR_SU] = loadImageToTexture("textures/floor_SU.png");
-    floorLabelTextures[FLOOR_PR] = loadImageToTexture("textures/floor_PR.png");
-    floorLabelTextures[FLOOR_1] = loadImageToTexture("textures/floor1.png");
-    floorLabelTextures[FLOOR_2] = loadImageToTexture("textures/floor2.png");
-    floorLabelTextures[FLOOR_3] = loadImageToTexture("textures/floor3.png");
-    floorLabelTextures[FLOOR_4] = loadImageToTexture("textures/floor4.png");
-    floorLabelTextures[FLOOR_5] = loadImageToTexture("textures/floor5.png");
-    floorLabelTextures[FLOOR_6] = loadImageToTexture("textures/floor6.png");
-
-    unsigned int openBtnTex = loadImageToTexture("textures/open.png");
-    unsigned int closeBtnTex = loadImageToTexture("textures/close.png");
-    unsigned int stopBtnTex = loadImageToTexture("textures/stop.png");
-    unsigned int ventBtnTex = loadImageToTexture("textures/fan.png");
-    unsigned int cursorFanTexture = loadImageToTexture("textures/fan_cursor_black.png");
-    unsigned int cursorFanTexturePink = loadImageToTexture("textures/fan_cursor_pink2.png");
-
-    // Game state
-    int targetFloor = elevatorController.getElevator().currentFloor;
-    bool hasTargetFloor = false;
-    std::vector<int> floorQueue;
-    bool ventilationOn = false;
-    bool doorExtendedThisCycle = false;
+                       elevators, servedFloors, buildingBottomY, buildingTopY);
+    glfwSetWindowUserPointer(window, &renderer);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+
+    // Load textures, all packed into one atlas (the frame draws from one page)
+    TextureAtlas atlas;
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    atlas.addPixels("white", 1, 1, white);
+    atlas.add("overlay", "textures/ime.png");
+    atlas.add("elevator", "textures/elevator_open.png");
+    atlas.add("door", "textures/elevator_door.png");
+    atlas.add("person", "textures/person.png");
+    atlas.add("person_left", "textures/person_left.png");
+    atlas.add("building", "textures/small_brick_wall.png");
+
+	// floor labels: textures/floor_SU.png, floor_PR.png, floor1.png, ... (floors without an image stay unlabeled)
+    std::vector<std::string> floorLabelNames(building.floorCount);
+    for (int i = 0; i < building.floorCount; ++i) {
+        std::string label = building.getFloorLabel(i);
+        bool numbered = (label[0] >= '0' && label[0] <= '9');
+        std::string path = "textures/floor" + (numbered ? label : "_" + label) + ".png";
+        if (std::ifstream(path)) {
+            floorLabelNames[i] = "floor" + label;
+            atlas.add(floorLabelNames[i], path);
+        }
+    }
+
+    atlas.add("open", "textures/open.png");
+    atlas.add("close", "textures/close.png");
+    atlas.add("stop", "textures/stop.png");
+    atlas.add("fan", "textures/fan.png");
+    atlas.add("fan_cursor", "textures/fan_cursor_black.png");
+    atlas.add("fan_cursor_pink", "textures/fan_cursor_pink2.png");
+    atlas.build();
+
+    SceneSprites sprites;
+    sprites.plain = atlas.get("white");
+    sprites.building = atlas.get("building");
+    sprites.elevator = atlas.get("elevator");
+    sprites.door = atlas.get("door");
+    sprites.person = atlas.get("person");
+    sprites.personLeft = atlas.get("person_left");
+    sprites.overlay = atlas.get("overlay");
+    sprites.cursorFan = atlas.get("fan_cursor");
+    sprites.cursorFanPink = atlas.get("fan_cursor_pink");
+    sprites.openButton = atlas.get("open");
+    sprites.closeButton = atlas.get("close");
+    sprites.stopButton = atlas.get("stop");
+    sprites.ventButton = atlas.get("fan");
+    for (const std::string& name : floorLabelNames) {
+        sprites.floorLabels.push_back(atlas.get(name));
+    }
+
+    // Simulation runs on its own thread from here on; the loop below only
+    // forwards input and draws the snapshots it publishes
+    SimThread simThread(bank, personController, buttonPanel, floors, corridorLeftX, lastElevatorX);
+    simThread.start();
+
+	// keys forwarded to the simulation, sent when they go down or up
+    struct KeyBinding {
+        int glfwKey;
+        InputKey key;
+        bool down;
+    };
+    KeyBinding keyBindings[] = {
+        { GLFW_KEY_A, InputKey::Left, false },
+        { GLFW_KEY_D, InputKey::Right, false },
+        { GLFW_KEY_W, InputKey::CallUp, false },
+        { GLFW_KEY_S, InputKey::CallDown, false },
+        { GLFW_KEY_L, InputKey::Scheduling, false },
+    };
+    bool statsVisible = false;
 
     // Main loop
     while (!glfwWindowShouldClose(window))
@@ -170,41 +243,11 @@ int main()
             glfwSetWindowShouldClose(window, true);
         }
 
-        // Update person movement
-        float corridorMaxXOutside = elevatorController.getElevator().x - personController.getPerson().width;
-        personController.update(deltaTime, window, floors, elevatorController.getElevator(),
-                               corridorLeftX, corridorMaxXOutside);
-
-        // Handle elevator call (C key)
-        if (personController.handleElevatorCall(window, elevatorController.getElevator(),
-                                               floorQueue, hasTargetFloor, targetFloor)) {
-            if (elevatorController.getElevator().currentFloor == personController.getCurrentFloor()) {
-                if (elevatorController.getElevator().state == ElevatorState::Idle ||
-                    elevatorController.getElevator().state == ElevatorState::DoorsClosing) {
-                    elevatorController.openDoors();
-                    doorExtendedThisCycle = false;
-                }
-                else if (elevatorController.getElevator().state == ElevatorState::DoorsOpen) {
-                    elevatorController.extendDoorTimer();
-                }
-            }
-        }
-
-        // Handle person entering/exiting elevator
-        personController.handleElevatorInteraction(elevatorController.getElevator(), floors);
-        
-        // Handle exit from elevator
-        if (personController.getPerson().inElevator && 
-            elevatorController.getElevator().state == ElevatorState::DoorsOpen) {
-            float insideMinX = elevatorController.getElevator().x + 5.0f;
-            if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS && 
-                personController.getPerson().x <= insideMinX + 1.0f) {
-                Person& person = personController.getPerson();
-                person.inElevator = false;
-                int newFloor = elevatorController.getElevator().currentFloor;
-                person.x = elevatorController.getElevator().x - person.width;
-                person.y = floors[newFloor].yTop;
-                personController.setCurrentFloor(newFloor);
+        for (KeyBinding& binding : keyBindings) {
+            bool down = (glfwGetKey(window, binding.glfwKey) == GLFW_PRESS);
+            if (down != binding.down) {
+                binding.down = down;
+                simThread.post({ InputEventType::Key, binding.key, down, 0.0f, 0.0f });
             }
         }
 
@@ -219,57 +262,54 @@ int main()
         bool leftMouseClick = leftMouseDown && !leftMouseWasDown;
         leftMouseWasDown = leftMouseDown;
 
-        if (leftMouseClick && personController.getPerson().inElevator) {
-            buttonPanel.handleClick(mouseXF, mouseYGL, personController.getPerson().inElevator,
-                                   elevatorController, ventilationOn,
-                                   floorQueue, hasTargetFloor, targetFloor);
+        if (leftMouseClick) {
+            simThread.post({ InputEventType::Click, InputKey::Left, true, mouseXF, mouseYGL });
         }
 
-        // Update elevator
-        int floorButtonIndices[FLOOR_COUNT];
-        for (int i = 0; i < FLOOR_COUNT; ++i) {
-            floorButtonIndices[i] = buttonPanel.getFloorButtonIndex(i);
+        const SimSnapshot& snapshot = simThread.latest();
+
+        // Statistics overlay (H key), the numbers go to the console
+        static bool hWasPressed = false;
+        bool hIsPressed = (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS);
+        if (hIsPressed && !hWasPressed) {
+            statsVisible = !statsVisible;
+            if (statsVisible) {
+                const LatencyHistogram& wait = snapshot.personStats.waitTime;
+                const LatencyHistogram& trip = snapshot.personStats.tripTime;
+                std::cout << "Cekanje p50/95/99/max: " << wait.percentile(50) << " / " << wait.percentile(95) << " / "
+                          << wait.percentile(99) << " / " << wait.getMax() << " s (" << wait.getCount() << ")" << std::endl;
+                std::cout << "Voznja  p50/95/99/max: " << trip.percentile(50) << " / " << trip.percentile(95) << " / "
+                          << trip.percentile(99) << " / " << trip.getMax() << " s (" << trip.getCount() << ")" << std::endl;
+            }
         }
-        elevatorController.update(deltaTime, floors, floorQueue, hasTargetFloor, targetFloor,
-                                 ventilationOn,
-                                 floorButtonIndices,
-                                 buttonPanel.getButtons(),
-                                 buttonPanel.getVentilationButtonIndex());
+        hWasPressed = hIsPressed;
+
+        // how far real time is past the snapshot's tick
+        double sinceTick = std::chrono::duration<double>(std::chrono::steady_clock::now() - snapshot.tickTime).count();
+        float alpha = static_cast<float>(sinceTick / SIM_TICK);
+        if (alpha > 1.0f) alpha = 1.0f;
 
         // Update renderer geometry
-        renderer.updateElevatorGeometry(elevatorController.getElevator());
-        renderer.updateDoorGeometry(elevatorController.getElevator());
-        renderer.updatePersonGeometry(personController.getPerson());
+        renderer.updateElevatorGeometry(snapshot.previousElevators, snapshot.elevators, alpha);
+        renderer.updatePersonGeometry(snapshot.previousPerson, snapshot.person, alpha);
 
         // Clear and render
         glClear(GL_COLOR_BUFFER_BIT);
 
         renderer.renderAll(shader,
-                           buildingTexture,
-                           elevatorTexture,
-                           doorTexture,
-                           personTexture,
-                           personTextureLeft,
-                           overlayTexture,
-                           cursorFanTexture,
-                           cursorFanTexturePink,
+                           panelShader,
+                           sprites,
                            floors,
-                           elevatorController.getElevator(),
-                           personController.getPerson(),
-                           buttonPanel.getButtons(),
-                           floorLabelTextures,
-                           openBtnTex,
-                           closeBtnTex,
-                           stopBtnTex,
-                           ventBtnTex,
-                           floorButtonIndices,
-                           buttonPanel.getOpenButtonIndex(),
-                           buttonPanel.getCloseButtonIndex(),
-                           buttonPanel.getStopButtonIndex(),
-                           buttonPanel.getVentilationButtonIndex(),
+                           snapshot.elevators,
+                           snapshot.person,
+                           snapshot.buttons,
                            mouseXF, mouseYGL,
                            corridorLeftX,
-                           ventilationOn);
+                           snapshot.ventilationOn,
+                           snapshot.hallUp,
+                           snapshot.hallDown,
+                           snapshot.personCar,
+                           statsVisible ? &snapshot.personStats : nullptr);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -281,13 +321,10 @@ int main()
         if (frameDuration < TARGET_FRAME_TIME) {
             double sleepTime = TARGET_FRAME_TIME - frameDuration;
             std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
-            frameEndTime = glfwGetTime();
-            frameDuration = frameEndTime - frameStartTime;
         }
-
-        deltaTime = static_cast<float>(frameDuration);
     }
 
+    simThread.stop();
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,191 @@
+#include "MotionProfile.h"
+#include <cmath>
+
+// Newton steps when solving a constant-jerk segment for a position (cubic)
+static const int NEWTON_STEPS = 12;
+
+// Time to get from standstill to `speed`, and the part of it spent ramping the
+// acceleration up (the same again ramps it down)
+static void rampTimes(float speed, const MotionLimits& limits, float& rampTime, float& jerkTime) {
+    float a = limits.maxAccel;
+    float j = limits.maxJerk;
+    if (j <= 0.0f) {
+        jerkTime = 0.0f;
+        rampTime = speed / a;
+    }
+    else if (speed >= a * a / j) {
+        jerkTime = a / j; // reaches full acceleration, holds it, ramps down
+        rampTime = speed / a + jerkTime;
+    }
+    else {
+        jerkTime = std::sqrt(speed / j); // ramps straight up and down again
+        rampTime = 2.0f * jerkTime;
+    }
+}
+
+// Highest speed a rest-to-rest run over `distance` reaches (limits.maxAccel > 0)
+static float peakSpeedFor(float distance, const MotionLimits& limits) {
+    float rampTime, jerkTime;
+    rampTimes(limits.maxSpeed, limits, rampTime, jerkTime);
+	// speeding up and braking cover speed * rampTime together (symmetric ramps)
+    if (distance >= limits.maxSpeed * rampTime) return limits.maxSpeed;
+
+    float a = limits.maxAccel;
+    float j = limits.maxJerk;
+    if (j <= 0.0f) return std::sqrt(distance * a);
+
+	// v^2 / a + v * a / j = distance, valid while the full acceleration is reached
+    float v = 0.5f * a * (std::sqrt(a * a / (j * j) + 4.0f * distance / a) - a / j);
+    if (v >= a * a / j) return v;
+
+	// 2 * v * sqrt(v / j) = distance
+    return std::cbrt(distance * distance * j * 0.25f);
+}
+
+MotionProfile::MotionProfile()
+    : segmentCount(0), distance(0.0f), duration(0.0f), peakSpeed(0.0f), divergeTime(0.0f) {
+}
+
+void MotionProfile::plan(float newDistance, const MotionLimits& limits) {
+    segmentCount = 0;
+    distance = newDistance > 0.0f ? newDistance : 0.0f;
+    duration = 0.0f;
+    peakSpeed = 0.0f;
+    divergeTime = 0.0f;
+    if (distance <= 0.0f || limits.maxSpeed <= 0.0f) return;
+
+    if (limits.maxAccel <= 0.0f) {
+		// constant speed from the first moment
+        Segment& s = segments[segmentCount++];
+        s.start = 0.0f;
+        s.position = 0.0f;
+        s.velocity = limits.maxSpeed;
+        s.accel = 0.0f;
+        s.jerk = 0.0f;
+        peakSpeed = limits.maxSpeed;
+        duration = distance / limits.maxSpeed;
+        divergeTime = duration;
+        return;
+    }
+
+    peakSpeed = peakSpeedFor(distance, limits);
+    float rampTime, jerkTime;
+    rampTimes(peakSpeed, limits, rampTime, jerkTime);
+    float cruiseTime = (distance - peakSpeed * rampTime) / peakSpeed;
+    if (cruiseTime < 0.0f) cruiseTime = 0.0f;
+
+    float j = limits.maxJerk > 0.0f ? limits.maxJerk : 0.0f;
+    float peakAccel = j > 0.0f ? j * jerkTime : limits.maxAccel;
+    float holdTime = rampTime - 2.0f * jerkTime;
+
+    addSegment(jerkTime, 0.0f, j);
+    addSegment(holdTime, peakAccel, 0.0f);
+    addSegment(jerkTime, peakAccel, -j);
+    addSegment(cruiseTime, 0.0f, 0.0f);
+    addSegment(jerkTime, 0.0f, -j);
+    addSegment(holdTime, -peakAccel, 0.0f);
+    addSegment(jerkTime, -peakAccel, j);
+
+	// until then the car runs flat out (full acceleration, then full speed)
+    bool cruises = (peakSpeed >= limits.maxSpeed);
+    divergeTime = cruises ? rampTime + cruiseTime : rampTime - jerkTime;
+}
+
+void MotionProfile::addSegment(float length, float accel, float jerk) {
+    if (length <= 0.0f) return;
+
+    Segment& s = segments[segmentCount];
+    s.start = duration;
+    s.position = 0.0f;
+    s.velocity = 0.0f;
+    if (segmentCount > 0) {
+        const Segment& prev = segments[segmentCount - 1];
+        float t = duration - prev.start;
+        s.position = prev.position + t * (prev.velocity + t * (0.5f * prev.accel + t * prev.jerk / 6.0f));
+        s.velocity = prev.velocity + t * (prev.accel + 0.5f * prev.jerk * t);
+    }
+    s.accel = accel;
+    s.jerk = jerk;
+
+    ++segmentCount;
+    duration += length;
+}
+
+float MotionProfile::travelTime(float distance, const MotionLimits& limits) {
+    if (distance <= 0.0f || limits.maxSpeed <= 0.0f) return 0.0f;
+    if (limits.maxAccel <= 0.0f) return distance / limits.maxSpeed;
+
+    float peak = peakSpeedFor(distance, limits);
+    float rampTime, jerkTime;
+    rampTimes(peak, limits, rampTime, jerkTime);
+    float cruiseTime = (distance - peak * rampTime) / peak;
+    return 2.0f * rampTime + (cruiseTime > 0.0f ? cruiseTime : 0.0f);
+}
+
+int MotionProfile::segmentAt(float t) const {
+    int i = segmentCount - 1;
+    while (i > 0 && segments[i].start > t) --i;
+    return i;
+}
+
+float MotionProfile::positionAt(float t) const {
+    if (t <= 0.0f || segmentCount == 0) return 0.0f;
+    if (t >= duration) return distance;
+
+    const Segment& s = segments[segmentAt(t)];
+    float tau = t - s.start;
+    float p = s.position + tau * (s.velocity + tau * (0.5f * s.accel + tau * s.jerk / 6.0f));
+    return p < distance ? p : distance;
+}
+
+float MotionProfile::velocityAt(float t) const {
+    if (t < 0.0f || t >= duration || segmentCount == 0) return 0.0f;
+
+    const Segment& s = segments[segmentAt(t)];
+    float tau = t - s.start;
+    float v = s.velocity + tau * (s.accel + 0.5f * s.jerk * tau);
+    return v > 0.0f ? v : 0.0f;
+}
+
+float MotionProfile::timeToReach(float position) const {
+    if (position <= 0.0f || segmentCount == 0) return 0.0f;
+    if (position >= distance) return duration;
+
+    int i = segmentCount - 1;
+    while (i > 0 && segments[i].position > position) --i;
+    const Segment& s = segments[i];
+    float length = (i + 1 < segmentCount ? segments[i + 1].start : duration) - s.start;
+    float remaining = position - s.position;
+    if (remaining <= 0.0f) return s.start;
+
+	// constant acceleration: exact root, written so it also holds for a = 0 and braking
+    float disc = s.velocity * s.velocity + 2.0f * s.accel * remaining;
+    float denom = s.velocity + std::sqrt(disc > 0.0f ? disc : 0.0f);
+    float tau = denom > 0.0f ? 2.0f * remaining / denom : length;
+
+    if (s.jerk != 0.0f) {
+		// cubic: safeguarded Newton from the constant-acceleration guess
+        float lo = 0.0f;
+        float hi = length;
+        for (int k = 0; k < NEWTON_STEPS; ++k) {
+            if (!(tau > lo && tau < hi)) tau = 0.5f * (lo + hi);
+            float f = s.position + tau * (s.velocity + tau * (0.5f * s.accel + tau * s.jerk / 6.0f)) - position;
+            if (f > 0.0f) hi = tau;
+            else lo = tau;
+            float v = s.velocity + tau * (s.accel + 0.5f * s.jerk * tau);
+            tau = (v > 0.0f) ? tau - f / v : 0.5f * (lo + hi);
+        }
+    }
+
+    if (tau < 0.0f) tau = 0.0f;
+    if (tau > length) tau = length;
+    return s.start + tau;
+}
+
+bool MotionProfile::retarget(float elapsed, float newDistance, const MotionLimits& limits) {
+    MotionProfile next;
+    next.plan(newDistance, limits);
+    if (elapsed > divergeTime || elapsed > next.divergeTime) return false;
+    *this = next;
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Speed, acceleration and jerk limits of a car (any length unit, seconds)
+struct MotionLimits {
+    float maxSpeed;
+	float maxAccel;  // <= 0: full speed at once (constant speed, no ramps)
+	float maxJerk;   // <= 0: no jerk limit (trapezoidal speed profile)
+
+    MotionLimits() : maxSpeed(1.0f), maxAccel(0.0f), maxJerk(0.0f) {}
+    MotionLimits(float speed, float accel, float jerk) : maxSpeed(speed), maxAccel(accel), maxJerk(jerk) {}
+};
+
+// Rest-to-rest run over a distance: accelerate, cruise, decelerate, with the
+// acceleration ramped by the jerk limit (up to 7 constant-jerk segments).
+// Everything is closed form, so position and arrival queries cost O(1) and
+// match what stepping the car frame by frame would give.
+class MotionProfile {
+public:
+    static const int MAX_SEGMENTS = 7;
+
+    MotionProfile();
+
+    // Plan a run of `distance` (>= 0) from standstill to standstill
+    void plan(float distance, const MotionLimits& limits);
+
+    // Duration of a rest-to-rest run without building the profile
+    static float travelTime(float distance, const MotionLimits& limits);
+
+    // Distance covered and speed t seconds after the start (clamped to the run)
+    float positionAt(float t) const;
+    float velocityAt(float t) const;
+
+    // First time the car has covered `position` (0 .. distance)
+    float timeToReach(float position) const;
+
+    // Switch to the run for newDistance without a jolt. Only possible while both
+    // runs still share the same start (full acceleration or cruise), i.e. the car
+    // can still brake normally for the new end point. Returns false otherwise.
+    bool retarget(float elapsed, float newDistance, const MotionLimits& limits);
+
+    // Getters
+    float getDistance() const { return distance; }
+    float getDuration() const { return duration; }
+	float getPeakSpeed() const { return peakSpeed; }
+	float getDivergeTime() const { return divergeTime; } // last moment a shorter or longer run looks the same
+
+private:
+    struct Segment {
+        float start;     // seconds from the start of the run
+        float position;  // state at the start of the segment
+        float velocity;
+        float accel;
+        float jerk;
+    };
+
+    Segment segments[MAX_SEGMENTS];
+    int segmentCount;
+    float distance;
+    float duration;
+    float peakSpeed;
+    float divergeTime;
+
+    void addSegment(float length, float accel, float jerk);
+    int segmentAt(float t) const;
+};
@@ -0,0 +1,114 @@
+#include "PanelRenderer.h"
+#include <cstddef>
+#include <cstring>
+
+// Dark frame around every face, in pixels
+static const float PANEL_BORDER = 3.0f;
+
+PanelRenderer::PanelRenderer()
+    : VAO(0), quadVBO(0), quadEBO(0), instanceVBO(0), texture(0), instanceCapacity(0),
+      handleProgram(0), mouseUniform{ -1 }, hoverUniform{ -1 }, borderUniform{ -1 } {
+}
+
+void PanelRenderer::initialize() {
+    const float corners[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+    const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &quadEBO);
+    glGenBuffers(1, &instanceVBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	// one PanelInstance per button, advanced per instance
+    GLsizei stride = sizeof(PanelInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PanelInstance, x0));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PanelInstance, u0));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PanelInstance, iconWidth));
+    glVertexAttribIPointer(4, 4, GL_UNSIGNED_BYTE, stride, (void*)offsetof(PanelInstance, type));
+    for (int attribute = 1; attribute <= 4; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+}
+
+void PanelRenderer::update(const std::vector<Button>& buttons, const std::vector<AtlasRegion>& icons,
+                           const std::vector<bool>& served) {
+    texture = 0;
+    for (const AtlasRegion& icon : icons) {
+        if (icon.texture != 0) {
+            texture = icon.texture;
+            break;
+        }
+    }
+
+    instances.resize(buttons.size());
+    for (size_t i = 0; i < buttons.size(); ++i) {
+        const Button& b = buttons[i];
+        PanelInstance& instance = instances[i];
+        std::memset(&instance, 0, sizeof(instance));
+        instance.x0 = b.x0;
+        instance.y0 = b.y0;
+        instance.x1 = b.x1;
+        instance.y1 = b.y1;
+        if (i < icons.size() && icons[i].texture != 0 && icons[i].texture == texture) {
+            instance.u0 = icons[i].u0;
+            instance.v0 = icons[i].v0;
+            instance.u1 = icons[i].u1;
+            instance.v1 = icons[i].v1;
+			// floor labels are a bit smaller than the control icons
+            instance.iconWidth = (b.type == ButtonType::Floor) ? 0.45f : 0.6f;
+            instance.iconHeight = (b.type == ButtonType::Floor) ? 0.35f : 0.4f;
+        }
+        instance.type = (unsigned char)b.type;
+        instance.pressed = b.pressed ? 1 : 0;
+        instance.served = (i >= served.size() || served[i]) ? 1 : 0;
+    }
+
+    if (instances.size() == uploaded.size() &&
+        (instances.empty() || std::memcmp(instances.data(), uploaded.data(), instances.size() * sizeof(PanelInstance)) == 0)) {
+        return;
+    }
+    uploaded = instances;
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if ((int)uploaded.size() > instanceCapacity) {
+        instanceCapacity = (int)uploaded.size();
+        glBufferData(GL_ARRAY_BUFFER, uploaded.size() * sizeof(PanelInstance), uploaded.data(), GL_DYNAMIC_DRAW);
+    }
+    else if (!uploaded.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, uploaded.size() * sizeof(PanelInstance), uploaded.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PanelRenderer::draw(const Shader& panelShader, float mouseX, float mouseY, bool hoverEnabled) {
+    if (uploaded.empty()) return;
+
+    if (handleProgram != panelShader.ID) {
+        handleProgram = panelShader.ID;
+        mouseUniform = panelShader.getUniform("uMouse");
+        hoverUniform = panelShader.getUniform("uHoverEnabled");
+        borderUniform = panelShader.getUniform("uBorder");
+    }
+
+    panelShader.use();
+    panelShader.setVec2(mouseUniform, mouseX, mouseY);
+    panelShader.setInt(hoverUniform, hoverEnabled ? 1 : 0);
+    panelShader.setFloat(borderUniform, PANEL_BORDER);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0, (GLsizei)uploaded.size());
+    glBindVertexArray(0);
+}
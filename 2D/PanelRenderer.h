@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "Types.h"
+#include "TextureAtlas.h"
+#include "Shader.h"
+#include <vector>
+
+// Per-instance data of one panel button (layout 1 .. 4 of panel.vert)
+struct PanelInstance {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+	float iconWidth, iconHeight;  // part of the face the icon covers, 0 without icon
+	unsigned char type, pressed, served, unused;
+};
+
+// Draws the whole button panel (border, face and icon of every button) with
+// one instanced call of a shared unit quad. The buttons go to the GPU only
+// when they change; colors, pressed and hover are worked out in panel.frag,
+// so a frame costs the same for 12 buttons or 200. Icons have to be on one
+// atlas page, a button whose icon lies elsewhere is drawn without it.
+class PanelRenderer {
+public:
+    PanelRenderer();
+
+    // GL objects (needs a current context)
+    void initialize();
+
+	// Buttons as they are now, with the icon of each (texture 0: none) and
+	// whether the car stops at its floor; uploads only what changed
+    void update(const std::vector<Button>& buttons, const std::vector<AtlasRegion>& icons,
+                const std::vector<bool>& served);
+
+    // Draw the buttons with panelShader (leaves it in use); hover lights the
+    // button under the mouse while hoverEnabled
+    void draw(const Shader& panelShader, float mouseX, float mouseY, bool hoverEnabled);
+
+private:
+    unsigned int VAO, quadVBO, quadEBO, instanceVBO;
+	unsigned int texture;  // atlas page of the icons
+    int instanceCapacity;
+
+    std::vector<PanelInstance> instances;
+	std::vector<PanelInstance> uploaded;  // what the instance buffer holds
+
+	// uniforms of the shader the handles were looked up in
+    unsigned int handleProgram;
+    UniformHandle mouseUniform, hoverUniform, borderUniform;
+};
@@ -0,0 +1,237 @@
+#include "PassengerPopulation.h"
+#include "ElevatorBank.h"
+
+PassengerPopulation::PassengerPopulation() {
+    clear();
+}
+
+void PassengerPopulation::clear() {
+    originFloor.clear();
+    destinationFloor.clear();
+    legFloor.clear();
+    transferCount.clear();
+    spawnTime.clear();
+    boardTime.clear();
+    alightTime.clear();
+    state.clear();
+    car.clear();
+    assignedCar.clear();
+    waiting.clear();
+    riding.clear();
+    boarded.clear();
+    transfers.clear();
+    recalls.clear();
+    reentries.clear();
+    deliveredPerWindow.clear();
+    arrivedCount = 0;
+    stats.clear();
+}
+
+void PassengerPopulation::reserve(size_t count) {
+    originFloor.reserve(count);
+    destinationFloor.reserve(count);
+    legFloor.reserve(count);
+    transferCount.reserve(count);
+    spawnTime.reserve(count);
+    boardTime.reserve(count);
+    alightTime.reserve(count);
+    state.reserve(count);
+    car.reserve(count);
+    assignedCar.reserve(count);
+}
+
+int PassengerPopulation::spawn(int origin, int destination, double time, int leg) {
+    int id = (int)state.size();
+    originFloor.push_back((int16_t)origin);
+    destinationFloor.push_back((int16_t)destination);
+    legFloor.push_back((int16_t)(leg >= 0 ? leg : destination));
+    transferCount.push_back(0);
+    spawnTime.push_back(time);
+    boardTime.push_back(0.0);
+    alightTime.push_back(0.0);
+    state.push_back(PassengerState::Waiting);
+    car.push_back(-1);
+    assignedCar.push_back(ANY_CAR);
+    waiting.push_back(id);
+    return id;
+}
+
+int PassengerPopulation::getPeakHandling() const {
+    int peak = 0;
+    for (int n : deliveredPerWindow) {
+        if (n > peak) peak = n;
+    }
+    return peak;
+}
+
+void PassengerPopulation::countPassengers(BankSnapshot& snapshot) const {
+    for (int id : waiting) {
+        int floorIndex = originFloor[id];
+        if (floorIndex >= BankSnapshot::MAX_FLOORS) continue;
+        uint16_t& count = (legFloor[id] < floorIndex) ? snapshot.waitingDown[floorIndex] : snapshot.waitingUp[floorIndex];
+        if (count < UINT16_MAX) ++count;
+    }
+    for (int id : riding) {
+        int c = car[id];
+        int floorIndex = legFloor[id];
+        if (c < 0 || c >= snapshot.carCount || floorIndex >= BankSnapshot::MAX_FLOORS) continue;
+        uint16_t& count = snapshot.riding[c][floorIndex];
+        if (count < UINT16_MAX) ++count;
+    }
+}
+
+void PassengerPopulation::update(double time, const ElevatorBank& bank) {
+    boarded.clear();
+    transfers.clear();
+    recalls.clear();
+    reentries.clear();
+
+    int carCount = bank.getCarCount();
+    openCarAtFloor.assign(bank.getFloorCount() * 2, -1);
+    openFloorOfCar.assign(carCount, -1);
+    leavingOfCar.assign(carCount, CallDirection::Any);
+    freeSpace.assign(carCount, 0);
+    alighted.assign(carCount, 0);
+    boardedInto.assign(carCount, 0);
+    recalledCycle.resize(carCount * 2, 0);
+    bool anyOpen = false;
+    for (int c = 0; c < carCount; ++c) {
+        const ElevatorController& controller = bank.getCar(c).controller;
+        const Elevator& elevator = controller.getElevator();
+        if (elevator.state == ElevatorState::DoorsOpen) {
+            int floorIndex = elevator.currentFloor;
+            openFloorOfCar[c] = floorIndex;
+            freeSpace[c] = controller.getFreeSpace();
+            anyOpen = true;
+
+			// a LOOK car leaving up or down only takes passengers going that way
+            CallDirection leaving = controller.leavingDirection();
+            leavingOfCar[c] = leaving;
+            bool anyWay = (leaving == CallDirection::Any);
+            if ((anyWay || leaving == CallDirection::Up) && openCarAtFloor[floorIndex * 2] < 0) {
+                openCarAtFloor[floorIndex * 2] = c;
+            }
+            if ((anyWay || leaving == CallDirection::Down) && openCarAtFloor[floorIndex * 2 + 1] < 0) {
+                openCarAtFloor[floorIndex * 2 + 1] = c;
+            }
+        }
+    }
+    if (!anyOpen) return;
+
+	// riders get off first (swap-remove keeps the list dense)
+    changing.clear();
+    for (size_t k = 0; k < riding.size();) {
+        int id = riding[k];
+        int c = car[id];
+        if (openFloorOfCar[c] == legFloor[id] && legFloor[id] != destinationFloor[id]) {
+			// sky lobby: off this car, the next leg starts here
+            ++alighted[c];
+            if (freeSpace[c] < bank.getCar(c).controller.getCapacity()) ++freeSpace[c];
+            state[id] = PassengerState::Waiting;
+            car[id] = -1;
+            originFloor[id] = legFloor[id];
+            legFloor[id] = (int16_t)bank.nextLegFloor(originFloor[id], destinationFloor[id]);
+            ++transferCount[id];
+            changing.push_back(id);
+            riding[k] = riding.back();
+            riding.pop_back();
+        }
+        else if (openFloorOfCar[c] == destinationFloor[id]) {
+            state[id] = PassengerState::Arrived;
+            alightTime[id] = time;
+            stats.tripTime.record(time - boardTime[id]);
+            ++arrivedCount;
+            ++alighted[c];
+            if (freeSpace[c] < bank.getCar(c).controller.getCapacity()) ++freeSpace[c];
+
+            size_t window = (size_t)(time / HANDLING_WINDOW);
+            if (window >= deliveredPerWindow.size()) deliveredPerWindow.resize(window + 1, 0);
+            ++deliveredPerWindow[window];
+            riding[k] = riding.back();
+            riding.pop_back();
+        }
+        else {
+            ++k;
+        }
+    }
+
+    for (size_t k = 0; k < waiting.size();) {
+        int id = waiting[k];
+        bool down = legFloor[id] < originFloor[id];
+        int entry = originFloor[id] * 2 + (down ? 1 : 0);
+        int c = openCarAtFloor[entry];
+        int assigned = assignedCar[id];
+        if (assigned != ANY_CAR) {
+			// only the assigned car, once it stands open here going their way
+            CallDirection leaving = (assigned >= 0) ? leavingOfCar[assigned] : CallDirection::Any;
+            bool rightWay = (leaving == CallDirection::Any || (leaving == CallDirection::Down) == down);
+            c = (assigned >= 0 && openFloorOfCar[assigned] == originFloor[id] && rightWay) ? assigned : -1;
+            if (c >= 0 && freeSpace[c] <= 0) {
+                assignedCar[id] = CAR_PENDING;
+                reentries.push_back(id);
+                c = -1;
+            }
+        }
+        else {
+            if (c >= 0 && !bank.getCar(c).controller.servesFloor(legFloor[id])) {
+				// zoned: only a car of the passenger's zone, if one stands open here too
+                c = -1;
+                for (int other = 0; other < carCount && c < 0; ++other) {
+                    CallDirection leaving = leavingOfCar[other];
+                    bool rightWay = (leaving == CallDirection::Any || (leaving == CallDirection::Down) == down);
+                    if (openFloorOfCar[other] == originFloor[id] && rightWay &&
+                        bank.getCar(other).controller.servesFloor(legFloor[id])) {
+                        c = other;
+                    }
+                }
+            }
+            if (c >= 0 && freeSpace[c] <= 0) {
+				// full: whoever waits here that way calls again, once per door cycle
+				// (the car stays open over many updates)
+                unsigned int cycle = bank.getCar(c).controller.getDoorCycle() + 1;
+                unsigned int& recalled = recalledCycle[c * 2 + (down ? 1 : 0)];
+                if (recalled != cycle) {
+                    recalled = cycle;
+                    recalls.push_back({ originFloor[id], down ? CallDirection::Down : CallDirection::Up, legFloor[id] });
+                }
+                if (openCarAtFloor[entry] == c) openCarAtFloor[entry] = -1;
+                c = -1;
+            }
+        }
+        if (c >= 0) {
+            --freeSpace[c];
+            ++boardedInto[c];
+            state[id] = PassengerState::Riding;
+            car[id] = (int16_t)c;
+            if (transferCount[id] == 0) {
+				// the trip runs from the first boarding, changes included
+                boardTime[id] = time;
+                stats.waitTime.record(time - spawnTime[id]);
+            }
+            riding.push_back(id);
+            boarded.push_back(id);
+            waiting[k] = waiting.back();
+            waiting.pop_back();
+        }
+        else {
+            ++k;
+        }
+    }
+
+	// passengers changing cars wait from the next update on, after calling their next car
+    for (int id : changing) {
+        waiting.push_back(id);
+        if (assignedCar[id] != ANY_CAR) {
+            assignedCar[id] = CAR_PENDING;
+            reentries.push_back(id);
+        }
+        else {
+            bool down = legFloor[id] < originFloor[id];
+            recalls.push_back({ originFloor[id], down ? CallDirection::Down : CallDirection::Up, legFloor[id] });
+        }
+    }
+
+    for (int c = 0; c < carCount; ++c) {
+        if (alighted[c] > 0 || boardedInto[c] > 0) transfers.push_back({ c, alighted[c], boardedInto[c] });
+    }
+}
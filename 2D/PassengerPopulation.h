@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Types.h"
+#include "Constants.h"
+#include "Statistics.h"
+#include "CallRegistry.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ElevatorBank;
+struct BankSnapshot;
+
+// Passenger lifecycle
+enum class PassengerState : uint8_t {
+    Waiting,  // at the origin floor, hall call made
+    Riding,   // inside a car
+    Arrived   // got off at the destination
+};
+
+// Passengers through one car's doors in one update
+struct CarTransfer {
+    int car;
+    int alighting;
+    int boarding;
+};
+
+// Passengers a full car left behind, or who change cars at a sky lobby, press the button
+struct HallRecall {
+    int floor;
+    CallDirection direction;
+	int legFloor;  // where they ride to (zoned banks have buttons per zone)
+};
+
+// assignedCar of a passenger who may take any car going their way / who waits
+// for destination dispatch to assign one
+const int16_t ANY_CAR = -1;
+const int16_t CAR_PENDING = -2;
+
+// Length of the windows for the handling capacity count, seconds
+const double HANDLING_WINDOW = 300.0;
+
+// Simulated passengers (not the controllable Person) in structure-of-arrays
+// layout: one contiguous array per attribute, indexed by passenger id. The
+// batch update only walks the waiting and riding index lists, so finished
+// passengers cost nothing per tick.
+class PassengerPopulation {
+public:
+    PassengerPopulation();
+
+    void clear();
+    void reserve(size_t count);
+
+    // New passenger waiting at originFloor, riding to legFloor first (a sky
+    // lobby in a zoned bank, see ElevatorBank::nextLegFloor; -1: straight to
+    // destinationFloor); returns its id
+    int spawn(int originFloor, int destinationFloor, double time, int legFloor = -1);
+
+    // Board waiting passengers into cars standing open at their floor (going
+    // their way, see ElevatorController::leavingDirection, and while there is
+    // room) and let riders off at the end of their leg. A passenger with an
+    // assigned car only takes that car; one getting off at a transfer floor
+    // waits there for the next leg. The caller applies the results:
+    // getTransfers() to the cars' loads and door timers, getBoarded() ids as
+    // car calls (to legFloor), getRecalls() as new hall calls and
+    // getReentries() (passengers without a car: theirs had no room or they
+    // changed cars, now CAR_PENDING) as new destination entries.
+    void update(double time, const ElevatorBank& bank);
+
+    const std::vector<int>& getBoarded() const { return boarded; }
+    const std::vector<CarTransfer>& getTransfers() const { return transfers; }
+    const std::vector<HallRecall>& getRecalls() const { return recalls; }
+    const std::vector<int>& getReentries() const { return reentries; }
+    const std::vector<int>& getWaiting() const { return waiting; }
+
+    // Add everyone waiting (by floor and way of their ride) and riding (by car
+    // and the floor they get off at) to the passenger counts of a snapshot
+    void countPassengers(BankSnapshot& snapshot) const;
+
+    // Counts
+    int size() const { return (int)state.size(); }
+    int getWaitingCount() const { return (int)waiting.size(); }
+    int getRidingCount() const { return (int)riding.size(); }
+    int getArrivedCount() const { return arrivedCount; }
+
+	// Most passengers delivered in one HANDLING_WINDOW (fixed windows from time 0)
+    int getPeakHandling() const;
+
+    // Wait (spawn -> boarding) and trip (boarding -> alighting) histograms
+    const PassengerStats& getStats() const { return stats; }
+
+    // Attribute arrays (index = passenger id)
+	std::vector<int16_t> originFloor;      // where the current leg starts
+    std::vector<int16_t> destinationFloor;
+	std::vector<int16_t> legFloor;         // where the current ride ends (destination or transfer floor)
+	std::vector<uint8_t> transferCount;    // cars changed so far
+    std::vector<double> spawnTime;
+    std::vector<double> boardTime;
+    std::vector<double> alightTime;
+    std::vector<PassengerState> state;
+	std::vector<int16_t> car;  // car boarded, -1 before boarding
+	std::vector<int16_t> assignedCar;  // car to take (destination dispatch), ANY_CAR or CAR_PENDING
+
+private:
+	std::vector<int> waiting;  // ids in Waiting state
+	std::vector<int> riding;   // ids in Riding state
+    std::vector<int> boarded;
+    std::vector<CarTransfer> transfers;
+    std::vector<HallRecall> recalls;
+    std::vector<int> reentries;
+
+	// per update: car standing open at each floor for up (2 * floor) and down
+	// (2 * floor + 1) passengers / floor each car stands open at
+    std::vector<int> openCarAtFloor;
+    std::vector<int> openFloorOfCar;
+    std::vector<CallDirection> leavingOfCar;
+    std::vector<int> freeSpace;
+    std::vector<int> alighted;
+    std::vector<int> boardedInto;
+	// per car and way (2 * car + 1 for down): door cycle + 1 in which people
+	// left behind by the full car called again, 0 never
+    std::vector<unsigned int> recalledCycle;
+
+	std::vector<int> changing;  // per update: got off at a transfer floor
+	std::vector<int> deliveredPerWindow;  // arrivals per HANDLING_WINDOW
+
+    int arrivedCount;
+    PassengerStats stats;
+};
@@ -1,11 +1,12 @@
 #include "PersonController.h"
+#include "ElevatorBank.h"
 #include <cmath>
 #include <iostream>
 
-PersonController::PersonController() : personFloorIndex(FLOOR_PR), personSpeed(350.0f) {
+PersonController::PersonController() : personFloorIndex(0), personSpeed(350.0f) {
 }
 
-void PersonController::initialize(const Floor floors[FLOOR_COUNT], float corridorLeftX, float elevatorHeight, int startFloor) {
+void PersonController::initialize(const std::vector<Floor>& floors, float corridorLeftX, float elevatorHeight, int startFloor) {
 	person.height = elevatorHeight * 0.8f;       // person is 80% of elevator height
     person.width = person.height * 0.6f;
     person.inElevator = false;
@@ -15,15 +16,15 @@ void PersonController::initialize(const Floor floors[FLOOR_COUNT], float corrido
 	person.x = corridorLeftX + 40.0f;      // away from the elevator, on the left side
 }
 
-void PersonController::update(float deltaTime, GLFWwindow* window, const Floor floors[FLOOR_COUNT],
+void PersonController::update(float deltaTime, bool moveLeft, bool moveRight, const std::vector<Floor>& floors,
                              const Elevator& elevator, float corridorLeftX, float corridorMaxXOutside) {
 	// 1) Movement: A and W for left/right
     float dx = 0.0f;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
+    if (moveLeft) {
         dx -= personSpeed * deltaTime;
         person.facingRight = false;
     }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
+    if (moveRight) {
         dx += personSpeed * deltaTime;
         person.facingRight = true;
     }
@@ -52,39 +53,18 @@ void PersonController::update(float deltaTime, GLFWwindow* window, const Floor f
     }
 }
 
-bool PersonController::handleElevatorCall(GLFWwindow* window, const Elevator& elevator,
-                                         std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor) {
-	// C key press detection, call elevator
-    static bool cWasPressed = false;
-    bool cIsPressed = (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS);
-    bool cJustPressed = cIsPressed && !cWasPressed;
-    cWasPressed = cIsPressed;
-
-    if (cJustPressed && !person.inElevator && isInFrontOfElevator(elevator)) {
-		// 1) Elevator is already on my floor -> just manage doors
-        if (elevator.currentFloor == personFloorIndex) {
-            return true; // Signal that doors should be opened
-        }
-		// 2) Elvator is not on my floor -> call it
-        else {
-            if (!hasTargetFloor && elevator.state == ElevatorState::Idle) {
-				// elvator idle - go directly to my floor
-                targetFloor = personFloorIndex;
-                hasTargetFloor = true;
-            }
-            else {
-				// already has a target floor - queue my floor if not already queued
-                floorQueue.push_back(personFloorIndex);
-            }
-            std::cout << "Lift pozvan na sprat: " << personFloorIndex << std::endl;
-            return true;
-        }
+bool PersonController::handleElevatorCall(ElevatorBank& bank, CallDirection direction) {
+    if (!person.inElevator &&
+        bank.carInFrontOf(person.x, person.x + person.width) >= 0) {
+		// hall call: a car already on my floor going that way just opens its doors, otherwise the dispatcher sends one
+        bank.hallCall(personFloorIndex, direction);
+        return true;
     }
     return false;
 }
 
 
-void PersonController::handleElevatorInteraction(const Elevator& elevator, const Floor floors[FLOOR_COUNT]) {
+void PersonController::handleElevatorInteraction(const Elevator& elevator, const std::vector<Floor>& floors) {
     bool doorsAreOpen = (elevator.state == ElevatorState::DoorsOpen);
     bool elevatorAtPersonsFloor = (elevator.currentFloor == personFloorIndex);
     bool inFrontOfElevator = isInFrontOfElevator(elevator);
@@ -106,8 +86,9 @@ void PersonController::handleElevatorInteraction(const Elevator& elevator, const
 }
 
 bool PersonController::isInFrontOfElevator(const Elevator& elevator) const {
-    float personRight = person.x + person.width;
-    float elevatorLeft = elevator.x;
-	return std::fabs(personRight - elevatorLeft) < 2.0f; // tolerance of 2 pixels
+	// standing at the car's doorway: centre between just left of the car and its right edge
+    float personCenter = person.x + person.width * 0.5f;
+    return personCenter >= elevator.x - person.width * 0.5f - 2.0f && // tolerance of 2 pixels
+           personCenter <= elevator.x + elevator.width;
 }
 
@@ -2,25 +2,27 @@
 
 #include "Types.h"
 #include "Constants.h"
-#include <GLFW/glfw3.h>
+#include "CallRegistry.h"
+#include <vector>
+
+class ElevatorBank;
 
 // Controls person movement and interaction with elevator
 class PersonController {
 public:
     PersonController();
     
-    void initialize(const Floor floors[FLOOR_COUNT], float corridorLeftX, float elevatorHeight, int startFloor);
+    void initialize(const std::vector<Floor>& floors, float corridorLeftX, float elevatorHeight, int startFloor);
     
-    // Update person position and handle input
-    void update(float deltaTime, GLFWwindow* window, const Floor floors[FLOOR_COUNT],
+    // Update person position from the held movement keys (A left, D right)
+    void update(float deltaTime, bool moveLeft, bool moveRight, const std::vector<Floor>& floors,
                 const Elevator& elevator, float corridorLeftX, float corridorMaxXOutside);
     
-    // Handle elevator call (C key)
-    bool handleElevatorCall(GLFWwindow* window, const Elevator& elevator, 
-                           std::vector<int>& floorQueue, bool& hasTargetFloor, int& targetFloor);
+    // Handle elevator call (C key press), the bank picks which car answers
+    bool handleElevatorCall(ElevatorBank& bank, CallDirection direction);
     
     // Handle entering/exiting elevator
-    void handleElevatorInteraction(const Elevator& elevator, const Floor floors[FLOOR_COUNT]);
+    void handleElevatorInteraction(const Elevator& elevator, const std::vector<Floor>& floors);
     
     // Getters
     Person& getPerson() { return person; }
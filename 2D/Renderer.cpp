@@ -1,706 +1,447 @@
 #include "Renderer.h"
 #include "Shader.h"
+#include "Statistics.h"
 #include <GL/glew.h>
-
-Renderer::Renderer(int screenWidth, int screenHeight) 
-    : screenWidth(screenWidth), screenHeight(screenHeight),
-      VAO(0), VBO(0), EBO(0),
-      overlayVAO(0), overlayVBO(0), overlayEBO(0),
-      floorsVAO(0), floorsVBO(0), floorsEBO(0),
-      elevatorVAO(0), elevatorVBO(0), elevatorEBO(0),
-      doorVAO(0), doorVBO(0), doorEBO(0),
-      shaftVAO(0), shaftVBO(0), shaftEBO(0),
-      personVAO(0), personVBO(0), personEBO(0),
-      buttonVAO(0), buttonVBO(0), buttonEBO(0),
-      labelVAO(0), labelVBO(0), labelEBO(0),
-      cursorVAO(0), cursorVBO(0), cursorEBO(0) {
+#include <iostream>
+
+// Statistics overlay: bars per chart and the chart size in pixels
+static const int STATS_BINS = 40;
+static const float STATS_CHART_WIDTH = 400.0f;
+static const float STATS_CHART_HEIGHT = 120.0f;
+
+// Draw order of the sprite batch, back to front. Quads of one layer must not
+// overlap each other (the batch groups them by texture). Background to
+// landings, the side labels and the overlay are the static layer: cached,
+// they are one quad at LAYER_BACKGROUND.
+enum Layer {
+    LAYER_BACKGROUND,
+    LAYER_SHAFTS,
+    LAYER_FLOORS,
+    LAYER_LANDINGS,
+    LAYER_CABS,
+    LAYER_PERSON_INSIDE,
+    LAYER_DOORS,
+    LAYER_PERSON_OUTSIDE,
+    LAYER_HALL_BUTTONS,
+	LAYER_LABELS,        // side floor labels
+    LAYER_OVERLAY,
+	// the button panel is drawn here (PanelRenderer)
+    LAYER_STATS_BACK,
+    LAYER_STATS_BARS,
+    LAYER_STATS_MARKS,
+    LAYER_CURSOR
+};
+
+Renderer::Renderer(int screenWidth, int screenHeight)
+    : screenWidth(screenWidth), screenHeight(screenHeight), carCount(0), floorCount(0), minFloorSpacing(0.0f),
+      staticFramebuffer(0), staticTexture(0), staticDirty(true), drawnPerson() {
 }
 
 Renderer::~Renderer() {
 }
 
-void Renderer::initialize(const Floor floors[FLOOR_COUNT], float corridorLeftX, float corridorRightX,
-                          const Elevator& elevator, float buildingBottomY, float buildingTopY) {
-    setupBackgroundGeometry();
-    setupOverlayGeometry();
+void Renderer::initialize(const std::vector<Floor>& floors, float corridorLeftX, float corridorRightX,
+                          const std::vector<Elevator>& elevators, const std::vector<FloorMask>& servedFloors,
+                          float buildingBottomY, float buildingTopY) {
+    carCount = (int)elevators.size();
+    this->servedFloors = servedFloors;
+    drawnElevators = elevators;
+    batch.initialize();
+    panel.initialize();
     setupFloorsGeometry(floors, corridorLeftX, corridorRightX);
-    setupElevatorGeometry(elevator);
-    setupDoorGeometry();
-    setupShaftGeometry(elevator, buildingBottomY, buildingTopY);
-    setupPersonGeometry(Person{});
-    setupButtonGeometry();
-    setupLabelGeometry();
-    setupCursorGeometry();
-}
-
-void Renderer::setupBackgroundGeometry() {
-    Vertex vertices[8];
-    float midX = screenWidth / 2.0f;
-
-    // Left half
-    vertices[0] = { 0.0f, 0.0f, 0.0f, 0.0f };
-    vertices[1] = { midX, 0.0f, 1.0f, 0.0f };
-    vertices[2] = { midX, (float)screenHeight, 1.0f, 1.0f };
-    vertices[3] = { 0.0f, (float)screenHeight, 0.0f, 1.0f };
-
-    // Right half
-    vertices[4] = { midX, 0.0f, 0.0f, 0.0f };
-    vertices[5] = { (float)screenWidth, 0.0f, 1.0f, 0.0f };
-    vertices[6] = { (float)screenWidth, (float)screenHeight, 1.0f, 1.0f };
-    vertices[7] = { midX, (float)screenHeight, 0.0f, 1.0f };
-
-    unsigned int indices[12] = {
-        0, 1, 2, 2, 3, 0,
-        4, 5, 6, 6, 7, 4
-    };
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+    setupHallButtonGeometry(floors, corridorLeftX);
+    setupShaftGeometry(elevators, buildingBottomY, buildingTopY);
+    setupLandingGeometry(floors, elevators);
+    setupStaticLayer();
 }
 
-void Renderer::setupOverlayGeometry() {
-    Vertex overlayVertices[4];
-    unsigned int overlayIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
-    float margin = 20.0f;
-    float overlayWidth = 200.0f;
-    float overlayHeight = 80.0f;
-
-    float x0 = margin;
-    float y1 = screenHeight - margin;
-    float y0 = y1 - overlayHeight;
-    float x1 = x0 + overlayWidth;
-
-    overlayVertices[0] = { x0, y0, 0.0f, 0.0f };
-    overlayVertices[1] = { x1, y0, 1.0f, 0.0f };
-    overlayVertices[2] = { x1, y1, 1.0f, 1.0f };
-    overlayVertices[3] = { x0, y1, 0.0f, 1.0f };
-
-    glGenVertexArrays(1, &overlayVAO);
-    glGenBuffers(1, &overlayVBO);
-    glGenBuffers(1, &overlayEBO);
-
-    glBindVertexArray(overlayVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(overlayVertices), overlayVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, overlayEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(overlayIndices), overlayIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-}
-
-void Renderer::setupFloorsGeometry(const Floor floors[FLOOR_COUNT], float corridorLeftX, float corridorRightX) {
-    Vertex floorVertices[FLOOR_COUNT * 4];
-    unsigned int floorIndices[FLOOR_COUNT * 6];
-
-    for (int i = 0; i < FLOOR_COUNT; ++i) {
-        int vBase = i * 4;
-        int iBase = i * 6;
-
-        float y0 = floors[i].yBottom;
-        float y1 = floors[i].yTop;
+void Renderer::setupFloorsGeometry(const std::vector<Floor>& floors, float corridorLeftX, float corridorRightX) {
+    floorCount = (int)floors.size();
 
-        floorVertices[vBase + 0] = { corridorLeftX, y0, 0.0f, 0.0f };
-        floorVertices[vBase + 1] = { corridorRightX, y0, 1.0f, 0.0f };
-        floorVertices[vBase + 2] = { corridorRightX, y1, 1.0f, 1.0f };
-        floorVertices[vBase + 3] = { corridorLeftX, y1, 0.0f, 1.0f };
-
-        floorIndices[iBase + 0] = vBase + 0;
-        floorIndices[iBase + 1] = vBase + 1;
-        floorIndices[iBase + 2] = vBase + 2;
-        floorIndices[iBase + 3] = vBase + 2;
-        floorIndices[iBase + 4] = vBase + 3;
-        floorIndices[iBase + 5] = vBase + 0;
+    minFloorSpacing = (float)screenHeight;
+    for (int i = 1; i < floorCount; ++i) {
+        float gap = floors[i].yTop - floors[i - 1].yTop;
+        if (gap < minFloorSpacing) minFloorSpacing = gap;
     }
 
-    glGenVertexArrays(1, &floorsVAO);
-    glGenBuffers(1, &floorsVBO);
-    glGenBuffers(1, &floorsEBO);
-
-    glBindVertexArray(floorsVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, floorsVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(floorVertices), floorVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, floorsEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(floorIndices), floorIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-}
-
-void Renderer::setupElevatorGeometry(const Elevator& elevator) {
-    unsigned int elevatorIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
-    float eBottom = elevator.y;
-    float eTop = elevator.y + elevator.height;
-    float eLeft = elevator.x;
-    float eRight = elevator.x + elevator.width;
-
-    elevatorVertices[0] = { eLeft, eBottom, 0.0f, 0.0f };
-    elevatorVertices[1] = { eRight, eBottom, 1.0f, 0.0f };
-    elevatorVertices[2] = { eRight, eTop, 1.0f, 1.0f };
-    elevatorVertices[3] = { eLeft, eTop, 0.0f, 1.0f };
-
-    glGenVertexArrays(1, &elevatorVAO);
-    glGenBuffers(1, &elevatorVBO);
-    glGenBuffers(1, &elevatorEBO);
-
-    glBindVertexArray(elevatorVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, elevatorVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(elevatorVertices), elevatorVertices, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elevatorEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elevatorIndices), elevatorIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-}
-
-void Renderer::setupDoorGeometry() {
-    unsigned int doorIndices[12] = {
-        0, 1, 2, 2, 3, 0,
-        4, 5, 6, 6, 7, 4
-    };
-
-    glGenVertexArrays(1, &doorVAO);
-    glGenBuffers(1, &doorVBO);
-    glGenBuffers(1, &doorEBO);
-
-    glBindVertexArray(doorVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, doorVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(doorVertices), nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, doorEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(doorIndices), doorIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+    floorRects.resize(floorCount);
+    for (int i = 0; i < floorCount; ++i) {
+        floorRects[i] = { corridorLeftX, floors[i].yBottom, corridorRightX, floors[i].yTop };
+    }
 }
 
-void Renderer::setupShaftGeometry(const Elevator& elevator, float buildingBottomY, float buildingTopY) {
-    Vertex shaftVertices[4];
-    unsigned int shaftIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
+void Renderer::setupShaftGeometry(const std::vector<Elevator>& elevators, float buildingBottomY, float buildingTopY) {
     float shaftPaddingX = 20.0f;
     float shaftPaddingY = 20.0f;
 
-    float shaftLeft = elevator.x - shaftPaddingX;
-    float shaftRight = elevator.x + elevator.width + shaftPaddingX;
-    float shaftBottom = buildingBottomY - shaftPaddingY;
-    float shaftTop = buildingTopY + shaftPaddingY;
-
-    shaftVertices[0] = { shaftLeft, shaftBottom, 0.0f, 0.0f };
-    shaftVertices[1] = { shaftRight, shaftBottom, 1.0f, 0.0f };
-    shaftVertices[2] = { shaftRight, shaftTop, 1.0f, 1.0f };
-    shaftVertices[3] = { shaftLeft, shaftTop, 0.0f, 1.0f };
-
-    glGenVertexArrays(1, &shaftVAO);
-    glGenBuffers(1, &shaftVBO);
-    glGenBuffers(1, &shaftEBO);
-
-    glBindVertexArray(shaftVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, shaftVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(shaftVertices), shaftVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shaftEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(shaftIndices), shaftIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-}
-
-void Renderer::setupPersonGeometry(const Person& person) {
-    unsigned int personIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
-    float pLeft = person.x;
-    float pRight = person.x + person.width;
-    float pTop = person.y + person.height;
-
-    personVertices[0] = { pLeft, person.y, 0.0f, 0.0f };
-    personVertices[1] = { pRight, person.y, 1.0f, 0.0f };
-    personVertices[2] = { pRight, pTop, 1.0f, 1.0f };
-    personVertices[3] = { pLeft, pTop, 0.0f, 1.0f };
-
-    glGenVertexArrays(1, &personVAO);
-    glGenBuffers(1, &personVBO);
-    glGenBuffers(1, &personEBO);
-
-    glBindVertexArray(personVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, personVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(personVertices), personVertices, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, personEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(personIndices), personIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-}
-
-void Renderer::setupButtonGeometry() {
-    unsigned int buttonIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
-    glGenVertexArrays(1, &buttonVAO);
-    glGenBuffers(1, &buttonVBO);
-    glGenBuffers(1, &buttonEBO);
-
-    glBindVertexArray(buttonVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, buttonVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(buttonVertices), nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buttonEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(buttonIndices), buttonIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+	// one shaft per car
+    shaftRects.resize(carCount);
+    for (int i = 0; i < carCount; ++i) {
+        const Elevator& elevator = elevators[i];
+        shaftRects[i] = { elevator.x - shaftPaddingX, buildingBottomY - shaftPaddingY,
+                          elevator.x + elevator.width + shaftPaddingX, buildingTopY + shaftPaddingY };
+    }
 }
 
-void Renderer::setupLabelGeometry() {
-    unsigned int labelIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
-    glGenVertexArrays(1, &labelVAO);
-    glGenBuffers(1, &labelVBO);
-    glGenBuffers(1, &labelEBO);
-
-    glBindVertexArray(labelVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, labelVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(labelVertices), nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, labelEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(labelIndices), labelIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
 }
 
-void Renderer::setupCursorGeometry() {
-    unsigned int cursorIndices[6] = { 0, 1, 2, 2, 3, 0 };
-
-    glGenVertexArrays(1, &cursorVAO);
-    glGenBuffers(1, &cursorVBO);
-    glGenBuffers(1, &cursorEBO);
-
-    glBindVertexArray(cursorVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, cursorVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cursorVertices), nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cursorEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cursorIndices), cursorIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+// Car as it is drawn between two ticks
+static Elevator interpolateElevator(const Elevator& previous, const Elevator& current, float alpha) {
+    Elevator elevator = current;
+    elevator.y = lerp(previous.y, current.y, alpha);
+    elevator.doorOpenRatio = lerp(previous.doorOpenRatio, current.doorOpenRatio, alpha);
+    return elevator;
 }
 
-void Renderer::updateElevatorGeometry(const Elevator& elevator) {
-    float eBottomCur = elevator.y;
-    float eTopCur = elevator.y + elevator.height;
-    float eLeftCur = elevator.x;
-    float eRightCur = elevator.x + elevator.width;
-
-    elevatorVertices[0].x = eLeftCur;   elevatorVertices[0].y = eBottomCur;
-    elevatorVertices[1].x = eRightCur;  elevatorVertices[1].y = eBottomCur;
-    elevatorVertices[2].x = eRightCur;  elevatorVertices[2].y = eTopCur;
-    elevatorVertices[3].x = eLeftCur;   elevatorVertices[3].y = eTopCur;
-
-    glBindBuffer(GL_ARRAY_BUFFER, elevatorVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(elevatorVertices), elevatorVertices);
+void Renderer::updateElevatorGeometry(const std::vector<Elevator>& previous, const std::vector<Elevator>& current, float alpha) {
+    drawnElevators.resize(carCount);
+    for (int i = 0; i < carCount; ++i) {
+        drawnElevators[i] = interpolateElevator(previous[i], current[i], alpha);
+    }
 }
 
-void Renderer::updateDoorGeometry(const Elevator& elevator) {
-    float fullHeight = elevator.height;
-    float dBottom = elevator.y;
-    float dTop = elevator.y + fullHeight;
-    float fullWidth = elevator.width;
-    float centerX = elevator.x + fullWidth * 0.5f;
-    float halfWidth = fullWidth * 0.5f;
-    float slide = halfWidth * elevator.doorOpenRatio;
-
-    float leftWallX = elevator.x;
-    float rightWallX = elevator.x + fullWidth;
-
-    float leftLeft = leftWallX;
-    float leftRight = centerX - slide;
-    float rightRight = rightWallX;
-    float rightLeft = centerX + slide;
-
-    doorVertices[0] = { leftLeft, dBottom, 0.0f, 0.0f };
-    doorVertices[1] = { leftRight, dBottom, 0.5f, 0.0f };
-    doorVertices[2] = { leftRight, dTop, 0.5f, 1.0f };
-    doorVertices[3] = { leftLeft, dTop, 0.0f, 1.0f };
-
-    doorVertices[4] = { rightLeft, dBottom, 0.5f, 0.0f };
-    doorVertices[5] = { rightRight, dBottom, 1.0f, 0.0f };
-    doorVertices[6] = { rightRight, dTop, 1.0f, 1.0f };
-    doorVertices[7] = { rightLeft, dTop, 0.5f, 1.0f };
-
-    glBindBuffer(GL_ARRAY_BUFFER, doorVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(doorVertices), doorVertices);
+void Renderer::updatePersonGeometry(const Person& previous, const Person& current, float alpha) {
+	// stepping into or out of a car is a jump, not a slide
+    drawnPerson = current;
+    if (previous.inElevator == current.inElevator) {
+        drawnPerson.x = lerp(previous.x, current.x, alpha);
+        drawnPerson.y = lerp(previous.y, current.y, alpha);
+    }
 }
 
-void Renderer::updatePersonGeometry(const Person& person) {
-    float pLeftCur = person.x;
-    float pRightCur = person.x + person.width;
-    float pBottomCur = person.y;
-    float pTopCur = pBottomCur + person.height;
-
-    personVertices[0].x = pLeftCur;   personVertices[0].y = pBottomCur;
-    personVertices[1].x = pRightCur;  personVertices[1].y = pBottomCur;
-    personVertices[2].x = pRightCur;  personVertices[2].y = pTopCur;
-    personVertices[3].x = pLeftCur;   personVertices[3].y = pTopCur;
-
-    glBindBuffer(GL_ARRAY_BUFFER, personVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(personVertices), personVertices);
+void Renderer::addPerson(const AtlasRegion& personRight, const AtlasRegion& personLeft, int layer) {
+    const Person& person = drawnPerson;
+    const AtlasRegion& sprite = person.facingRight ? personRight : personLeft;
+    float x1 = person.x + person.width;
+    float y1 = person.y + person.height;
+    if (sprite.texture != 0) batch.addQuad(layer, sprite, person.x, person.y, x1, y1, 1.0f, 1.0f, 1.0f);
+    else batch.addQuad(layer, 0, person.x, person.y, x1, y1, 0.9f, 0.4f, 0.4f);
 }
 
 void Renderer::renderAll(Shader& shader,
-                        unsigned int buildingTexture,
-                        unsigned int elevatorTexture,
-                        unsigned int doorTexture,
-                        unsigned int personTexture,
-                        unsigned int personTextureLeft,
-                        unsigned int overlayTexture,
-                        unsigned int cursorFanTexture,
-                        unsigned int cursorFanTexturePink,
-                        const Floor floors[FLOOR_COUNT],
-                        const Elevator& elevator,
+                        Shader& panelShader,
+                        const SceneSprites& sprites,
+                        const std::vector<Floor>& floors,
+                        const std::vector<Elevator>& elevators,
                         const Person& person,
                         const std::vector<Button>& buttons,
-                        unsigned int floorLabelTextures[FLOOR_COUNT],
-                        unsigned int openBtnTex,
-                        unsigned int closeBtnTex,
-                        unsigned int stopBtnTex,
-                        unsigned int ventBtnTex,
-                        int floorButtonIndex[FLOOR_COUNT],
-                        int openButtonIndex,
-                        int closeButtonIndex,
-                        int stopButtonIndex,
-                        int ventilationButtonIndex,
                         float mouseX, float mouseY,
                         float corridorLeftX,
-                        bool ventilationOn) {
+                        bool ventilationOn,
+                        const FloorMask& hallUp,
+                        const FloorMask& hallDown,
+                        int panelCar,
+                        const PassengerStats* statsOverlay) {
     shader.use();
-
-    // Background - left half (panel)
-    glBindVertexArray(VAO);
-    shader.setInt("uUseTexture", 0);
-    shader.setVec4("uColor", 0.25f, 0.25f, 0.30f, 1.0f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(0));
-
-    // Background - right half (building)
-    glBindVertexArray(VAO);
-    if (buildingTexture != 0) {
-        shader.setInt("uUseTexture", 1);
-        shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, buildingTexture);
-    }
-    else {
-        shader.setInt("uUseTexture", 0);
-        shader.setVec4("uColor", 0.1f, 0.15f, 0.35f, 1.0f);
+    batch.setPlainRegion(sprites.plain);
+    if (staticDirty && staticFramebuffer != 0) {
+        renderStaticLayer(sprites, floors, corridorLeftX);
     }
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(6 * sizeof(unsigned int)));
-
-    // Elevator shaft
-    glBindVertexArray(shaftVAO);
-    shader.setInt("uUseTexture", 0);
-    shader.setVec4("uColor", 0.6f, 0.6f, 0.65f, 0.35f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
 
-    // Floors
-    glBindVertexArray(floorsVAO);
-    shader.setInt("uUseTexture", 0);
-    shader.setVec4("uColor", 0.92f, 0.92f, 0.98f, 1.0f);
-    glDrawElements(GL_TRIANGLES, FLOOR_COUNT * 6, GL_UNSIGNED_INT, (void*)0);
-
-    // Elevator cab
-    glBindVertexArray(elevatorVAO);
-    if (elevatorTexture != 0) {
-        shader.setInt("uUseTexture", 1);
-        shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, elevatorTexture);
+    batch.begin();
+    if (staticFramebuffer != 0) {
+		// background, building, shafts, floors, side labels and overlay as one quad
+        batch.addQuad(LAYER_BACKGROUND, staticTexture, 0.0f, 0.0f, (float)screenWidth, (float)screenHeight,
+                      1.0f, 1.0f, 1.0f);
     }
     else {
-        shader.setInt("uUseTexture", 0);
-        shader.setVec4("uColor", 0.8f, 0.8f, 0.85f, 1.0f);
-    }
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-
-    // Person inside elevator
-    if (person.inElevator) {
-        glBindVertexArray(personVAO);
-        unsigned int tex = person.facingRight ? personTexture : personTextureLeft;
-        if (tex != 0) {
-            shader.setInt("uUseTexture", 1);
-            shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, tex);
-        }
-        else {
-            shader.setInt("uUseTexture", 0);
-            shader.setVec4("uColor", 0.9f, 0.4f, 0.4f, 1.0f);
-        }
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+        addStaticLayers(sprites, floors, corridorLeftX);
     }
 
-    // Doors
-    if (elevator.doorOpenRatio < 1.0f) {
-        glBindVertexArray(doorVAO);
-        if (doorTexture != 0) {
-            shader.setInt("uUseTexture", 1);
-            shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, doorTexture);
-        }
-        else {
-            shader.setInt("uUseTexture", 0);
-            shader.setVec4("uColor", 0.2f, 0.2f, 0.3f, 1.0f);
-        }
-        glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, (void*)0);
+    // Elevator cabs and doors (two sliding leaves, opened by doorOpenRatio)
+    for (int i = 0; i < carCount; ++i) {
+        const Elevator& elevator = drawnElevators[i];
+        float x1 = elevator.x + elevator.width;
+        float y1 = elevator.y + elevator.height;
+        if (sprites.elevator.texture != 0) batch.addQuad(LAYER_CABS, sprites.elevator, elevator.x, elevator.y, x1, y1, 1.0f, 1.0f, 1.0f);
+        else batch.addQuad(LAYER_CABS, 0, elevator.x, elevator.y, x1, y1, 0.8f, 0.8f, 0.85f);
+
+        if (elevators[i].doorOpenRatio >= 1.0f) continue;
+        float centerX = elevator.x + elevator.width * 0.5f;
+        float slide = elevator.width * 0.5f * elevator.doorOpenRatio;
+        float dr = 0.2f, dg = 0.2f, db = 0.3f;
+        if (sprites.door.texture != 0) dr = dg = db = 1.0f;
+        batch.addQuad(LAYER_DOORS, sprites.door, elevator.x, elevator.y, centerX - slide, y1,
+                      dr, dg, db, 1.0f, 0.0f, 0.0f, 0.5f, 1.0f);
+        batch.addQuad(LAYER_DOORS, sprites.door, centerX + slide, elevator.y, x1, y1,
+                      dr, dg, db, 1.0f, 0.5f, 0.0f, 1.0f, 1.0f);
     }
 
-    // Person outside elevator
-    if (!person.inElevator) {
-        glBindVertexArray(personVAO);
-        unsigned int tex = person.facingRight ? personTexture : personTextureLeft;
-        if (tex != 0) {
-            shader.setInt("uUseTexture", 1);
-            shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, tex);
-        }
-        else {
-            shader.setInt("uUseTexture", 0);
-            shader.setVec4("uColor", 0.9f, 0.4f, 0.4f, 1.0f);
-        }
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-    }
-
-    // Buttons
-    glBindVertexArray(buttonVAO);
-    shader.setInt("uUseTexture", 0);
-    float btnWidth = 160.0f;
-    float btnHeight = 80.0f;
+    // Person, inside the car behind the doors or in front of them
+    addPerson(sprites.person, sprites.personLeft, person.inElevator ? LAYER_PERSON_INSIDE : LAYER_PERSON_OUTSIDE);
 
+    // Panel: per button its icon (floor label or control icon) and whether
+	// the car stops at its floor; drawn instanced right after LAYER_OVERLAY
+    const FloorMask* carServed = (panelCar >= 0 && panelCar < (int)servedFloors.size()) ? &servedFloors[panelCar] : nullptr;
+    panelIcons.assign(buttons.size(), AtlasRegion{ 0, 0.0f, 0.0f, 1.0f, 1.0f });
+    panelServed.assign(buttons.size(), true);
     for (size_t i = 0; i < buttons.size(); ++i) {
         const Button& b = buttons[i];
-        bool hovered = (person.inElevator &&
-            mouseX >= b.x0 && mouseX <= b.x1 &&
-            mouseY >= b.y0 && mouseY <= b.y1);
-
-        float border = 3.0f;
-        buttonVertices[0] = { b.x0 - border, b.y0 - border, 0.0f, 0.0f };
-        buttonVertices[1] = { b.x1 + border, b.y0 - border, 1.0f, 0.0f };
-        buttonVertices[2] = { b.x1 + border, b.y1 + border, 1.0f, 1.0f };
-        buttonVertices[3] = { b.x0 - border, b.y1 + border, 0.0f, 1.0f };
-
-        glBindBuffer(GL_ARRAY_BUFFER, buttonVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(buttonVertices), buttonVertices);
-        shader.setVec4("uColor", 0.05f, 0.05f, 0.08f, 1.0f);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-
-        buttonVertices[0] = { b.x0, b.y0, 0.0f, 0.0f };
-        buttonVertices[1] = { b.x1, b.y0, 1.0f, 0.0f };
-        buttonVertices[2] = { b.x1, b.y1, 1.0f, 1.0f };
-        buttonVertices[3] = { b.x0, b.y1, 0.0f, 1.0f };
-
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(buttonVertices), buttonVertices);
-
-        float r, g, bCol;
-        if (b.type == ButtonType::Floor) {
-            r = 0.55f; g = 0.55f; bCol = 0.65f;
-            if (b.pressed) {
-                r += 0.3f; g += 0.3f; bCol += 0.3f;
-            }
-        }
-        else if (b.type == ButtonType::Stop) {
-            r = 0.7f; g = 0.2f; bCol = 0.2f;
-            if (b.pressed) {
-                r = 0.95f; g = 0.25f; bCol = 0.25f;
-            }
-        }
-        else if (b.type == ButtonType::Ventilation) {
-            r = 0.25f; g = 0.6f; bCol = 0.25f;
-            if (b.pressed) {
-                r = 0.35f; g = 0.95f; bCol = 0.35f;
-            }
-        }
-        else {
-            r = 0.55f; g = 0.55f; bCol = 0.4f;
-            if (b.pressed) {
-                r += 0.25f; g += 0.25f; bCol += 0.1f;
-            }
+        switch (b.type) {
+        case ButtonType::Floor:
+            if (b.floorIndex >= 0 && b.floorIndex < (int)sprites.floorLabels.size()) panelIcons[i] = sprites.floorLabels[b.floorIndex];
+            if (carServed && b.floorIndex >= 0 && b.floorIndex < FloorMask::MAX_FLOORS) panelServed[i] = carServed->test(b.floorIndex);
+            break;
+        case ButtonType::OpenDoor: panelIcons[i] = sprites.openButton; break;
+        case ButtonType::CloseDoor: panelIcons[i] = sprites.closeButton; break;
+        case ButtonType::Stop: panelIcons[i] = sprites.stopButton; break;
+        case ButtonType::Ventilation: panelIcons[i] = sprites.ventButton; break;
         }
+    }
+    panel.update(buttons, panelIcons, panelServed);
+
+    addHallButtons(hallUp, hallDown);
+
+    // Statistics overlay (H): wait and trip histograms, top right of the panel half
+    if (statsOverlay) {
+        float chartX = screenWidth / 2.0f - 20.0f - STATS_CHART_WIDTH;
+        float chartTop = screenHeight - 20.0f;
+        addHistogramChart(statsOverlay->waitTime, chartX, chartTop - STATS_CHART_HEIGHT,
+                          STATS_CHART_WIDTH, STATS_CHART_HEIGHT, 0.35f, 0.65f, 0.95f);
+        addHistogramChart(statsOverlay->tripTime, chartX, chartTop - 2.0f * STATS_CHART_HEIGHT - 10.0f,
+                          STATS_CHART_WIDTH, STATS_CHART_HEIGHT, 0.85f, 0.6f, 0.3f);
+    }
 
-        if (hovered) {
-            r += 0.1f; g += 0.1f; bCol += 0.1f;
-        }
+    // Cursor
+    float cursorSize = 48.0f;
+    const AtlasRegion& cursor = ventilationOn ? sprites.cursorFanPink : sprites.cursorFan;
+    batch.addQuad(LAYER_CURSOR, cursor, mouseX - cursorSize * 0.5f, mouseY - cursorSize * 0.5f,
+                  mouseX + cursorSize * 0.5f, mouseY + cursorSize * 0.5f, 1.0f, 1.0f, 1.0f);
 
-        if (r > 1.0f) r = 1.0f;
-        if (g > 1.0f) g = 1.0f;
-        if (bCol > 1.0f) bCol = 1.0f;
+    batch.flush(LAYER_OVERLAY);
+    panel.draw(panelShader, mouseX, mouseY, person.inElevator);
+    shader.use();
+    batch.flush();
+}
 
-        shader.setVec4("uColor", r, g, bCol, 1.0f);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+void Renderer::addStaticLayers(const SceneSprites& sprites, const std::vector<Floor>& floors, float corridorLeftX) {
+    // Background - left half (panel), right half (building)
+    float midX = screenWidth / 2.0f;
+    batch.addQuad(LAYER_BACKGROUND, 0, 0.0f, 0.0f, midX, (float)screenHeight, 0.25f, 0.25f, 0.30f);
+    if (sprites.building.texture != 0) {
+        batch.addQuad(LAYER_BACKGROUND, sprites.building, midX, 0.0f, (float)screenWidth, (float)screenHeight,
+                      1.0f, 1.0f, 1.0f);
+    }
+    else {
+        batch.addQuad(LAYER_BACKGROUND, 0, midX, 0.0f, (float)screenWidth, (float)screenHeight, 0.1f, 0.15f, 0.35f);
     }
 
-    // Button icons
-    glBindVertexArray(labelVAO);
-    shader.setInt("uUseTexture", 1);
-    shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-
-    float iconW = 0.6f * btnWidth;
-    float iconH = 0.4f * btnHeight;
-
-    auto drawIconOnButton = [&](int btnIndex, unsigned int tex) {
-        if (btnIndex < 0 || btnIndex >= (int)buttons.size()) return;
-        if (tex == 0) return;
-
-        const Button& b = buttons[btnIndex];
-        float cx = 0.5f * (b.x0 + b.x1);
-        float cy = 0.5f * (b.y0 + b.y1);
-
-        float x0i = cx - iconW * 0.5f;
-        float x1i = cx + iconW * 0.5f;
-        float y0i = cy - iconH * 0.5f;
-        float y1i = cy + iconH * 0.5f;
-
-        labelVertices[0] = { x0i, y0i, 0.0f, 0.0f };
-        labelVertices[1] = { x1i, y0i, 1.0f, 0.0f };
-        labelVertices[2] = { x1i, y1i, 1.0f, 1.0f };
-        labelVertices[3] = { x0i, y1i, 0.0f, 1.0f };
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glBindBuffer(GL_ARRAY_BUFFER, labelVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(labelVertices), labelVertices);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-    };
+    // Elevator shafts
+    for (const Rect& r : shaftRects) {
+        batch.addQuad(LAYER_SHAFTS, 0, r.x0, r.y0, r.x1, r.y1, 0.6f, 0.6f, 0.65f, 0.35f);
+    }
 
-    drawIconOnButton(openButtonIndex, openBtnTex);
-    drawIconOnButton(closeButtonIndex, closeBtnTex);
-    drawIconOnButton(stopButtonIndex, stopBtnTex);
-    drawIconOnButton(ventilationButtonIndex, ventBtnTex);
-
-    // Floor labels
-    float labelWidthPanel = 0.45f * btnWidth;
-    float labelHeightPanel = 0.35f * btnHeight;
-    float labelWidthSide = 40.0f;
-    float labelHeightSide = 28.0f;
-
-    for (int f = 0; f < FLOOR_COUNT; ++f) {
-        unsigned int tex = floorLabelTextures[f];
-        if (tex == 0) continue;
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tex);
-
-        int btnIdx = floorButtonIndex[f];
-        if (btnIdx >= 0) {
-            const Button& b = buttons[btnIdx];
-            float cx = 0.5f * (b.x0 + b.x1);
-            float cy = 0.5f * (b.y0 + b.y1);
-
-            float x0p = cx - labelWidthPanel * 0.5f;
-            float x1p = cx + labelWidthPanel * 0.5f;
-            float y0p = cy - labelHeightPanel * 0.5f;
-            float y1p = cy + labelHeightPanel * 0.5f;
-
-            labelVertices[0] = { x0p, y0p, 0.0f, 0.0f };
-            labelVertices[1] = { x1p, y0p, 1.0f, 0.0f };
-            labelVertices[2] = { x1p, y1p, 1.0f, 1.0f };
-            labelVertices[3] = { x0p, y1p, 0.0f, 1.0f };
-
-            glBindBuffer(GL_ARRAY_BUFFER, labelVBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(labelVertices), labelVertices);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-        }
+    // Floors
+    for (const Rect& r : floorRects) {
+        batch.addQuad(LAYER_FLOORS, 0, r.x0, r.y0, r.x1, r.y1, 0.92f, 0.92f, 0.98f);
+    }
 
-        float centerY = 0.5f * (floors[f].yBottom + floors[f].yTop);
-        float lx = corridorLeftX - 50.0f;
+    // Landing sills of zoned cars (express sections have none)
+    for (const Rect& r : landingRects) {
+        batch.addQuad(LAYER_LANDINGS, 0, r.x0, r.y0, r.x1, r.y1, 0.95f, 0.75f, 0.3f);
+    }
 
-        float x0s = lx - labelWidthSide * 0.5f;
-        float x1s = lx + labelWidthSide * 0.5f;
-        float y0s = centerY - labelHeightSide * 0.5f;
-        float y1s = centerY + labelHeightSide * 0.5f;
+    // Side floor labels (shrink when floors are packed tightly)
+    float sideScale = (minFloorSpacing < 32.0f) ? minFloorSpacing / 32.0f : 1.0f;
+    float labelWidthSide = 40.0f * sideScale;
+    float labelHeightSide = 28.0f * sideScale;
 
-        labelVertices[0] = { x0s, y0s, 0.0f, 0.0f };
-        labelVertices[1] = { x1s, y0s, 1.0f, 0.0f };
-        labelVertices[2] = { x1s, y1s, 1.0f, 1.0f };
-        labelVertices[3] = { x0s, y1s, 0.0f, 1.0f };
+    for (int f = 0; f < floorCount && f < (int)sprites.floorLabels.size(); ++f) {
+        const AtlasRegion& label = sprites.floorLabels[f];
+        if (label.texture == 0) continue;
 
-        glBindBuffer(GL_ARRAY_BUFFER, labelVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(labelVertices), labelVertices);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+        float centerY = 0.5f * (floors[f].yBottom + floors[f].yTop);
+        float lx = corridorLeftX - 50.0f;
+        batch.addQuad(LAYER_LABELS, label, lx - labelWidthSide * 0.5f, centerY - labelHeightSide * 0.5f,
+                      lx + labelWidthSide * 0.5f, centerY + labelHeightSide * 0.5f, 1.0f, 1.0f, 1.0f);
     }
 
     // Overlay
-    if (overlayTexture != 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, overlayTexture);
-        shader.setInt("uUseTexture", 1);
-        shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-        glBindVertexArray(overlayVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+    if (sprites.overlay.texture != 0) {
+        float margin = 20.0f;
+        float overlayWidth = 200.0f;
+        float overlayHeight = 80.0f;
+        float y1 = screenHeight - margin;
+        batch.addQuad(LAYER_OVERLAY, sprites.overlay, margin, y1 - overlayHeight, margin + overlayWidth, y1,
+                      1.0f, 1.0f, 1.0f);
     }
+}
 
-    glBindVertexArray(0);
+void Renderer::renderStaticLayer(const SceneSprites& sprites, const std::vector<Floor>& floors, float corridorLeftX) {
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    GLfloat clearColor[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFramebuffer);
+    glViewport(0, 0, screenWidth, screenHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+	// colors blend as on screen, alpha stays 1 so the composite quad is opaque
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    batch.begin();
+    addStaticLayers(sprites, floors, corridorLeftX);
+    batch.flush();
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+	// the window may have been resized since startup
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    staticDirty = false;
+}
 
-    // Cursor
-    float cursorSize = 48.0f;
-    float x0c = mouseX - cursorSize * 0.5f;
-    float x1c = mouseX + cursorSize * 0.5f;
-    float y0c = mouseY - cursorSize * 0.5f;
-    float y1c = mouseY + cursorSize * 0.5f;
+void Renderer::setupStaticLayer() {
+    glGenTextures(1, &staticTexture);
+    glBindTexture(GL_TEXTURE_2D, staticTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, screenWidth, screenHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	// drawn 1:1 over the screen
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGenFramebuffers(1, &staticFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, staticTexture, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+
+    if (!complete) {
+		// no cache, the static layers go through the batch every frame
+        std::cout << "Static layer framebuffer incomplete, drawing it every frame" << std::endl;
+        glDeleteFramebuffers(1, &staticFramebuffer);
+        glDeleteTextures(1, &staticTexture);
+        staticFramebuffer = 0;
+        staticTexture = 0;
+    }
+    staticDirty = true;
+}
 
-    cursorVertices[0] = { x0c, y0c, 0.0f, 0.0f };
-    cursorVertices[1] = { x1c, y0c, 1.0f, 0.0f };
-    cursorVertices[2] = { x1c, y1c, 1.0f, 1.0f };
-    cursorVertices[3] = { x0c, y1c, 0.0f, 1.0f };
+void Renderer::setupHallButtonGeometry(const std::vector<Floor>& floors, float corridorLeftX) {
+	// an up and a down arrow per floor on the corridor wall, triangle 2f is up
+	// and 2f+1 down; the bottom floor has no down and the top no up button, their
+	// triangles are left degenerate so the indices stay regular
+    float scale = (minFloorSpacing < 32.0f) ? minFloorSpacing / 32.0f : 1.0f;
+    float halfWidth = 6.0f * scale;
+    float height = 8.0f * scale;
+    float gap = 2.0f * scale;
+    float cx = corridorLeftX + 20.0f;
+
+    hallVertices.clear();
+    hallVertices.reserve(floors.size() * 6);
+    for (size_t f = 0; f < floors.size(); ++f) {
+        float cy = 0.5f * (floors[f].yBottom + floors[f].yTop);
+        float upBase = cy + gap;
+        float downBase = cy - gap;
+
+        if (f + 1 < floors.size()) {
+            hallVertices.push_back({ cx - halfWidth, upBase, 0.0f, 0.0f });
+            hallVertices.push_back({ cx + halfWidth, upBase, 1.0f, 0.0f });
+            hallVertices.push_back({ cx, upBase + height, 0.5f, 1.0f });
+        }
+        else {
+            for (int i = 0; i < 3; ++i) hallVertices.push_back({ cx, cy, 0.0f, 0.0f });
+        }
 
-    glBindBuffer(GL_ARRAY_BUFFER, cursorVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(cursorVertices), cursorVertices);
+        if (f > 0) {
+            hallVertices.push_back({ cx - halfWidth, downBase, 0.0f, 1.0f });
+            hallVertices.push_back({ cx, downBase - height, 0.5f, 0.0f });
+            hallVertices.push_back({ cx + halfWidth, downBase, 1.0f, 1.0f });
+        }
+        else {
+            for (int i = 0; i < 3; ++i) hallVertices.push_back({ cx, cy, 0.0f, 0.0f });
+        }
+    }
+}
 
-    glBindVertexArray(cursorVAO);
-    shader.use();
-    unsigned int tex = ventilationOn ? cursorFanTexturePink : cursorFanTexture;
-    shader.setInt("uUseTexture", 1);
-    shader.setVec4("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-    glBindVertexArray(0);
+void Renderer::setupLandingGeometry(const std::vector<Floor>& floors, const std::vector<Elevator>& elevators) {
+    bool zoned = false;
+    for (size_t i = 0; i < servedFloors.size() && !zoned; ++i) {
+        for (size_t f = 0; f < floors.size() && f < (size_t)FloorMask::MAX_FLOORS; ++f) {
+            if (!servedFloors[i].test((int)f)) zoned = true;
+        }
+    }
+    landingRects.clear();
+    if (!zoned) return;
+
+	// a sill across the doorway at every floor the car stops at
+    float thickness = (minFloorSpacing < 32.0f) ? 3.0f * minFloorSpacing / 32.0f : 3.0f;
+    for (int i = 0; i < carCount && i < (int)servedFloors.size(); ++i) {
+        const Elevator& elevator = elevators[i];
+        for (size_t f = 0; f < floors.size() && f < (size_t)FloorMask::MAX_FLOORS; ++f) {
+            if (!servedFloors[i].test((int)f)) continue;
+            landingRects.push_back({ elevator.x, floors[f].yTop, elevator.x + elevator.width, floors[f].yTop + thickness });
+        }
+    }
 }
 
+void Renderer::addHallButtons(const FloorMask& hallUp, const FloorMask& hallDown) {
+	// lit when a call is registered, dark otherwise
+    int limit = floorCount < FloorMask::MAX_FLOORS ? floorCount : FloorMask::MAX_FLOORS;
+    for (int f = 0; f < floorCount; ++f) {
+        for (int way = 0; way < 2; ++way) {
+            bool exists = (way == 0) ? (f + 1 < floorCount) : (f > 0);
+            if (!exists) continue;
+            bool lit = f < limit && ((way == 0) ? hallUp.test(f) : hallDown.test(f));
+            const Vertex* v = &hallVertices[(size_t)f * 6 + way * 3];
+            if (lit) batch.addTriangle(LAYER_HALL_BUTTONS, v[0].x, v[0].y, v[1].x, v[1].y, v[2].x, v[2].y, 1.0f, 0.8f, 0.2f);
+            else batch.addTriangle(LAYER_HALL_BUTTONS, v[0].x, v[0].y, v[1].x, v[1].y, v[2].x, v[2].y, 0.35f, 0.35f, 0.38f);
+        }
+    }
+}
+
+void Renderer::addHistogramChart(const LatencyHistogram& histogram,
+                                 float x0, float y0, float width, float height,
+                                 float r, float g, float b) {
+    batch.addQuad(LAYER_STATS_BACK, 0, x0, y0, x0 + width, y0 + height, 0.05f, 0.05f, 0.08f, 0.75f);
+
+	// linear time axis up to a bit past p99, the last bar takes everything beyond
+    double range = histogram.percentile(99.0) * 1.25;
+    if (range < 1.0) range = 1.0;
+    double binSeconds = range / STATS_BINS;
+
+    long long bins[STATS_BINS];
+    long long tallest = 0;
+    for (int i = 0; i < STATS_BINS; ++i) {
+        double to = (i + 1 < STATS_BINS) ? (i + 1) * binSeconds : 1e9;
+        bins[i] = histogram.countBetween(i * binSeconds, to);
+        if (bins[i] > tallest) tallest = bins[i];
+    }
+
+    float pad = 6.0f;
+    float barWidth = (width - 2.0f * pad) / STATS_BINS;
+    float barMaxHeight = height - 2.0f * pad;
+    for (int i = 0; i < STATS_BINS; ++i) {
+        if (bins[i] == 0) continue;
+        float bx = x0 + pad + i * barWidth;
+        float bh = barMaxHeight * (float)bins[i] / (float)tallest;
+        batch.addQuad(LAYER_STATS_BARS, 0, bx + 1.0f, y0 + pad, bx + barWidth - 1.0f, y0 + pad + bh, r, g, b);
+    }
+
+	// p50, p95, p99 and max as vertical lines
+    static const float markColors[4][3] = {
+        { 0.3f, 0.9f, 0.3f },   // p50
+        { 0.95f, 0.9f, 0.3f },  // p95
+        { 0.95f, 0.55f, 0.2f }, // p99
+        { 0.95f, 0.25f, 0.25f } // max
+    };
+    double marks[4] = { histogram.percentile(50.0), histogram.percentile(95.0),
+                        histogram.percentile(99.0), histogram.getMax() };
+    int markCount = (histogram.getCount() > 0) ? 4 : 0;
+    for (int i = 0; i < markCount; ++i) {
+        float t = (float)(marks[i] / range);
+        if (t > 1.0f) t = 1.0f;
+        float mx = x0 + pad + t * (width - 2.0f * pad);
+        batch.addQuad(LAYER_STATS_MARKS, 0, mx - 1.0f, y0 + 2.0f, mx + 1.0f, y0 + height - 2.0f,
+                      markColors[i][0], markColors[i][1], markColors[i][2]);
+    }
+}
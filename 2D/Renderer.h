@@ -3,91 +3,120 @@
 #include <GL/glew.h>
 #include "Types.h"
 #include "Constants.h"
+#include "CallRegistry.h"
+#include "SpriteBatch.h"
+#include "PanelRenderer.h"
 #include <vector>
 
 // Forward declarations
 struct Elevator;
 struct Person;
 struct Button;
+struct PassengerStats;
+class LatencyHistogram;
 class Shader;
 
-// Rendering system for the elevator simulation
+// Atlas regions of the images in the scene. A region without texture draws
+// as a plain colored quad, or not at all for labels, icons and the overlay.
+struct SceneSprites {
+	AtlasRegion plain;  // white texel the plain quads sample, keeps them in the atlas page's draw
+    AtlasRegion building, elevator, door, person, personLeft, overlay, cursorFan, cursorFanPink;
+    AtlasRegion openButton, closeButton, stopButton, ventButton;
+	std::vector<AtlasRegion> floorLabels;  // per floor
+};
+
+// Rendering system for the elevator simulation. Every frame goes through one
+// SpriteBatch: renderAll adds the quads of the scene layer by layer and the
+// batch draws them with a few calls; the button panel is one instanced draw
+// in between (PanelRenderer). What never moves (background, building,
+// shafts, floors, side floor labels, name overlay) is drawn once into an
+// offscreen texture and put on screen as one quad under the rest.
 class Renderer {
 public:
     Renderer(int screenWidth, int screenHeight);
     ~Renderer();
 
     // Initialize all rendering resources
-    void initialize(const Floor floors[FLOOR_COUNT], float corridorLeftX, float corridorRightX,
-                   const Elevator& elevator, float buildingBottomY, float buildingTopY);
+	// servedFloors: floors each car stops at (zoning), marked at the shafts and on the panel
+    void initialize(const std::vector<Floor>& floors, float corridorLeftX, float corridorRightX,
+                   const std::vector<Elevator>& elevators, const std::vector<FloorMask>& servedFloors,
+                   float buildingBottomY, float buildingTopY);
 
-    // Update dynamic geometry
-    void updateElevatorGeometry(const Elevator& elevator);
-    void updateDoorGeometry(const Elevator& elevator);
-    void updatePersonGeometry(const Person& person);
+    // Update dynamic geometry (cabin and doors of every car, the person)
+	// State drawn between the previous and the current simulation tick (alpha 0 .. 1)
+    void updateElevatorGeometry(const std::vector<Elevator>& previous, const std::vector<Elevator>& current, float alpha);
+    void updatePersonGeometry(const Person& previous, const Person& current, float alpha);
 
     // Render functions
+	// panelShader: panel.vert/panel.frag, draws the buttons
     void renderAll(Shader& shader, 
-                   unsigned int buildingTexture,
-                   unsigned int elevatorTexture,
-                   unsigned int doorTexture,
-                   unsigned int personTexture,
-                   unsigned int personTextureLeft,
-                   unsigned int overlayTexture,
-                   unsigned int cursorFanTexture,
-                   unsigned int cursorFanTexturePink,
-                   const Floor floors[FLOOR_COUNT],
-                   const Elevator& elevator,
+                   Shader& panelShader,
+                   const SceneSprites& sprites,
+                   const std::vector<Floor>& floors,
+                   const std::vector<Elevator>& elevators,
                    const Person& person,
                    const std::vector<Button>& buttons,
-                   unsigned int floorLabelTextures[FLOOR_COUNT],
-                   unsigned int openBtnTex,
-                   unsigned int closeBtnTex,
-                   unsigned int stopBtnTex,
-                   unsigned int ventBtnTex,
-                   int floorButtonIndex[FLOOR_COUNT],
-                   int openButtonIndex,
-                   int closeButtonIndex,
-                   int stopButtonIndex,
-                   int ventilationButtonIndex,
                    float mouseX, float mouseY,
                    float corridorLeftX,
-                   bool ventilationOn);
+                   bool ventilationOn,
+                   const FloorMask& hallUp,
+                   const FloorMask& hallDown,
+                   int panelCar,
+                   const PassengerStats* statsOverlay = nullptr);
+
+    // Draw the cached static layers again next frame (after anything they show
+    // changes, or the window was resized)
+    void invalidateStaticLayer() { staticDirty = true; }
+
+    // Quads and draw calls of the sprite batch in the last frame (the panel is one more draw)
+    int getSpriteCount() const { return batch.getQuadCount(); }
+    int getDrawCount() const { return batch.getDrawCount(); }
 
 private:
+    struct Rect {
+        float x0, y0, x1, y1;
+    };
+
     int screenWidth;
     int screenHeight;
+    int carCount;
+    int floorCount;
+	float minFloorSpacing;  // smallest gap between neighbouring floors, limits the side labels
+
+    SpriteBatch batch;
+    PanelRenderer panel;
+	// reused between frames
+    std::vector<AtlasRegion> panelIcons;
+    std::vector<bool> panelServed;
+
+	// static layers, 0 if the framebuffer isn't supported (then drawn every frame)
+    unsigned int staticFramebuffer;
+    unsigned int staticTexture;
+    bool staticDirty;
+
+	// geometry fixed at initialize
+    std::vector<Rect> floorRects;
+    std::vector<Rect> shaftRects;
+	std::vector<Rect> landingRects;  // sills where zoned cars stop, empty without zoning
+	std::vector<Vertex> hallVertices; // up/down hall buttons, triangle 2f is up and 2f+1 down
+	std::vector<FloorMask> servedFloors;
 
-    // VAOs, VBOs, EBOs
-    unsigned int VAO, VBO, EBO;
-    unsigned int overlayVAO, overlayVBO, overlayEBO;
-    unsigned int floorsVAO, floorsVBO, floorsEBO;
-    unsigned int elevatorVAO, elevatorVBO, elevatorEBO;
-    unsigned int doorVAO, doorVBO, doorEBO;
-    unsigned int shaftVAO, shaftVBO, shaftEBO;
-    unsigned int personVAO, personVBO, personEBO;
-    unsigned int buttonVAO, buttonVBO, buttonEBO;
-    unsigned int labelVAO, labelVBO, labelEBO;
-    unsigned int cursorVAO, cursorVBO, cursorEBO;
-
-    // Geometry data
-    Vertex elevatorVertices[4];
-    Vertex doorVertices[8];
-    Vertex personVertices[4];
-    Vertex buttonVertices[4];
-    Vertex labelVertices[4];
-    Vertex cursorVertices[4];
+	// cars and person as drawn this frame (interpolated between ticks)
+    std::vector<Elevator> drawnElevators;
+    Person drawnPerson;
 
     // Helper functions
-    void setupBackgroundGeometry();
-    void setupOverlayGeometry();
-    void setupFloorsGeometry(const Floor floors[FLOOR_COUNT], float corridorLeftX, float corridorRightX);
-    void setupElevatorGeometry(const Elevator& elevator);
-    void setupDoorGeometry();
-    void setupShaftGeometry(const Elevator& elevator, float buildingBottomY, float buildingTopY);
-    void setupPersonGeometry(const Person& person);
-    void setupButtonGeometry();
-    void setupLabelGeometry();
-    void setupCursorGeometry();
+    void setupFloorsGeometry(const std::vector<Floor>& floors, float corridorLeftX, float corridorRightX);
+    void setupShaftGeometry(const std::vector<Elevator>& elevators, float buildingBottomY, float buildingTopY);
+    void setupHallButtonGeometry(const std::vector<Floor>& floors, float corridorLeftX);
+    void setupLandingGeometry(const std::vector<Floor>& floors, const std::vector<Elevator>& elevators);
+    void setupStaticLayer();
+    void addStaticLayers(const SceneSprites& sprites, const std::vector<Floor>& floors, float corridorLeftX);
+    void renderStaticLayer(const SceneSprites& sprites, const std::vector<Floor>& floors, float corridorLeftX);
+    void addPerson(const AtlasRegion& personRight, const AtlasRegion& personLeft, int layer);
+    void addHallButtons(const FloorMask& hallUp, const FloorMask& hallDown);
+    void addHistogramChart(const LatencyHistogram& histogram,
+                           float x0, float y0, float width, float height,
+                           float r, float g, float b);
 };
 
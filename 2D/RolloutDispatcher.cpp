@@ -0,0 +1,127 @@
+#include "RolloutDispatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// Same slack as the event kernel: land a hair past a transition, never short of it
+static const float TRANSITION_SLACK = 1e-5f;
+// Transitions a car may go through within one rollout
+static const int MAX_ROLLOUT_EVENTS = 256;
+
+RolloutDispatcher::RolloutDispatcher(float horizon, int candidates, int threadCount)
+    : horizon(horizon), candidateCount(candidates < 1 ? 1 : candidates), passengers(nullptr), decisions(0),
+      decisionSeconds(0.0) {
+    if (threadCount > 1) pool.reset(new ThreadPool(threadCount));
+}
+
+float RolloutDispatcher::rollOut(BankSnapshot& world, const std::vector<Floor>& floors,
+                                 const std::vector<int>& noFloorButtons, float horizon) {
+    bool noVentilation = false;
+    std::vector<Button> noButtons;
+    float cost = 0.0f;
+
+	// without new calls the cars don't affect each other, so each runs on its own
+	// clock; the waiting counts are shared and left as they are
+    float weight[BankSnapshot::MAX_FLOORS];
+    for (int c = 0; c < world.carCount; ++c) {
+        ElevatorController& car = world.cars[c];
+        uint16_t* riding = world.riding[c];
+        car.setVerbose(false);
+        const CallRegistry& calls = car.getCalls();
+        FloorMask pending = calls.stops();
+        for (int f = pending.lowestFrom(0); f >= 0; f = pending.lowestFrom(f + 1)) {
+            int people = riding[f];
+            if (calls.getHallUp().test(f)) people += world.waitingUp[f];
+            if (calls.getHallDown().test(f)) people += world.waitingDown[f];
+            weight[f] = (float)std::max(people, 1);
+        }
+
+        float t = 0.0f;
+        unsigned int doorCycle = car.getDoorCycle();
+        for (int step = 0; step < MAX_ROLLOUT_EVENTS && pending.any(); ++step) {
+            float dt = car.timeToNextTransition(floors);
+            if (std::isinf(dt) || t + dt > horizon) break;
+            if (dt < 0.0f) dt = 0.0f;
+            car.update(dt + TRANSITION_SLACK, floors, noVentilation, noFloorButtons, noButtons, -1);
+            t += dt;
+
+            if (car.getDoorCycle() != doorCycle) {
+				// doors just opened: riders for this floor get off, people waiting
+				// the car's way get on while there is room (their floors are unknown)
+                doorCycle = car.getDoorCycle();
+                int floorIndex = car.getElevator().currentFloor;
+                int alighting = riding[floorIndex];
+                riding[floorIndex] = 0;
+                CallDirection leaving = car.leavingDirection();
+                int waitingHere = (leaving != CallDirection::Down ? world.waitingUp[floorIndex] : 0) +
+                                  (leaving != CallDirection::Up ? world.waitingDown[floorIndex] : 0);
+                int boarding = (int)std::min<long long>(waitingHere, (long long)car.getFreeSpace() + alighting);
+                if (alighting > 0 || boarding > 0) car.transferPassengers(alighting, boarding);
+            }
+
+            for (int f = pending.lowestFrom(0); f >= 0; f = pending.lowestFrom(f + 1)) {
+                if (!car.isFloorRequested(f)) {
+                    cost += t * weight[f];
+                    pending.reset(f);
+                }
+            }
+        }
+        for (int f = pending.lowestFrom(0); f >= 0; f = pending.lowestFrom(f + 1)) {
+            cost += horizon * weight[f];
+        }
+    }
+    return cost;
+}
+
+int RolloutDispatcher::assignHallCall(const ElevatorBank& bank, int floorIndex, CallDirection direction, int legFloor) {
+    if (!bank.saveState(base)) {
+        EtaDispatcher eta;
+        return eta.assignHallCall(bank, floorIndex, direction, legFloor);
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (passengers) passengers->countPassengers(base);
+
+	// candidates: the cars with the lowest ETA
+    int carCount = bank.getCarCount();
+    etas.resize(carCount);
+    candidates.resize(carCount);
+    for (int i = 0; i < carCount; ++i) {
+        etas[i] = EtaDispatcher::estimateArrivalTime(bank.getCar(i), bank.getFloors(), floorIndex, direction);
+        if (legFloor >= 0 && !bank.getCar(i).controller.servesFloor(legFloor)) etas[i] = std::numeric_limits<float>::infinity();
+        candidates[i] = i;
+    }
+    int k = std::min(candidateCount, carCount);
+    std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(),
+                      [this](int a, int b) { return etas[a] < etas[b] || (etas[a] == etas[b] && a < b); });
+    while (k > 1 && std::isinf(etas[candidates[k - 1]])) --k; // cars that don't stop at the floors
+
+    forks.resize(k);
+    costs.assign(k, 0.0f);
+    noFloorButtons.assign(bank.getFloorCount(), -1);
+    const std::vector<Floor>& floors = bank.getFloors();
+
+    for (int i = 0; i < k; ++i) {
+        BankSnapshot* fork = &forks[i];
+        float* cost = &costs[i];
+        int car = candidates[i];
+        auto job = [this, fork, cost, car, floorIndex, direction, &floors] {
+            *fork = base;
+            fork->cars[car].requestHallCall(floorIndex, direction);
+            *cost = rollOut(*fork, floors, noFloorButtons, horizon);
+        };
+        if (pool) pool->submit(job);
+        else job();
+    }
+    if (pool) pool->wait();
+
+	// ties go to the better ETA (candidates are in ETA order)
+    int best = 0;
+    for (int i = 1; i < k; ++i) {
+        if (costs[i] < costs[best]) best = i;
+    }
+
+    ++decisions;
+    decisionSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return candidates[best];
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ElevatorBank.h"
+#include "PassengerPopulation.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <vector>
+
+// Decides a hall call by trying it: the `candidates` cars with the best ETA
+// each get a fork of the bank (a memcpy of BankSnapshot) with the call given to
+// that car, every fork runs `horizon` seconds ahead on the worker threads, and
+// the car whose fork costs the fewest passenger-seconds wins. With passengers
+// set, the forks know who waits and rides where: a stop weighs as many people
+// as it serves, and the cars fill up and dwell as they would.
+class RolloutDispatcher : public Dispatcher {
+public:
+	// threadCount <= 1: forks run on the calling thread (e.g. inside a replica job)
+    RolloutDispatcher(float horizon = 20.0f, int candidates = 4, int threadCount = 1);
+
+    int assignHallCall(const ElevatorBank& bank, int floorIndex, CallDirection direction, int legFloor) override;
+
+	// Passengers to count into every snapshot (nullptr: every stop weighs one person)
+    void setPassengers(const PassengerPopulation* population) { passengers = population; }
+
+    long long getDecisionCount() const { return decisions; }
+	double getDecisionSeconds() const { return decisionSeconds; }  // wall time of all decisions
+
+	// Seconds until each stop pending in `world` is served within `horizon` (stops
+	// still pending at the horizon count as horizon), times the passengers
+	// getting on or off there (at least one), summed over every car
+    static float rollOut(BankSnapshot& world, const std::vector<Floor>& floors,
+                         const std::vector<int>& noFloorButtons, float horizon);
+
+private:
+    float horizon;
+    int candidateCount;
+	std::unique_ptr<ThreadPool> pool;  // nullptr: run on the calling thread
+    const PassengerPopulation* passengers;
+
+	// reused between decisions, every job writes only its own fork and cost
+    BankSnapshot base;
+    std::vector<BankSnapshot> forks;
+    std::vector<float> costs;
+    std::vector<int> candidates;
+    std::vector<float> etas;
+    std::vector<int> noFloorButtons;
+
+    long long decisions;
+    double decisionSeconds;
+};
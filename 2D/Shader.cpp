@@ -74,4 +74,36 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    reflectUniforms();
+}
+
+void Shader::reflectUniforms() {
+    uniforms.clear();
+    GLint count = 0, maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    if (count <= 0 || maxNameLength <= 0) return;
+
+    std::vector<GLchar> nameBuffer(maxNameLength);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        Uniform uniform;
+        glGetActiveUniform(ID, (GLuint)i, maxNameLength, &length, &uniform.size, &uniform.type, nameBuffer.data());
+        uniform.name.assign(nameBuffer.data(), length);
+        if (uniform.name.size() > 3 && uniform.name.compare(uniform.name.size() - 3, 3, "[0]") == 0) {
+            uniform.name.resize(uniform.name.size() - 3);
+        }
+		// uniforms in blocks have no location
+        uniform.location = glGetUniformLocation(ID, nameBuffer.data());
+        if (uniform.location < 0) continue;
+        uniforms.push_back(uniform);
+    }
+}
+
+UniformHandle Shader::getUniform(const char* name) const {
+    for (size_t i = 0; i < uniforms.size(); ++i) {
+        if (uniforms[i].name == name) return UniformHandle{ (int)i };
+    }
+    return UniformHandle{ -1 };
 }
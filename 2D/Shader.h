@@ -1,8 +1,15 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <GL/glew.h>
 
+// Slot of an active uniform in the shader's table; slot -1 (a name the
+// program doesn't use) makes the setters do nothing, like location -1 in GL
+struct UniformHandle {
+    int slot;
+};
+
 class Shader {
 public:
     GLuint ID;
@@ -13,20 +20,46 @@ public:
         glUseProgram(ID);
     }
 
-    // Uniform helper-i
-    void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    // Look a uniform up once (by name, arrays without "[0]") and keep the handle
+    UniformHandle getUniform(const char* name) const;
+
+    // Uniform helper-i: with a handle a set is an array index and the GL call
+    void setInt(UniformHandle uniform, int value) const {
+        if (uniform.slot >= 0) glUniform1i(uniforms[uniform.slot].location, value);
+    }
+
+    void setFloat(UniformHandle uniform, float value) const {
+        if (uniform.slot >= 0) glUniform1f(uniforms[uniform.slot].location, value);
     }
 
-    void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    void setVec2(UniformHandle uniform, float x, float y) const {
+        if (uniform.slot >= 0) glUniform2f(uniforms[uniform.slot].location, x, y);
     }
 
-    void setVec4(const std::string& name, float x, float y, float z, float w) const {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    void setVec4(UniformHandle uniform, float x, float y, float z, float w) const {
+        if (uniform.slot >= 0) glUniform4f(uniforms[uniform.slot].location, x, y, z, w);
     }
 
-    void setMat4(const std::string& name, const float* value) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value);
+    void setMat4(UniformHandle uniform, const float* value) const {
+        if (uniform.slot >= 0) glUniformMatrix4fv(uniforms[uniform.slot].location, 1, GL_FALSE, value);
     }
+
+	// by name, for one-off setup (a search of the table, no driver lookup)
+    void setInt(const char* name, int value) const { setInt(getUniform(name), value); }
+    void setFloat(const char* name, float value) const { setFloat(getUniform(name), value); }
+    void setVec2(const char* name, float x, float y) const { setVec2(getUniform(name), x, y); }
+    void setVec4(const char* name, float x, float y, float z, float w) const { setVec4(getUniform(name), x, y, z, w); }
+    void setMat4(const char* name, const float* value) const { setMat4(getUniform(name), value); }
+
+private:
+	// active uniforms of the linked program (glGetActiveUniform)
+    struct Uniform {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size;  // array length, 1 for plain uniforms
+    };
+    std::vector<Uniform> uniforms;
+
+    void reflectUniforms();
 };
@@ -0,0 +1,308 @@
+// Headless fast-forward runner: same ElevatorController logic as the app,
+// no window. Fixed timestep by default, --events uses the discrete-event kernel.
+// Reports simulated seconds per wall-clock second.
+//
+// Usage: SimRunner [--building FILE] [--days D] [--dt S] [--seed N] [--cars N] [--look] [--events]
+//                  [--calls-per-hour R] [--script FILE] [--replicas N] [--threads T]
+//                  [--rollout K] [--horizon S] [--batch E] [--profile NAME] [--trace FILE]
+//                  [--destination S]
+//        SimRunner --convert-trace CSV TRACE
+//
+// The building comes from --building, else from building.cfg if present, else
+// the built-in defaults; --cars overrides its car count. Zones in the config
+// (see BuildingConfig.h) restrict car groups to floor ranges; passengers whose
+// trip no single car serves change cars at a sky lobby.
+//
+// Wait is hall call -> boarding, trip is boarding -> alighting; both are kept
+// in log-linear histograms (Statistics.h), merged across replicas.
+//
+// --replicas runs a Monte Carlo study: N independent replicas with seeds
+// seed .. seed + N - 1 on T threads (default: all cores), merged at the end.
+//
+// --rollout assigns hall calls with the RolloutDispatcher: the K cars with the
+// best ETA are each tried in a fork of the bank rolled S seconds ahead (default
+// 20). The forks run on T threads when there is one replica, inline otherwise.
+//
+// --destination switches generated passengers to destination dispatch: they
+// key in their floor at the hall, and every S seconds (the batching window,
+// e.g. 1.5) the DestinationDispatcher assigns the batch to cars, grouping
+// passengers who share stops.
+//
+// --batch steps E buildings at once through EnvBatch (the training interface)
+// with a nearest-car policy read from the observations, and reports env steps
+// per second instead of the usual statistics.
+//
+// --profile draws passengers (origin and destination) from a traffic profile
+// (TrafficGenerator.h: up-peak, down-peak, lunch, interfloor, day) instead of
+// uniform hall calls; --calls-per-hour is then its peak rate. Arrivals are
+// generated lazily in chunks, so long runs on tall buildings stay small.
+//
+// --trace replays recorded hall calls from a binary trace (TraceFile.h),
+// streamed from a memory mapping; without --days the run lasts as long as the
+// trace. --convert-trace writes such a trace from a CSV log and exits.
+//
+// Script file: see loadScript() in TrafficStudy.h.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "BuildingConfig.h"
+#include "ThreadPool.h"
+#include "TrafficStudy.h"
+#include "EnvBatch.h"
+
+// "<name> p50/95/99/max: ..." from a histogram
+static void printPercentiles(const char* name, const LatencyHistogram& histogram) {
+    std::string label = std::string(name) + " p50/95/99/max:";
+    label.resize(21, ' ');
+    std::cout << label << histogram.percentile(50) << " / " << histogram.percentile(95) << " / "
+              << histogram.percentile(99) << " / " << histogram.getMax() << " s" << std::endl;
+}
+
+// Batched environments for `duration` simulated seconds each, nearest car takes every call
+static int runBatch(const BuildingConfig& building, int envCount, double duration, unsigned seed,
+                    double callsPerHour) {
+    EnvSettings envSettings;
+    envSettings.callsPerHour = callsPerHour;
+    EnvBatch batch(envCount, building, envSettings);
+
+    int size = batch.getObservationSize();
+    int cars = batch.getCarCount();
+    int floors = batch.getFloorCount();
+    std::vector<float> observations((size_t)envCount * size);
+    std::vector<float> rewards(envCount);
+    std::vector<int> actions(envCount);
+    std::vector<unsigned> seeds(envCount);
+    for (int e = 0; e < envCount; ++e) seeds[e] = seed + (unsigned)e;
+
+    std::vector<float> floorPosition(floors);
+    for (int f = 0; f < floors; ++f) {
+        floorPosition[f] = building.getFloorElevation(f) / building.getBuildingHeight();
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+    batch.reset(seeds.data(), observations.data());
+
+    long long steps = (long long)(duration / envSettings.stepSeconds);
+    double waited = 0.0;
+    for (long long s = 0; s < steps; ++s) {
+        for (int e = 0; e < envCount; ++e) {
+            const float* o = &observations[(size_t)e * size];
+            const float* pending = o + 5 * cars + floors;
+            actions[e] = -1;
+            for (int f = 0; f < floors; ++f) {
+                if (pending[f] == 0.0f) continue;
+                float best = 0.0f;
+                for (int c = 0; c < cars; ++c) {
+                    float d = std::fabs(o[c] - floorPosition[f]);
+                    if (actions[e] < 0 || d < best) {
+                        actions[e] = c;
+                        best = d;
+                    }
+                }
+            }
+        }
+        batch.step(actions.data(), observations.data(), rewards.data());
+        for (int e = 0; e < envCount; ++e) waited -= rewards[e];
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    long long envSteps = steps * envCount;
+    std::cout << "Environments:        " << envCount << " (" << floors << " floors, " << cars << " cars)" << std::endl;
+    std::cout << "Env steps:           " << envSteps << " of " << envSettings.stepSeconds << " s" << std::endl;
+    std::cout << "Passengers:          " << batch.getArrivedCount() << " (" << batch.getDeliveredCount() << " delivered)" << std::endl;
+    if (batch.getArrivedCount() > 0) {
+        std::cout << "Mean wait:           " << waited / batch.getArrivedCount() << " s" << std::endl;
+    }
+    std::cout << "Wall time:           " << wallSeconds << " s" << std::endl;
+    std::cout << "Throughput:          " << (wallSeconds > 0.0 ? envSteps / wallSeconds : 0.0) << " env steps / wall-s" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    double days = 0.0; // 1 day, or the length of the trace
+    unsigned int seed = 1;
+    const char* buildingPath = nullptr;
+    int carCount = 0; // from the building config
+    const char* scriptPath = nullptr;
+    int replicas = 1;
+    int threads = 0;  // all cores
+    int batch = 0;    // EnvBatch benchmark with that many environments
+    const char* profileName = nullptr;
+    const char* tracePath = nullptr;
+    ReplicaSettings settings;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = (i + 1 < argc);
+        if (std::strcmp(argv[i], "--building") == 0 && hasValue) buildingPath = argv[++i];
+        else if (std::strcmp(argv[i], "--days") == 0 && hasValue) days = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--dt") == 0 && hasValue) settings.dt = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) seed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--cars") == 0 && hasValue) carCount = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--look") == 0) settings.scheduling = SchedulingMode::Look;
+        else if (std::strcmp(argv[i], "--events") == 0) settings.eventDriven = true;
+        else if (std::strcmp(argv[i], "--calls-per-hour") == 0 && hasValue) settings.callsPerHour = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--script") == 0 && hasValue) scriptPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replicas") == 0 && hasValue) replicas = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--rollout") == 0 && hasValue) settings.rolloutCandidates = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--horizon") == 0 && hasValue) settings.rolloutHorizon = (float)std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--batch") == 0 && hasValue) batch = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--profile") == 0 && hasValue) profileName = argv[++i];
+        else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) tracePath = argv[++i];
+        else if (std::strcmp(argv[i], "--destination") == 0 && hasValue) settings.destinationWindow = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--convert-trace") == 0 && i + 2 < argc) {
+            if (!convertTraceCsv(argv[i + 1], argv[i + 2])) return 1;
+            TraceReader reader;
+            if (!reader.open(argv[i + 2])) return 1;
+            std::cout << "Trace:               " << reader.getEventCount() << " events, " << reader.getFloorCount()
+                      << " floors, " << reader.getDuration() << " s" << std::endl;
+            return 0;
+        }
+        else {
+            std::cerr << "Usage: SimRunner [--building FILE] [--days D] [--dt S] [--seed N] [--cars N] [--look] [--events]"
+                      << " [--calls-per-hour R] [--script FILE] [--replicas N] [--threads T]"
+                      << " [--rollout K] [--horizon S] [--batch E] [--profile NAME] [--trace FILE]"
+                      << " [--destination S]" << std::endl;
+            std::cerr << "       SimRunner --convert-trace CSV TRACE" << std::endl;
+            return 1;
+        }
+    }
+    if (days < 0.0 || settings.dt <= 0.0 || settings.callsPerHour <= 0.0 || carCount < 0 ||
+        replicas < 1 || threads < 0 || settings.rolloutCandidates < 0 || settings.rolloutHorizon <= 0.0f || batch < 0 ||
+        settings.destinationWindow < 0.0) {
+        std::cerr << "--days, --dt, --cars, --calls-per-hour, --replicas, --threads, --rollout, --horizon, --batch"
+                  << " and --destination must be positive" << std::endl;
+        return 1;
+    }
+    if (settings.destinationWindow > 0.0 && (scriptPath || settings.rolloutCandidates > 0)) {
+        std::cerr << "--destination needs generated passengers and its own dispatcher (no --script or --rollout)" << std::endl;
+        return 1;
+    }
+
+    BuildingConfig& building = settings.building;
+    if (!buildingPath && std::ifstream(BUILDING_CONFIG_FILE)) buildingPath = BUILDING_CONFIG_FILE;
+    if (buildingPath && !loadBuildingConfig(buildingPath, building)) return 1;
+    if (carCount > 0) building.carCount = carCount;
+    int unserved = building.firstUnservedFloor();
+    if (unserved >= 0) {
+        std::cerr << "No car serves floor " << unserved << " (the config's zones need more cars)" << std::endl;
+        return 1;
+    }
+	building.startFloor = building.lobbyFloor; // the day starts with every car at the lobby
+
+    TraceReader trace;
+    if (tracePath) {
+        if (!trace.open(tracePath)) return 1;
+        if (trace.getFloorCount() > building.floorCount) {
+            std::cerr << "Trace has " << trace.getFloorCount() << " floors, the building " << building.floorCount
+                      << "; calls above the top floor are skipped" << std::endl;
+        }
+        settings.trace = tracePath;
+        if (days == 0.0) days = (trace.getDuration() + 1.0) / 86400.0; // the last call is included
+    }
+    if (days == 0.0) days = 1.0;
+
+    settings.duration = days * 24.0 * 3600.0;
+    if (batch > 0) return runBatch(building, batch, settings.duration, seed, settings.callsPerHour);
+
+    std::vector<ScriptedCall> script;
+    if (scriptPath) {
+        if (!loadScript(scriptPath, building.floorCount, script)) return 1;
+        settings.script = &script;
+    }
+
+    TrafficProfile profile;
+    if (profileName) {
+        if (!makeTrafficProfile(profileName, building, settings.callsPerHour, profile)) {
+            std::cerr << "Unknown traffic profile: " << profileName << " (" << TRAFFIC_PROFILE_NAMES << ")" << std::endl;
+            return 1;
+        }
+        settings.profile = &profile;
+    }
+
+    if (threads == 0) threads = ThreadPool::hardwareThreads();
+    settings.rolloutThreads = (replicas == 1) ? threads : 1;
+    if (threads > replicas) threads = replicas;
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    std::vector<ReplicaResult> results;
+    runReplicas(settings, seed, replicas, threads, results);
+    StudySummary summary;
+    mergeResults(results, summary);
+    if (summary.traceCorrupt) {
+        std::cerr << "Trace " << tracePath << " is corrupt or truncated, the replay stopped before its "
+                  << trace.getEventCount() << " events" << std::endl;
+        return 1;
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double throughput = (wallSeconds > 0.0) ? summary.simulated / wallSeconds : 0.0;
+
+    if (replicas > 1) {
+        std::cout << "Replicas:            " << replicas << " (seeds " << seed << " .. " << seed + replicas - 1
+                  << ", " << threads << " threads)" << std::endl;
+    }
+    std::cout << "Simulated time:      " << summary.simulated << " s (" << summary.simulated / 86400.0 << " days)" << std::endl;
+    std::cout << "Floors:              " << building.floorCount << std::endl;
+    std::cout << "Cars:                " << building.carCount << std::endl;
+    for (const CarZone& zone : building.zones) {
+        std::cout << "Zone:                " << zone.carCount << " cars, floors " << zone.lowest << " .. "
+                  << zone.highest << " + lobby, " << (zone.carSpeed > 0.0f ? zone.carSpeed : building.carSpeed)
+                  << " m/s" << std::endl;
+    }
+    std::cout << "Scheduling:          " << (settings.scheduling == SchedulingMode::Look ? "LOOK" : "FIFO") << std::endl;
+    if (tracePath && !settings.script) {
+        std::cout << "Trace:               " << tracePath << " (" << trace.getEventCount() << " events)" << std::endl;
+    }
+    else if (settings.profile && !settings.script) {
+        std::cout << "Traffic profile:     " << profile.name << ", peak " << settings.callsPerHour << " passengers / h" << std::endl;
+    }
+    if (settings.rolloutCandidates > 0) {
+        double perDecision = (summary.decisions > 0) ? summary.decisionSeconds / summary.decisions : 0.0;
+        std::cout << "Dispatcher:          rollout, " << settings.rolloutCandidates << " candidates, "
+                  << settings.rolloutHorizon << " s horizon" << std::endl;
+        std::cout << "Rollout decisions:   " << summary.decisions << " (" << perDecision * 1e6 << " us each)" << std::endl;
+    }
+    if (settings.destinationWindow > 0.0) {
+        double perBatch = (summary.decisions > 0) ? summary.decisionSeconds / summary.decisions : 0.0;
+        std::cout << "Dispatcher:          destination, " << settings.destinationWindow << " s batches" << std::endl;
+        std::cout << "Batch assignments:   " << summary.decisions << " (" << perBatch * 1e6 << " us each)" << std::endl;
+    }
+    if (settings.eventDriven) {
+        std::cout << "Events:              " << summary.events << std::endl;
+    }
+    else {
+        std::cout << "Timestep:            " << settings.dt << " s (" << summary.ticks << " ticks)" << std::endl;
+    }
+    std::cout << "Hall calls:          " << summary.hallCalls << std::endl;
+    std::cout << "Car calls:           " << summary.carCalls << std::endl;
+    std::cout << "Door cycles:         " << summary.doorCycles << std::endl;
+    std::cout << "Car travel:          " << summary.travelFloors << " floors (" << summary.travelKm << " km)" << std::endl;
+    if (summary.passengers > 0) {
+        const LatencyHistogram& wait = summary.stats.waitTime;
+        const LatencyHistogram& trip = summary.stats.tripTime;
+        std::cout << "Passengers:          " << summary.passengers << " (" << summary.delivered << " delivered)" << std::endl;
+        std::cout << "Handling capacity:   " << summary.peakHandling << " passengers / 5 min (busiest window, "
+                  << building.carCapacity << " per car)" << std::endl;
+        if (wait.getCount() > 0) {
+            std::cout << "Mean wait / trip:    " << wait.getMean() << " s / " << trip.getMean() << " s" << std::endl;
+            printPercentiles("Wait", wait);
+            printPercentiles("Trip", trip);
+            if (replicas > 1) {
+                std::cout << "Replica mean wait:   " << summary.minMeanWait << " .. " << summary.maxMeanWait << " s" << std::endl;
+            }
+        }
+    }
+    std::cout << "Wall time:           " << wallSeconds << " s" << std::endl;
+    std::cout << "Throughput:          " << throughput << " sim-s / wall-s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "SimThread.h"
+#include "Constants.h"
+#include "ElevatorBank.h"
+#include "PersonController.h"
+#include "ButtonPanel.h"
+#include <iostream>
+
+SimThread::SimThread(ElevatorBank& bank, PersonController& personController, ButtonPanel& buttonPanel,
+                     const std::vector<Floor>& floors, float corridorLeftX, float lastElevatorX)
+    : bank(bank), personController(personController), buttonPanel(buttonPanel), floors(floors),
+      corridorLeftX(corridorLeftX), lastElevatorX(lastElevatorX),
+      moveLeft(false), moveRight(false), ventilationOn(false), personCar(0),
+      simTime(0.0), callTime(-1.0), boardTime(0.0), running(false) {
+    bank.getElevators(elevators);
+    previousElevators = elevators;
+    previousPerson = personController.getPerson();
+	publish(); // the window thread has a snapshot before the first tick
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&SimThread::run, this);
+}
+
+void SimThread::stop() {
+    running.store(false);
+    if (thread.joinable()) thread.join();
+}
+
+void SimThread::run() {
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SIM_TICK));
+    Clock::duration maxLag = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(MAX_FRAME_TIME));
+
+    Clock::time_point nextTick = Clock::now();
+    while (running.load()) {
+        std::this_thread::sleep_until(nextTick);
+
+        InputEvent event;
+        while (input.pop(event)) {
+            handleInput(event);
+        }
+        tick();
+        publish();
+
+        nextTick += tickDuration;
+        Clock::time_point now = Clock::now();
+        if (now - nextTick > maxLag) nextTick = now; // stalled (debugger, suspend): don't catch up
+    }
+}
+
+void SimThread::handleInput(const InputEvent& event) {
+    ElevatorController& carController = bank.getCar(personCar).controller;
+
+    if (event.type == InputEventType::Click) {
+        if (personController.getPerson().inElevator) {
+            buttonPanel.handleClick(event.x, event.y, true, carController, ventilationOn);
+        }
+        return;
+    }
+
+    switch (event.key) {
+    case InputKey::Left:
+        moveLeft = event.down;
+        break;
+    case InputKey::Right:
+        moveRight = event.down;
+        break;
+    case InputKey::CallUp:
+    case InputKey::CallDown:
+        if (event.down && callTime < 0.0 &&
+            personController.handleElevatorCall(bank, event.key == InputKey::CallUp ? CallDirection::Up
+                                                                                   : CallDirection::Down)) {
+            callTime = simTime;
+        }
+        break;
+    case InputKey::Scheduling:
+        if (event.down) {
+            bool look = (carController.getSchedulingMode() == SchedulingMode::Fifo);
+            carController.setSchedulingMode(look ? SchedulingMode::Look : SchedulingMode::Fifo);
+            std::cout << "Lift " << personCar << ": " << (look ? "LOOK" : "FIFO") << std::endl;
+        }
+        break;
+    }
+}
+
+void SimThread::tick() {
+    previousElevators = elevators;
+    previousPerson = personController.getPerson();
+    float dt = static_cast<float>(SIM_TICK);
+
+    // Outside, the person belongs to the car whose doorway they stand at
+    if (!personController.getPerson().inElevator) {
+        const Person& p = personController.getPerson();
+        int frontCar = bank.carInFrontOf(p.x, p.x + p.width);
+        if (frontCar >= 0) personCar = frontCar;
+    }
+    ElevatorController& carController = bank.getCar(personCar).controller;
+
+    // Update person movement
+    float corridorMaxXOutside = lastElevatorX - personController.getPerson().width;
+    personController.update(dt, moveLeft, moveRight, floors, carController.getElevator(),
+                            corridorLeftX, corridorMaxXOutside);
+
+    // Handle person entering/exiting elevator
+    bool wasInElevator = personController.getPerson().inElevator;
+    personController.handleElevatorInteraction(carController.getElevator(), floors);
+    if (!wasInElevator && personController.getPerson().inElevator) {
+		// the panel now shows this car's requests
+        buttonPanel.syncFloorButtons(carController);
+
+        boardTime = simTime;
+        if (callTime >= 0.0) {
+            personStats.waitTime.record(boardTime - callTime);
+            std::cout << "Cekanje: " << boardTime - callTime << " s" << std::endl;
+            callTime = -1.0;
+        }
+    }
+
+    // Handle exit from elevator (A at the doors)
+    if (personController.getPerson().inElevator &&
+        carController.getElevator().state == ElevatorState::DoorsOpen) {
+        float insideMinX = carController.getElevator().x + 5.0f;
+        if (moveLeft && personController.getPerson().x <= insideMinX + 1.0f) {
+            Person& person = personController.getPerson();
+            person.inElevator = false;
+            int newFloor = carController.getElevator().currentFloor;
+            person.x = carController.getElevator().x - person.width;
+            person.y = floors[newFloor].yTop;
+            personController.setCurrentFloor(newFloor);
+
+            double tripTime = simTime - boardTime;
+            personStats.tripTime.record(tripTime);
+            std::cout << "Voznja: " << tripTime << " s" << std::endl;
+        }
+    }
+
+    // Update elevators (the panel belongs to the car the person is in)
+    int panelCar = personController.getPerson().inElevator ? personCar : -1;
+    bank.update(dt, panelCar, ventilationOn,
+                buttonPanel.getFloorButtonIndices(),
+                buttonPanel.getButtons(),
+                buttonPanel.getVentilationButtonIndex());
+    bank.getElevators(elevators);
+
+    simTime += SIM_TICK;
+}
+
+void SimThread::publish() {
+    SimSnapshot& snapshot = snapshots.writeSlot();
+    snapshot.elevators = elevators;
+    snapshot.previousElevators = previousElevators;
+    snapshot.person = personController.getPerson();
+    snapshot.previousPerson = previousPerson;
+    snapshot.buttons = buttonPanel.getButtons();
+    snapshot.hallUp.clear();
+    snapshot.hallDown.clear();
+    for (int i = 0; i < bank.getCarCount(); ++i) {
+        const CallRegistry& calls = bank.getCar(i).controller.getCalls();
+        snapshot.hallUp = snapshot.hallUp | calls.getHallUp();
+        snapshot.hallDown = snapshot.hallDown | calls.getHallDown();
+    }
+    snapshot.ventilationOn = ventilationOn;
+    snapshot.personCar = personCar;
+    snapshot.simTime = simTime;
+    snapshot.tickTime = std::chrono::steady_clock::now();
+    snapshot.personStats = personStats;
+    snapshots.publish();
+}
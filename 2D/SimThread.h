@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Types.h"
+#include "CallRegistry.h"
+#include "Statistics.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class ElevatorBank;
+class PersonController;
+class ButtonPanel;
+
+// Keys the simulation cares about (the window thread maps GLFW keys to these)
+enum class InputKey {
+	Left,        // A: walk left, step out of the car
+	Right,       // D: walk right
+	CallUp,      // W: hall call, going up
+	CallDown,    // S: hall call, going down
+	Scheduling   // L: FIFO <-> LOOK for the person's car
+};
+
+enum class InputEventType {
+	Key,    // key went down or up
+	Click   // left mouse button pressed
+};
+
+// Input from the window thread, applied by the sim thread before its next tick
+struct InputEvent {
+    InputEventType type;
+    InputKey key;   // Key
+    bool down;      // Key
+	float x, y;     // Click: cursor in GL pixels
+};
+
+// What the renderer needs from one tick. The sim thread fills a free slot and
+// publishes it; the window thread only ever reads published snapshots.
+struct SimSnapshot {
+    std::vector<Elevator> elevators;
+	std::vector<Elevator> previousElevators;  // one tick back, for interpolation
+    Person person;
+    Person previousPerson;
+	std::vector<Button> buttons;               // lit state of the panel
+	FloorMask hallUp;                          // lit hall buttons, any car
+    FloorMask hallDown;
+    bool ventilationOn = false;
+    int personCar = 0;
+    double simTime = 0.0;
+	std::chrono::steady_clock::time_point tickTime;  // when the tick was published
+    PassengerStats personStats;
+};
+
+// Runs the person, the button panel and the elevator bank at SIM_TICK_RATE on
+// its own thread. Input comes in through a lock-free queue and state goes out
+// through a triple buffer, so a slow frame never delays a tick and a tick never
+// blocks a frame. While the thread runs it owns the bank, the person and the panel.
+class SimThread {
+public:
+    SimThread(ElevatorBank& bank, PersonController& personController, ButtonPanel& buttonPanel,
+              const std::vector<Floor>& floors, float corridorLeftX, float lastElevatorX);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    void start();
+    void stop();
+
+	// Window thread: queue input; false if the queue is full and the event was dropped
+    bool post(const InputEvent& event) { return input.push(event); }
+
+	// Window thread: newest published snapshot, valid until the next call
+    const SimSnapshot& latest() {
+        snapshots.acquire();
+        return snapshots.read();
+    }
+
+private:
+    ElevatorBank& bank;
+    PersonController& personController;
+    ButtonPanel& buttonPanel;
+    const std::vector<Floor>& floors;
+    float corridorLeftX;
+    float lastElevatorX;
+
+	// sim thread state
+    std::vector<Elevator> elevators;
+    std::vector<Elevator> previousElevators;
+    Person previousPerson;
+    bool moveLeft;
+    bool moveRight;
+    bool ventilationOn;
+	int personCar;       // car the person is in, or standing in front of
+    double simTime;
+	double callTime;     // hall call still waiting for boarding, or -1
+    double boardTime;
+    PassengerStats personStats;
+
+    SpscQueue<InputEvent, 256> input;
+    TripleBuffer<SimSnapshot> snapshots;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    void run();
+    void handleInput(const InputEvent& event);
+    void tick();
+    void publish();
+};
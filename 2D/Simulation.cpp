@@ -0,0 +1,86 @@
+#include "Simulation.h"
+
+float layoutFloors(std::vector<Floor>& floors, const BuildingConfig& building,
+                   float buildingBottomY, float buildingTopY, float floorThickness) {
+    float buildingHeight = building.getBuildingHeight();
+    float pixelsPerMetre = (buildingTopY - buildingBottomY) / buildingHeight;
+
+	// platforms must not overlap when the floors are packed tightly
+    float minSpacing = building.getMinStoreyHeight() * pixelsPerMetre;
+    if (floorThickness > 0.5f * minSpacing) floorThickness = 0.5f * minSpacing;
+
+    floors.resize(building.floorCount);
+    for (int i = 0; i < building.floorCount; ++i) {
+        float centerY = buildingBottomY + (buildingTopY - buildingBottomY) * (building.getFloorElevation(i) / buildingHeight);
+        floors[i].yBottom = centerY - floorThickness * 0.5f;
+        floors[i].yTop = centerY + floorThickness * 0.5f;
+    }
+    return pixelsPerMetre;
+}
+
+void applyZones(ElevatorBank& bank, const BuildingConfig& building, float pixelsPerMetre) {
+    for (int c = 0; c < bank.getCarCount(); ++c) {
+        ElevatorController& controller = bank.getCar(c).controller;
+        FloorMask served;
+        served.clear();
+        for (int f = 0; f < building.floorCount; ++f) {
+            if (building.servesFloor(c, f)) served.set(f);
+        }
+        controller.setServedFloors(served);
+
+        float speed = building.getCarSpeed(c);
+        if (speed != building.carSpeed) {
+            MotionLimits limits(speed * pixelsPerMetre, building.carAccel * pixelsPerMetre,
+                                building.carJerk * pixelsPerMetre);
+            controller.setMotion(limits, building.doorAnimDuration, building.doorOpenTime);
+        }
+    }
+}
+
+Simulation::Simulation() : ventilationOn(false), pixelsPerMetre(1.0f), simTime(0.0) {
+}
+
+void Simulation::initialize(const BuildingConfig& building) {
+	// same building as the app on a reference screen, so travel times match
+    float buildingBottomY = 100.0f;
+    float buildingTopY = HEADLESS_SCREEN_HEIGHT - 160.0f;
+    pixelsPerMetre = layoutFloors(floors, building, buildingBottomY, buildingTopY, 8.0f);
+    floorButtonIndex.assign(floors.size(), -1);
+
+    float floorSpacing = building.getMinStoreyHeight() * pixelsPerMetre;
+    float elevatorScale = 1.8f;
+    float elevatorWidth = 60.0f * elevatorScale;
+    bank.initialize(building.carCount, floors, 0.0f, elevatorWidth + CAR_SPACING, floorSpacing, building.startFloor,
+                    elevatorWidth, floorSpacing * 0.6f * elevatorScale);
+    MotionLimits limits(building.carSpeed * pixelsPerMetre, building.carAccel * pixelsPerMetre,
+                        building.carJerk * pixelsPerMetre);
+    bank.setMotion(limits, building.doorAnimDuration, building.doorOpenTime);
+    applyZones(bank, building, pixelsPerMetre);
+    for (int i = 0; i < bank.getCarCount(); ++i) {
+        bank.getCar(i).controller.setVerbose(false);
+    }
+
+    ventilationOn = false;
+    simTime = 0.0;
+}
+
+void Simulation::step(float dt) {
+    bank.update(dt, -1, ventilationOn, floorButtonIndex, buttons, -1);
+    simTime += dt;
+}
+
+int Simulation::hallCall(int floorIndex, CallDirection direction, int legFloor) {
+    return bank.hallCall(floorIndex, direction, legFloor);
+}
+
+void Simulation::assignHallCall(int carIndex, int floorIndex, CallDirection direction) {
+    bank.assignHallCall(carIndex, floorIndex, direction);
+}
+
+bool Simulation::carCall(int carIndex, int floorIndex) {
+    return bank.carCall(carIndex, floorIndex);
+}
+
+void Simulation::transferPassengers(int carIndex, int alighting, int boarding) {
+    bank.transferPassengers(carIndex, alighting, boarding);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Types.h"
+#include "Constants.h"
+#include "BuildingConfig.h"
+#include "ElevatorBank.h"
+#include <vector>
+
+// Lay out the building's floor platforms between bottomY and topY, keeping the
+// storey heights in proportion (shared by the app and headless runs).
+// Returns the scale in pixels per metre.
+float layoutFloors(std::vector<Floor>& floors, const BuildingConfig& building,
+                   float buildingBottomY, float buildingTopY, float floorThickness);
+
+// Served floors and speed of every car from the building's zones (after
+// ElevatorBank::setMotion; shared by the app and headless runs)
+void applyZones(ElevatorBank& bank, const BuildingConfig& building, float pixelsPerMetre);
+
+// Elevator simulation without GLFW/GL: owns the bank and everything its update needs
+class Simulation {
+public:
+    Simulation();
+
+    // Floors, cars (all starting at building.startFloor), speed and door timings from the config
+    void initialize(const BuildingConfig& building);
+
+    // Advance the simulation by one fixed step
+    void step(float dt);
+
+    // Hall call, assigned to a car by the bank's dispatcher; returns the car
+    // (legFloor: see ElevatorBank::hallCall)
+    int hallCall(int floorIndex, CallDirection direction = CallDirection::Any, int legFloor = -1);
+
+    // Hall call for a car chosen outside the bank (destination dispatch)
+    void assignHallCall(int carIndex, int floorIndex, CallDirection direction);
+
+    // Car call from inside a car
+    bool carCall(int carIndex, int floorIndex);
+
+    // Passengers got off / on a car standing open
+    void transferPassengers(int carIndex, int alighting, int boarding);
+
+    // Getters
+    double getTime() const { return simTime; }
+    const std::vector<Floor>& getFloors() const { return floors; }
+    int getFloorCount() const { return (int)floors.size(); }
+    float getPixelsPerMetre() const { return pixelsPerMetre; }
+    ElevatorBank& getBank() { return bank; }
+    const ElevatorBank& getBank() const { return bank; }
+
+private:
+    std::vector<Floor> floors;
+    ElevatorBank bank;
+    bool ventilationOn;
+    float pixelsPerMetre;
+
+    // no panel in headless runs, update() still expects these
+    std::vector<Button> buttons;
+    std::vector<int> floorButtonIndex;
+
+    double simTime;
+};
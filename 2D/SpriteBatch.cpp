@@ -0,0 +1,171 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+
+static unsigned char toByte(float c) {
+    if (c <= 0.0f) return 0;
+    if (c >= 1.0f) return 255;
+    return (unsigned char)(c * 255.0f + 0.5f);
+}
+
+SpriteBatch::SpriteBatch()
+    : VAO(0), VBO(0), EBO(0), whiteTexture(0), plainTexture(0), plainU(0.5f), plainV(0.5f),
+      capacity(0), uploaded(false), nextQuad(0), lastQuads(0), lastDraws(0) {
+}
+
+void SpriteBatch::initialize(int initialQuads) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+
+    unsigned char white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &whiteTexture);
+    glBindTexture(GL_TEXTURE_2D, whiteTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    plainTexture = whiteTexture;
+
+    quads.reserve(initialQuads);
+    reserveQuads(initialQuads);
+}
+
+void SpriteBatch::reserveQuads(int count) {
+    int grown = capacity > 0 ? capacity : 64;
+    while (grown < count) grown *= 2;
+    if (grown == capacity) return;
+    capacity = grown;
+
+	// the same two triangles for every quad; the VAO keeps the element buffer
+    std::vector<unsigned int> indices((size_t)capacity * 6);
+    for (int q = 0; q < capacity; ++q) {
+        unsigned int base = (unsigned int)q * 4;
+        unsigned int* i = &indices[(size_t)q * 6];
+        i[0] = base + 0; i[1] = base + 1; i[2] = base + 2;
+        i[3] = base + 2; i[4] = base + 3; i[5] = base + 0;
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+}
+
+void SpriteBatch::setPlainRegion(const AtlasRegion& white) {
+    if (white.texture == 0) return;
+    plainTexture = white.texture;
+    plainU = 0.5f * (white.u0 + white.u1);
+    plainV = 0.5f * (white.v0 + white.v1);
+}
+
+void SpriteBatch::begin() {
+    quads.clear();
+    uploaded = false;
+    nextQuad = 0;
+}
+
+void SpriteBatch::addQuad(int layer, unsigned int texture, float x0, float y0, float x1, float y1,
+                          float r, float g, float b, float a, float u0, float v0, float u1, float v1) {
+    if (texture == 0) {
+        texture = plainTexture;
+        u0 = u1 = plainU;
+        v0 = v1 = plainV;
+    }
+    unsigned char cr = toByte(r), cg = toByte(g), cb = toByte(b), ca = toByte(a);
+    Quad q;
+    q.layer = layer;
+    q.texture = texture;
+    q.v[0] = { x0, y0, u0, v0, cr, cg, cb, ca };
+    q.v[1] = { x1, y0, u1, v0, cr, cg, cb, ca };
+    q.v[2] = { x1, y1, u1, v1, cr, cg, cb, ca };
+    q.v[3] = { x0, y1, u0, v1, cr, cg, cb, ca };
+    quads.push_back(q);
+}
+
+void SpriteBatch::addQuad(int layer, const AtlasRegion& region, float x0, float y0, float x1, float y1,
+                          float r, float g, float b, float a, float u0, float v0, float u1, float v1) {
+    float du = region.u1 - region.u0;
+    float dv = region.v1 - region.v0;
+    addQuad(layer, region.texture, x0, y0, x1, y1, r, g, b, a,
+            region.u0 + u0 * du, region.v0 + v0 * dv, region.u0 + u1 * du, region.v0 + v1 * dv);
+}
+
+void SpriteBatch::addTriangle(int layer, float x0, float y0, float x1, float y1, float x2, float y2,
+                              float r, float g, float b, float a) {
+    unsigned char cr = toByte(r), cg = toByte(g), cb = toByte(b), ca = toByte(a);
+    Quad q;
+    q.layer = layer;
+    q.texture = plainTexture;
+    q.v[0] = { x0, y0, plainU, plainV, cr, cg, cb, ca };
+    q.v[1] = { x1, y1, plainU, plainV, cr, cg, cb, ca };
+    q.v[2] = { x2, y2, plainU, plainV, cr, cg, cb, ca };
+    q.v[3] = q.v[0];
+    quads.push_back(q);
+}
+
+void SpriteBatch::flush(int throughLayer) {
+    int count = (int)quads.size();
+    if (!uploaded) {
+        upload();
+    }
+    if (nextQuad >= count) return;
+
+    int end = nextQuad;
+    while (end < count && keys[end].layer <= throughLayer) ++end;
+    if (end == nextQuad) return;
+
+    glBindVertexArray(VAO);
+    glActiveTexture(GL_TEXTURE0);
+    int runStart = nextQuad;
+    for (int i = runStart + 1; i <= end; ++i) {
+        if (i < end && keys[i].texture == keys[runStart].texture) continue;
+        glBindTexture(GL_TEXTURE_2D, keys[runStart].texture);
+        glDrawElements(GL_TRIANGLES, (i - runStart) * 6, GL_UNSIGNED_INT,
+                       (void*)((size_t)runStart * 6 * sizeof(unsigned int)));
+        ++lastDraws;
+        runStart = i;
+    }
+    glBindVertexArray(0);
+    nextQuad = end;
+}
+
+void SpriteBatch::upload() {
+    int count = (int)quads.size();
+    uploaded = true;
+    nextQuad = 0;
+    lastQuads = count;
+    lastDraws = 0;
+    if (count == 0) return;
+
+	// back to front by layer, then grouped by texture; insertion order breaks ties
+    keys.resize(count);
+    for (int i = 0; i < count; ++i) {
+        keys[i] = { quads[i].layer, quads[i].texture, i };
+    }
+    std::sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture != b.texture) return a.texture < b.texture;
+        return a.index < b.index;
+    });
+
+    vertices.resize((size_t)count * 4);
+    for (int i = 0; i < count; ++i) {
+        std::copy(quads[keys[i].index].v, quads[keys[i].index].v + 4, &vertices[(size_t)i * 4]);
+    }
+
+    reserveQuads(count);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	// a fresh store every frame, the driver doesn't wait for last frame's draws
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SpriteVertex), vertices.data(), GL_STREAM_DRAW);
+    glBindVertexArray(0);
+}
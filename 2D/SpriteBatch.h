@@ -0,0 +1,95 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "TextureAtlas.h"
+#include <climits>
+#include <vector>
+
+// Vertex of a batched sprite: position in pixels, texture coordinates and the
+// color the texture is multiplied with (layout 0, 1 and 2 of basic.vert)
+struct SpriteVertex {
+    float x, y;
+    float u, v;
+    unsigned char r, g, b, a;
+};
+
+// Collects every quad of a frame in one streaming vertex buffer and draws
+// them with as few calls as it can. Quads are sorted by layer (back to front)
+// and inside a layer by texture, so quads of one layer must not depend on
+// their order where they overlap. Neighbouring runs with the same texture are
+// one glDrawElements: the number of draws follows the number of textures in
+// use, not the number of sprites on screen; with every image in one atlas
+// page and plain quads sampling a white texel of that page, a frame is a
+// single draw.
+class SpriteBatch {
+public:
+    SpriteBatch();
+
+    // GL objects (needs a current context); untextured quads sample a 1x1 white texture
+    void initialize(int initialQuads = 1024);
+
+    // Untextured quads and triangles sample the middle of this region instead
+    // of the batch's own white texture (a white image in the atlas)
+    void setPlainRegion(const AtlasRegion& white);
+
+    // Start a frame, dropping the quads of the previous one
+    void begin();
+
+    // Quad from (x0, y0) to (x1, y1) with texture coordinates (u0, v0) to
+    // (u1, v1); texture 0 draws the plain color
+    void addQuad(int layer, unsigned int texture, float x0, float y0, float x1, float y1,
+                 float r, float g, float b, float a = 1.0f,
+                 float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+
+    // Quad showing the part (u0, v0) to (u1, v1) of an atlas region, 0 .. 1
+    // being the whole image; a region without texture draws the plain color
+    void addQuad(int layer, const AtlasRegion& region, float x0, float y0, float x1, float y1,
+                 float r, float g, float b, float a = 1.0f,
+                 float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+
+    // Plain triangle (a quad with its last corner on the first)
+    void addTriangle(int layer, float x0, float y0, float x1, float y1, float x2, float y2,
+                     float r, float g, float b, float a = 1.0f);
+
+    // Sort, upload and draw everything added since begin() up to and including
+    // throughLayer (texture unit 0, the caller's shader must be in use). A
+    // later flush in the same frame goes on from there, so whatever is drawn
+    // in between lands between those layers.
+    void flush(int throughLayer = INT_MAX);
+
+    // Of the last flush
+    int getQuadCount() const { return lastQuads; }
+    int getDrawCount() const { return lastDraws; }
+
+private:
+    struct Quad {
+        int layer;
+        unsigned int texture;
+        SpriteVertex v[4];
+    };
+    struct Key {
+        int layer;
+        unsigned int texture;
+        int index;
+    };
+
+    unsigned int VAO, VBO, EBO;
+    unsigned int whiteTexture;
+	unsigned int plainTexture;  // what texture 0 draws with
+	float plainU, plainV;
+	int capacity;  // quads the index buffer covers
+
+    std::vector<Quad> quads;
+	// reused between frames
+    std::vector<Key> keys;
+    std::vector<SpriteVertex> vertices;
+
+	bool uploaded;  // quads of this frame sorted and in the vertex buffer
+	int nextQuad;   // first sorted quad not drawn yet
+
+    int lastQuads;
+    int lastDraws;
+
+    void reserveQuads(int count);
+    void upload();
+};
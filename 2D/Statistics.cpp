@@ -0,0 +1,104 @@
+#include "Statistics.h"
+#include <cmath>
+#include <cstring>
+
+// Index of the highest set bit (v > 0)
+static int highestBit(uint32_t v) {
+    int bit = 0;
+    if (v >= 1u << 16) { v >>= 16; bit += 16; }
+    if (v >= 1u << 8) { v >>= 8; bit += 8; }
+    if (v >= 1u << 4) { v >>= 4; bit += 4; }
+    if (v >= 1u << 2) { v >>= 2; bit += 2; }
+    if (v >= 1u << 1) { bit += 1; }
+    return bit;
+}
+
+static uint32_t toUnits(double seconds) {
+    if (!(seconds > 0.0)) return 0;
+    double units = seconds / HISTOGRAM_RESOLUTION + 0.5;
+    return units >= 4294967295.0 ? 4294967295u : (uint32_t)units;
+}
+
+LatencyHistogram::LatencyHistogram() {
+    clear();
+}
+
+void LatencyHistogram::clear() {
+    std::memset(counts, 0, sizeof(counts));
+    count = 0;
+    sum = 0.0;
+    min = 0;
+    max = 0;
+}
+
+int LatencyHistogram::bucketOf(uint32_t units) {
+    if (units < (uint32_t)SUB_BUCKET_COUNT) return (int)units;
+
+	// shift so the value keeps SUB_BUCKET_BITS - 1 significant bits (64 .. 127)
+    int shift = highestBit(units) - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + (int)(units >> shift) - SUB_BUCKET_HALF;
+}
+
+uint32_t LatencyHistogram::bucketLowest(int bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return (uint32_t)bucket;
+    int k = bucket - SUB_BUCKET_COUNT;
+    int shift = k / SUB_BUCKET_HALF + 1;
+    return (uint32_t)(k % SUB_BUCKET_HALF + SUB_BUCKET_HALF) << shift;
+}
+
+uint32_t LatencyHistogram::bucketHighest(int bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return (uint32_t)bucket;
+    int shift = (bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF + 1;
+    return bucketLowest(bucket) + ((1u << shift) - 1u);
+}
+
+void LatencyHistogram::record(double seconds) {
+    uint32_t units = toUnits(seconds);
+    ++counts[bucketOf(units)];
+    if (count == 0 || units < min) min = units;
+    if (count == 0 || units > max) max = units;
+    ++count;
+    sum += (seconds > 0.0) ? seconds : 0.0;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.count == 0) return;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] += other.counts[i];
+    }
+    if (count == 0 || other.min < min) min = other.min;
+    if (count == 0 || other.max > max) max = other.max;
+    count += other.count;
+    sum += other.sum;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (count == 0) return 0.0;
+    if (p >= 100.0) return getMax();
+
+    long long target = (long long)std::ceil(p / 100.0 * count);
+    if (target < 1) target = 1;
+
+    long long seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += (long long)counts[i];
+        if (seen >= target) {
+            uint32_t top = bucketHighest(i);
+            return (top < max ? top : max) * HISTOGRAM_RESOLUTION;
+        }
+    }
+    return getMax();
+}
+
+long long LatencyHistogram::countBetween(double fromSeconds, double toSeconds) const {
+    uint32_t from = toUnits(fromSeconds);
+    uint32_t to = toUnits(toSeconds);
+    if (count == 0 || to <= from) return 0;
+
+    long long n = 0;
+    for (int i = bucketOf(from); i < BUCKET_COUNT; ++i) {
+        if (bucketLowest(i) >= to) break;
+        n += (long long)counts[i];
+    }
+    return n;
+}
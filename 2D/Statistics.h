@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+const double HISTOGRAM_RESOLUTION = 0.001;  // seconds per histogram unit
+
+// Log-linear histogram of durations (HDR style) in fixed memory: values are
+// counted in 1 ms units, exact below 128 ms, above that every power of two is
+// split into 64 buckets (under 1.6 % error). Recording is O(1), percentiles
+// scan the buckets once, and merging two histograms is a bucket-wise add.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 7;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;        // exact range
+    static const int SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;         // buckets per power of two above it
+    static const int BUCKET_COUNT = SUB_BUCKET_COUNT + (32 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+    LatencyHistogram();
+
+    void clear();
+
+	// Durations in seconds; negative values count as 0, values past ~49 days are clamped
+    void record(double seconds);
+
+    void merge(const LatencyHistogram& other);
+
+    long long getCount() const { return count; }
+    double getMean() const { return count > 0 ? sum / count : 0.0; }
+    double getMin() const { return count > 0 ? min * HISTOGRAM_RESOLUTION : 0.0; }
+    double getMax() const { return count > 0 ? max * HISTOGRAM_RESOLUTION : 0.0; }
+
+	// Smallest value with at least p % of the samples at or below it (p in 0 .. 100),
+	// reported as the top of its bucket; 0 if empty
+    double percentile(double p) const;
+
+    // Samples in [fromSeconds, toSeconds), bucket resolution
+    long long countBetween(double fromSeconds, double toSeconds) const;
+
+private:
+    uint64_t counts[BUCKET_COUNT];
+    long long count;
+	double sum;     // seconds, for the mean
+	uint32_t min;   // units
+    uint32_t max;
+
+    static int bucketOf(uint32_t units);
+    static uint32_t bucketLowest(int bucket);
+    static uint32_t bucketHighest(int bucket);
+};
+
+// Per-passenger timings
+struct PassengerStats {
+	LatencyHistogram waitTime;  // hall call -> boarding
+	LatencyHistogram tripTime;  // boarding -> alighting
+
+    void clear() {
+        waitTime.clear();
+        tripTime.clear();
+    }
+
+    void merge(const PassengerStats& other) {
+        waitTime.merge(other.waitTime);
+        tripTime.merge(other.tripTime);
+    }
+};
@@ -0,0 +1,190 @@
+#include "TextureAtlas.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <iostream>
+
+static int alignUp(int value, int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Half size, each texel the average of a 2x2 block (edges repeat on odd sizes)
+static void halveImage(std::vector<unsigned char>& pixels, int& width, int& height) {
+    int newWidth = width > 1 ? width / 2 : 1;
+    int newHeight = height > 1 ? height / 2 : 1;
+    std::vector<unsigned char> out((size_t)newWidth * newHeight * 4);
+    for (int y = 0; y < newHeight; ++y) {
+        int sy0 = std::min(2 * y, height - 1);
+        int sy1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < newWidth; ++x) {
+            int sx0 = std::min(2 * x, width - 1);
+            int sx1 = std::min(2 * x + 1, width - 1);
+            const unsigned char* p00 = &pixels[((size_t)sy0 * width + sx0) * 4];
+            const unsigned char* p01 = &pixels[((size_t)sy0 * width + sx1) * 4];
+            const unsigned char* p10 = &pixels[((size_t)sy1 * width + sx0) * 4];
+            const unsigned char* p11 = &pixels[((size_t)sy1 * width + sx1) * 4];
+            unsigned char* o = &out[((size_t)y * newWidth + x) * 4];
+            for (int c = 0; c < 4; ++c) {
+                o[c] = (unsigned char)((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+            }
+        }
+    }
+    pixels.swap(out);
+    width = newWidth;
+    height = newHeight;
+}
+
+TextureAtlas::TextureAtlas() {
+}
+
+void TextureAtlas::add(const std::string& name, const std::string& path) {
+    Image image;
+    image.name = name;
+    image.path = path;
+    image.width = image.height = 0;
+    image.page = -1;
+    image.x = image.y = 0;
+    images.push_back(image);
+}
+
+void TextureAtlas::addPixels(const std::string& name, int width, int height, const unsigned char* rgba) {
+    Image image;
+    image.name = name;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+    image.page = -1;
+    image.x = image.y = 0;
+    images.push_back(image);
+}
+
+int TextureAtlas::build(int pageSize, int maxImageSize) {
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if (maxTextureSize > 0 && pageSize > maxTextureSize) pageSize = maxTextureSize;
+
+    // Load and shrink until the image and its border fit a page
+    stbi_set_flip_vertically_on_load(true);
+    for (Image& image : images) {
+        if (!image.path.empty()) {
+            int channels = 0;
+            unsigned char* data = stbi_load(image.path.c_str(), &image.width, &image.height, &channels, 4);
+            if (!data) {
+                std::cout << "Texture not loaded! Path: " << image.path << std::endl;
+                image.width = image.height = 0;
+                continue;
+            }
+            image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+            stbi_image_free(data);
+        }
+        while ((image.width > 1 || image.height > 1) &&
+               (image.width > maxImageSize || image.height > maxImageSize ||
+                image.width + 2 * PADDING > pageSize || image.height + 2 * PADDING > pageSize)) {
+            halveImage(image.pixels, image.width, image.height);
+        }
+    }
+
+    // Shelves, tallest images first: a shelf is as high as its first image and
+    // a new page starts when the next shelf doesn't fit
+    std::vector<int> order;
+    for (int i = 0; i < (int)images.size(); ++i) {
+        if (images[i].width > 0) order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return images[a].height > images[b].height;
+    });
+
+    std::vector<int> pageWidths, pageHeights;
+    int cursorX = 0, shelfY = 0, shelfHeight = 0;
+    for (int index : order) {
+        Image& image = images[index];
+        int cellWidth = alignUp(image.width + 2 * PADDING, ALIGN);
+        int cellHeight = alignUp(image.height + 2 * PADDING, ALIGN);
+
+        if (!pageWidths.empty() && cursorX + cellWidth > pageSize) {
+            shelfY += shelfHeight;
+            cursorX = 0;
+            shelfHeight = 0;
+        }
+        if (pageWidths.empty() || shelfY + cellHeight > pageSize) {
+            pageWidths.push_back(0);
+            pageHeights.push_back(0);
+            cursorX = shelfY = shelfHeight = 0;
+        }
+
+        image.page = (int)pageWidths.size() - 1;
+        image.x = cursorX;
+        image.y = shelfY;
+        cursorX += cellWidth;
+        shelfHeight = std::max(shelfHeight, cellHeight);
+        pageWidths.back() = std::max(pageWidths.back(), cursorX);
+        pageHeights.back() = std::max(pageHeights.back(), shelfY + shelfHeight);
+    }
+
+    // Fill the pages, every cell is its image with the edge texels stretched
+    // over the border
+    std::vector<std::vector<unsigned char>> pagePixels(pageWidths.size());
+    for (size_t p = 0; p < pageWidths.size(); ++p) {
+        pagePixels[p].assign((size_t)pageWidths[p] * pageHeights[p] * 4, 0);
+    }
+    for (int index : order) {
+        const Image& image = images[index];
+        std::vector<unsigned char>& target = pagePixels[image.page];
+        int targetWidth = pageWidths[image.page];
+        int cellWidth = alignUp(image.width + 2 * PADDING, ALIGN);
+        int cellHeight = alignUp(image.height + 2 * PADDING, ALIGN);
+        for (int y = 0; y < cellHeight; ++y) {
+            int sy = std::min(std::max(y - PADDING, 0), image.height - 1);
+            for (int x = 0; x < cellWidth; ++x) {
+                int sx = std::min(std::max(x - PADDING, 0), image.width - 1);
+                const unsigned char* src = &image.pixels[((size_t)sy * image.width + sx) * 4];
+                std::copy(src, src + 4, &target[((size_t)(image.y + y) * targetWidth + image.x + x) * 4]);
+            }
+        }
+    }
+
+    pages.assign(pageWidths.size(), 0);
+    for (size_t p = 0; p < pages.size(); ++p) {
+        glGenTextures(1, &pages[p]);
+        glBindTexture(GL_TEXTURE_2D, pages[p]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pageWidths[p], pageHeights[p], 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     pagePixels[p].data());
+        // only as many levels as the border covers
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, MIP_LEVELS);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    regions.clear();
+    for (Image& image : images) {
+        AtlasRegion region = { 0, 0.0f, 0.0f, 1.0f, 1.0f };
+        if (image.page >= 0) {
+            float width = (float)pageWidths[image.page];
+            float height = (float)pageHeights[image.page];
+            region.texture = pages[image.page];
+            region.u0 = (image.x + PADDING) / width;
+            region.v0 = (image.y + PADDING) / height;
+            region.u1 = (image.x + PADDING + image.width) / width;
+            region.v1 = (image.y + PADDING + image.height) / height;
+        }
+        regions[image.name] = region;
+    }
+	// the pixels live in the pages now
+    images.clear();
+
+    return (int)pages.size();
+}
+
+const AtlasRegion& TextureAtlas::get(const std::string& name) const {
+    static const AtlasRegion missing = { 0, 0.0f, 0.0f, 1.0f, 1.0f };
+    auto it = regions.find(name);
+    return it != regions.end() ? it->second : missing;
+}
+
+bool TextureAtlas::has(const std::string& name) const {
+    auto it = regions.find(name);
+    return it != regions.end() && it->second.texture != 0;
+}
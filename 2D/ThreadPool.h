@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads taking jobs from one queue. Meant for coarse,
+// independent jobs (one simulation replica each): the queue lock is only taken
+// once per job, never inside a job.
+class ThreadPool {
+public:
+	// threadCount <= 0: one worker per hardware thread
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Block until every submitted job has finished
+    void wait();
+
+    int getThreadCount() const { return (int)workers.size(); }
+
+    // Hardware threads, at least 1
+    static int hardwareThreads();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+	std::condition_variable jobAvailable;  // workers wait here
+	std::condition_variable allDone;       // wait() waits here
+	int running;  // jobs taken but not finished
+    bool stopping;
+
+    void workerLoop();
+};
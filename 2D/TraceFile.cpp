@@ -0,0 +1,423 @@
+#include "TraceFile.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char TRACE_MAGIC[8] = { 'E', 'L', 'V', 'T', 'R', 'A', 'C', 'E' };
+static const size_t HEADER_SIZE = 40;       // magic, version, floors, events, first, last
+static const size_t BLOCK_HEADER_SIZE = 24; // events, base time, time / floor / destination bytes
+
+// ---- little-endian fields and varints ----
+
+static void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((char)(v >> (8 * i)));
+}
+
+static void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back((char)(v >> (8 * i)));
+}
+
+static void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t getU64(const uint8_t* p) {
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+}
+
+// Decode one varint from [p, end); false if it runs past end
+static inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+	// floors and most time steps fit in one or two bytes
+    if (end - p >= 2) {
+        if (p[0] < 0x80) {
+            v = *p++;
+            return true;
+        }
+        if (p[1] < 0x80) {
+            v = (uint64_t)(p[0] & 0x7f) | ((uint64_t)p[1] << 7);
+            p += 2;
+            return true;
+        }
+    }
+
+    uint64_t result = 0;
+    int shift = 0;
+    while (p < end && shift < 64) {
+        uint8_t byte = *p++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            v = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+// ---- writer ----
+
+// Columns of the block being written
+struct TraceBlockWriter {
+    std::string time;
+    std::string floor;
+    std::string direction;
+    std::string destination;
+    std::string header;
+    int count = 0;
+    int64_t baseTime = 0;
+    int64_t previousTime = 0;
+
+    void add(int64_t t, int floorIndex, CallDirection dir, int dest) {
+        if (count == 0) {
+            baseTime = t;
+            previousTime = t;
+        }
+        putVarint(time, (uint64_t)(t - previousTime));
+        previousTime = t;
+        putVarint(floor, (uint64_t)floorIndex);
+        if ((count & 3) == 0) direction.push_back(0);
+        direction.back() = (char)(direction.back() | ((int)dir << (2 * (count & 3))));
+        putVarint(destination, (uint64_t)(dest + 1));
+        ++count;
+    }
+
+    void flush(std::ofstream& out) {
+        if (count == 0) return;
+        header.clear();
+        putU32(header, (uint32_t)count);
+        putU64(header, (uint64_t)baseTime);
+        putU32(header, (uint32_t)time.size());
+        putU32(header, (uint32_t)floor.size());
+        putU32(header, (uint32_t)destination.size());
+        out.write(header.data(), header.size());
+        out.write(time.data(), time.size());
+        out.write(floor.data(), floor.size());
+        out.write(direction.data(), direction.size());
+        out.write(destination.data(), destination.size());
+
+        time.clear();
+        floor.clear();
+        direction.clear();
+        destination.clear();
+        count = 0;
+    }
+};
+
+static std::string traceHeader(int floorCount, uint64_t eventCount, int64_t firstTime, int64_t lastTime) {
+    std::string header(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    putU32(header, (uint32_t)TRACE_VERSION);
+    putU32(header, (uint32_t)floorCount);
+    putU64(header, eventCount);
+    putU64(header, (uint64_t)firstTime);
+    putU64(header, (uint64_t)lastTime);
+    return header;
+}
+
+bool convertTraceCsv(const char* csvPath, const char* tracePath) {
+    std::ifstream in(csvPath);
+    if (!in) {
+        std::cerr << "Cannot open CSV file: " << csvPath << std::endl;
+        return false;
+    }
+    std::ofstream out(tracePath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot create trace file: " << tracePath << std::endl;
+        return false;
+    }
+
+	// placeholder header, rewritten once the counts are known
+    std::string header = traceHeader(0, 0, 0, 0);
+    out.write(header.data(), header.size());
+
+    TraceBlockWriter block;
+    uint64_t eventCount = 0;
+    int64_t firstTime = 0;
+    int64_t lastTime = 0;
+    int floorCount = 0;
+
+    std::string line;
+    long long lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        const char* p = line.c_str();
+        while (*p == ' ' || *p == '\t') ++p;
+		if (!((*p >= '0' && *p <= '9') || *p == '.')) continue; // header or empty line
+
+        char* end;
+        double seconds = std::strtod(p, &end);
+        bool ok = (*end == ',');
+        long floorIndex = ok ? std::strtol(end + 1, &end, 10) : -1;
+        ok = ok && (*end == ',') && floorIndex >= 0 && floorIndex < FloorMask::MAX_FLOORS;
+
+        CallDirection dir = CallDirection::Any;
+        long dest = -1;
+        if (ok) {
+            p = end + 1;
+            while (*p == ' ') ++p;
+            if (*p == 'u' || *p == 'U') dir = CallDirection::Up;
+            else if (*p == 'd' || *p == 'D') dir = CallDirection::Down;
+            while (*p && *p != ',') ++p;
+            if (*p == ',') {
+                dest = std::strtol(p + 1, &end, 10);
+                if (end == p + 1) dest = -1; // empty column
+            }
+            ok = dest >= -1 && dest < FloorMask::MAX_FLOORS;
+        }
+
+        int64_t t = (int64_t)std::llround(seconds * 1000.0);
+        if (ok && eventCount > 0 && t < lastTime) {
+            std::cerr << "CSV is not sorted by time (line " << lineNumber << ")" << std::endl;
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Bad CSV line " << lineNumber << ": " << line << std::endl;
+            return false;
+        }
+
+        if (eventCount == 0) firstTime = t;
+        lastTime = t;
+        ++eventCount;
+        if (floorIndex + 1 > floorCount) floorCount = (int)floorIndex + 1;
+        if (dest + 1 > floorCount) floorCount = (int)dest + 1;
+
+        block.add(t, (int)floorIndex, dir, (int)dest);
+        if (block.count == TRACE_BLOCK_EVENTS) block.flush(out);
+    }
+    block.flush(out);
+
+    header = traceHeader(floorCount, eventCount, firstTime, lastTime);
+    out.seekp(0);
+    out.write(header.data(), header.size());
+    if (!out) {
+        std::cerr << "Cannot write trace file: " << tracePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ---- memory mapping ----
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : bytes(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || (unsigned long long)fileSize.QuadPart > (size_t)-1) {
+        close();
+        return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+	if (length == 0) return true; // nothing to map
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) bytes = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!bytes) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    bytes = nullptr;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+    length = 0;
+}
+
+#else
+
+MappedFile::MappedFile() : bytes(nullptr), length(0) {
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps the file open
+    if (view == MAP_FAILED) {
+        length = 0;
+        return false;
+    }
+	madvise(view, length, MADV_SEQUENTIAL); // read-ahead, pages behind can be dropped
+    bytes = (const uint8_t*)view;
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) munmap((void*)bytes, length);
+    bytes = nullptr;
+    length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// ---- reader ----
+
+TraceReader::TraceReader()
+    : floorCount(0), eventCount(0), firstTime(0), lastTime(0), offset(0), decodedCount(0), corrupt(false),
+      times(TRACE_BLOCK_EVENTS), floors(TRACE_BLOCK_EVENTS), directions(TRACE_BLOCK_EVENTS),
+      destinations(TRACE_BLOCK_EVENTS), blockCount(0), position(0) {
+}
+
+bool TraceReader::open(const char* path) {
+    if (!file.open(path)) {
+        std::cerr << "Cannot map trace file: " << path << std::endl;
+        return false;
+    }
+
+    const uint8_t* p = file.data();
+    if (file.size() < HEADER_SIZE || std::memcmp(p, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        std::cerr << "Not a trace file: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    if (getU32(p + 8) != (uint32_t)TRACE_VERSION) {
+        std::cerr << "Unsupported trace version " << getU32(p + 8) << ": " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    floorCount = (int)getU32(p + 12);
+    eventCount = getU64(p + 16);
+    firstTime = (int64_t)getU64(p + 24);
+    lastTime = (int64_t)getU64(p + 32);
+    rewind();
+    return true;
+}
+
+void TraceReader::rewind() {
+    offset = HEADER_SIZE;
+    decodedCount = 0;
+    blockCount = 0;
+    position = 0;
+    corrupt = false;
+}
+
+bool TraceReader::decodeBlock() {
+    blockCount = 0;
+    position = 0;
+    size_t size = file.size();
+    if (corrupt) return false;
+    if (offset >= size) {
+		// a file cut at a block boundary still has to hold every event
+        corrupt = (decodedCount != eventCount);
+        return false;
+    }
+
+    const uint8_t* base = file.data();
+    if (size - offset < BLOCK_HEADER_SIZE) {
+        corrupt = true;
+        return false;
+    }
+    const uint8_t* h = base + offset;
+    uint32_t count = getU32(h);
+    int64_t t = (int64_t)getU64(h + 4);
+    size_t timeBytes = getU32(h + 12);
+    size_t floorBytes = getU32(h + 16);
+    size_t destinationBytes = getU32(h + 20);
+    size_t directionBytes = (count + 3) / 4;
+
+    size_t columns = timeBytes + floorBytes + directionBytes + destinationBytes;
+    if (count == 0 || count > (uint32_t)TRACE_BLOCK_EVENTS || size - offset - BLOCK_HEADER_SIZE < columns) {
+        corrupt = true;
+        return false;
+    }
+
+    const uint8_t* timeColumn = h + BLOCK_HEADER_SIZE;
+    const uint8_t* floorColumn = timeColumn + timeBytes;
+    const uint8_t* directionColumn = floorColumn + floorBytes;
+    const uint8_t* destinationColumn = directionColumn + directionBytes;
+    const uint8_t* end = destinationColumn + destinationBytes;
+
+	// one column at a time: each loop is a tight varint decode over contiguous bytes
+    const uint8_t* p = timeColumn;
+    uint64_t v = 0;
+    bool ok = true;
+    for (uint32_t i = 0; i < count; ++i) {
+        ok &= getVarint(p, floorColumn, v);
+        t += (int64_t)v;
+        times[i] = t;
+    }
+    p = floorColumn;
+    uint64_t highest = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        ok &= getVarint(p, directionColumn, v);
+        highest |= v;
+        floors[i] = (int)v;
+    }
+    for (uint32_t i = 0; i < count && ok; ++i) {
+        ok = floors[i] < floorCount;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        int bits = (directionColumn[i >> 2] >> (2 * (i & 3))) & 3;
+        directions[i] = (bits <= (int)CallDirection::Any) ? (CallDirection)bits : CallDirection::Any;
+    }
+    p = destinationColumn;
+    for (uint32_t i = 0; i < count; ++i) {
+        ok &= getVarint(p, end, v);
+        highest |= v;
+        destinations[i] = (int)v - 1;
+    }
+    for (uint32_t i = 0; i < count && ok; ++i) {
+        ok = destinations[i] < floorCount;
+    }
+    if (!ok || highest > (uint64_t)INT32_MAX) {
+        corrupt = true;
+        return false;
+    }
+
+    offset = end - base;
+    decodedCount += count;
+    blockCount = (int)count;
+    return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CallRegistry.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact binary trace of recorded hall calls, for replaying real logs.
+//
+// Layout (little endian):
+//   header   "ELVTRACE", version, floor count, event count, first and last
+//            timestamp (ms)
+//   blocks   up to TRACE_BLOCK_EVENTS events each, stored column by column:
+//              time         varint ms since the previous event (the first one
+//                           since the block's base time)
+//              floor        varint
+//              direction    2 bits per event (CallDirection), 4 per byte
+//              destination  varint floor + 1, 0 = unknown
+// Blocks are independent, so the reader decodes one block of columns at a time
+// into fixed buffers and never allocates per event.
+const int TRACE_VERSION = 1;
+const int TRACE_BLOCK_EVENTS = 4096;
+
+// One recorded call; time in seconds since the first event of the trace
+struct TraceEvent {
+    double time;
+    int floor;
+    CallDirection direction;
+    int destination;  // -1 when the log doesn't have it
+};
+
+// CSV -> trace. One event per line, "<time_s>,<floor>,<up|down|any>,<destination>",
+// destination may be empty or -1; lines not starting with a number (headers)
+// are skipped. Times must not decrease. Reads and writes one block at a time,
+// so the input can be any size. Returns false on bad input (reason to stderr).
+bool convertTraceCsv(const char* csvPath, const char* tracePath);
+
+// Read-only view of a whole file, mapped into memory
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes;
+    size_t length;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+};
+
+// Streams the events of a trace file in order from a memory mapping
+class TraceReader {
+public:
+    TraceReader();
+
+    // false (reason to stderr) if the file can't be mapped or isn't a trace
+    bool open(const char* path);
+
+    // Next event; false at the end of the trace or on a corrupt block
+    bool next(TraceEvent& e) {
+        if (position == blockCount && !decodeBlock()) return false;
+        e.time = (double)(times[position] - firstTime) * 0.001;
+        e.floor = floors[position];
+        e.direction = directions[position];
+        e.destination = destinations[position];
+        ++position;
+        return true;
+    }
+
+    // Back to the first event
+    void rewind();
+
+    int getFloorCount() const { return floorCount; }
+    uint64_t getEventCount() const { return eventCount; }
+	double getDuration() const { return (double)(lastTime - firstTime) * 0.001; } // seconds, first to last event
+	// a block didn't decode, or the file ended short of getEventCount() events
+    bool isCorrupt() const { return corrupt; }
+
+private:
+    MappedFile file;
+    int floorCount;
+    uint64_t eventCount;
+    int64_t firstTime;
+    int64_t lastTime;
+	size_t offset;     // next block in the file
+	uint64_t decodedCount;  // events in the blocks decoded so far
+    bool corrupt;
+
+	// the decoded block
+    std::vector<int64_t> times;
+    std::vector<int> floors;
+    std::vector<CallDirection> directions;
+    std::vector<int> destinations;
+    int blockCount;
+    int position;
+
+    bool decodeBlock();
+};
@@ -0,0 +1,234 @@
+#include "TrafficGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const char* const TRAFFIC_PROFILE_NAMES = "up-peak, down-peak, lunch, interfloor, day";
+
+OdMatrix::OdMatrix() : floorCount(0) {
+}
+
+OdMatrix::OdMatrix(int floorCount_)
+    : floorCount(floorCount_), weights((size_t)floorCount_ * floorCount_, 0.0) {
+}
+
+void OdMatrix::set(int from, int to, double weight) {
+    if (from < 0 || from >= floorCount || to < 0 || to >= floorCount || from == to) return;
+    weights[(size_t)from * floorCount + to] = weight > 0.0 ? weight : 0.0;
+}
+
+bool OdMatrix::finalize() {
+    originSums.assign(floorCount, 0.0);
+    rowSums.assign(weights.size(), 0.0);
+
+    double total = 0.0;
+    for (int from = 0; from < floorCount; ++from) {
+        size_t row = (size_t)from * floorCount;
+        double sum = 0.0;
+        for (int to = 0; to < floorCount; ++to) {
+            sum += weights[row + to];
+            rowSums[row + to] = sum;
+        }
+        total += sum;
+        originSums[from] = total;
+    }
+    return total > 0.0;
+}
+
+void OdMatrix::sample(std::mt19937& rng, int& from, int& to) const {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+	// origin by row total, then destination within the row (empty rows and
+	// zero weights are never picked: their cumulative value doesn't grow)
+    double u = unit(rng) * originSums.back();
+    from = (int)(std::upper_bound(originSums.begin(), originSums.end(), u) - originSums.begin());
+    if (from >= floorCount) from = floorCount - 1;
+
+    std::vector<double>::const_iterator row = rowSums.begin() + (size_t)from * floorCount;
+    double v = unit(rng) * row[floorCount - 1];
+    to = (int)(std::upper_bound(row, row + floorCount, v) - row);
+    if (to >= floorCount) to = floorCount - 1;
+}
+
+OdMatrix OdMatrix::lobbyMix(int floorCount, int lobbyFloor, double incoming, double outgoing, double interfloor) {
+    OdMatrix od(floorCount);
+    int others = floorCount - 1;
+    if (others < 1) return od;
+
+    double upWeight = incoming / others;
+    double downWeight = outgoing / others;
+    double interWeight = (others > 1) ? interfloor / ((double)others * (others - 1)) : 0.0;
+
+    for (int from = 0; from < floorCount; ++from) {
+        for (int to = 0; to < floorCount; ++to) {
+            if (from == to) continue;
+            if (from == lobbyFloor) od.set(from, to, upWeight);
+            else if (to == lobbyFloor) od.set(from, to, downWeight);
+            else od.set(from, to, interWeight);
+        }
+    }
+    return od;
+}
+
+TrafficProfile::TrafficProfile() : period(86400.0) {
+}
+
+double TrafficProfile::rateAt(double time) const {
+    if (rate.empty()) return 0.0;
+    if (rate.size() == 1) return rate[0].passengersPerHour;
+
+    double t = std::fmod(time, period);
+    if (t < 0.0) t += period;
+
+	// segment [a, b) holding t, the last one wraps around to the first point
+    size_t next = 0;
+    while (next < rate.size() && rate[next].time <= t) ++next;
+    const RatePoint& a = rate[(next + rate.size() - 1) % rate.size()];
+    const RatePoint& b = rate[next % rate.size()];
+
+    double ta = a.time;
+    double tb = b.time;
+    if (tb <= ta) tb += period;
+    if (t < ta) t += period;
+    double f = (tb > ta) ? (t - ta) / (tb - ta) : 0.0;
+    return a.passengersPerHour + (b.passengersPerHour - a.passengersPerHour) * f;
+}
+
+double TrafficProfile::maxRate(double from, double to) const {
+	// piecewise linear: the maximum is at an end or at a point inside
+    double best = std::max(rateAt(from), rateAt(to));
+    if (to - from >= period) {
+        for (const RatePoint& p : rate) best = std::max(best, p.passengersPerHour);
+        return best;
+    }
+
+    double start = std::fmod(from, period);
+    if (start < 0.0) start += period;
+    double end = start + (to - from);
+    for (const RatePoint& p : rate) {
+        if ((p.time > start && p.time < end) || (p.time + period > start && p.time + period < end)) {
+            best = std::max(best, p.passengersPerHour);
+        }
+    }
+    return best;
+}
+
+const OdMatrix& TrafficProfile::matrixAt(double time) const {
+    double t = std::fmod(time, period);
+    if (t < 0.0) t += period;
+
+    size_t phase = phases.size() - 1; // before the first start: still the last phase of the previous period
+    for (size_t i = 0; i < phases.size(); ++i) {
+        if (phases[i].start <= t) phase = i;
+    }
+    return matrices[phases[phase].matrix];
+}
+
+bool makeTrafficProfile(const std::string& name, const BuildingConfig& building, double peakPerHour,
+                        TrafficProfile& profile) {
+    int floors = building.floorCount;
+    int lobby = building.lobbyFloor;
+
+	// shares incoming / outgoing / interfloor
+    OdMatrix upPeak = OdMatrix::lobbyMix(floors, lobby, 0.85, 0.05, 0.10);
+    OdMatrix downPeak = OdMatrix::lobbyMix(floors, lobby, 0.05, 0.85, 0.10);
+    OdMatrix lunch = OdMatrix::lobbyMix(floors, lobby, 0.40, 0.40, 0.20);
+    OdMatrix interfloor = OdMatrix::lobbyMix(floors, lobby, 0.10, 0.10, 0.80);
+
+    profile = TrafficProfile();
+    profile.name = name;
+
+    if (name == "day") {
+        const double h = 3600.0;
+        profile.matrices = { interfloor, upPeak, lunch, downPeak };
+        profile.phases = {
+            { 0.0, 0 },
+            { 7.0 * h, 1 },
+            { 9.5 * h, 0 },
+            { 11.75 * h, 2 },
+            { 13.75 * h, 0 },
+            { 16.5 * h, 3 },
+            { 18.5 * h, 0 },
+        };
+        double p = peakPerHour;
+        profile.rate = {
+            { 0.0, 0.02 * p },
+            { 6.0 * h, 0.02 * p },
+            { 7.0 * h, 0.15 * p },
+            { 8.5 * h, p },
+            { 9.5 * h, 0.30 * p },
+            { 11.75 * h, 0.30 * p },
+            { 12.75 * h, 0.70 * p },
+            { 13.75 * h, 0.30 * p },
+            { 16.5 * h, 0.30 * p },
+            { 17.5 * h, p },
+            { 18.5 * h, 0.20 * p },
+            { 21.0 * h, 0.05 * p },
+        };
+    }
+    else {
+        if (name == "up-peak") profile.matrices = { upPeak };
+        else if (name == "down-peak") profile.matrices = { downPeak };
+        else if (name == "lunch") profile.matrices = { lunch };
+        else if (name == "interfloor") profile.matrices = { interfloor };
+        else return false;
+
+        profile.phases = { { 0.0, 0 } };
+        profile.rate = { { 0.0, peakPerHour } };
+    }
+
+    for (OdMatrix& od : profile.matrices) od.finalize();
+    return true;
+}
+
+TrafficGenerator::TrafficGenerator(const TrafficProfile& profile_, unsigned seed, double chunkSeconds_)
+    : profile(profile_), rng(seed), chunkSeconds(chunkSeconds_ > 0.0 ? chunkSeconds_ : 900.0), chunkEnd(0.0),
+      position(0), generated(0) {
+    idle = profile.phases.empty() || profile.maxRate(0.0, profile.period) <= 0.0;
+}
+
+const TrafficArrival& TrafficGenerator::peek() {
+    while (position >= chunk.size()) {
+        fillChunk();
+    }
+    return chunk[position];
+}
+
+TrafficArrival TrafficGenerator::next() {
+    TrafficArrival arrival = peek();
+    ++position;
+    ++generated;
+    return arrival;
+}
+
+void TrafficGenerator::fillChunk() {
+    chunk.clear();
+    position = 0;
+
+    if (idle) {
+        double never = std::numeric_limits<double>::infinity();
+        chunk.push_back({ never, 0, 0 });
+        return;
+    }
+
+    double start = chunkEnd;
+    chunkEnd = start + chunkSeconds;
+
+	// candidates at the chunk's highest rate, each kept with probability
+	// rate(t) / highest; arrivals are memoryless, so every chunk starts fresh
+    double highest = profile.maxRate(start, chunkEnd);
+    if (highest <= 0.0) return;
+
+    std::exponential_distribution<double> gap(highest / 3600.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double t = start + gap(rng);
+    while (t < chunkEnd) {
+        if (unit(rng) * highest < profile.rateAt(t)) {
+            TrafficArrival arrival;
+            arrival.time = t;
+            profile.matrixAt(t).sample(rng, arrival.origin, arrival.destination);
+            chunk.push_back(arrival);
+        }
+        t += gap(rng);
+    }
+}
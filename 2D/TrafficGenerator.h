@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BuildingConfig.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// Origin-destination matrix: relative weight of trips from each floor to each
+// other floor. Weights don't have to add up to anything; call finalize() after
+// the last set() and before sampling.
+class OdMatrix {
+public:
+    OdMatrix();
+    explicit OdMatrix(int floorCount);
+
+    int getFloorCount() const { return floorCount; }
+    double get(int from, int to) const { return weights[(size_t)from * floorCount + to]; }
+    void set(int from, int to, double weight);
+
+    // Build the sampling tables; false if every weight is 0
+    bool finalize();
+
+    // Random trip with probability proportional to its weight
+    void sample(std::mt19937& rng, int& from, int& to) const;
+
+    // Standard pattern: `incoming` share of trips go from the lobby to the other
+    // floors, `outgoing` share from the other floors to the lobby and
+    // `interfloor` share between two non-lobby floors, each spread evenly
+    static OdMatrix lobbyMix(int floorCount, int lobbyFloor, double incoming, double outgoing, double interfloor);
+
+private:
+    int floorCount;
+	std::vector<double> weights;    // row-major, from * floorCount + to
+	std::vector<double> originSums; // cumulative row totals
+	std::vector<double> rowSums;    // cumulative weights within each row
+};
+
+// Arrival rate and trip pattern over a repeating period (a day by default).
+// The rate is piecewise linear between (time of day, passengers per hour)
+// points and wraps from the last point back to the first; the OD matrix
+// switches at the start of each phase.
+struct TrafficProfile {
+    struct RatePoint {
+        double time;            // seconds into the period
+        double passengersPerHour;
+    };
+    struct Phase {
+        double start;           // seconds into the period
+        int matrix;             // index into matrices
+    };
+
+    std::string name;
+    double period;
+	std::vector<RatePoint> rate;     // sorted by time
+	std::vector<Phase> phases;       // sorted by start, the last one wraps to the first
+    std::vector<OdMatrix> matrices;
+
+    TrafficProfile();
+
+    double rateAt(double time) const;
+	double maxRate(double from, double to) const; // upper bound of the rate over [from, to)
+    const OdMatrix& matrixAt(double time) const;
+};
+
+// Standard profiles for `building`, with `peakPerHour` passengers per hour at the busiest moment:
+//   up-peak     morning arrivals, mostly lobby -> floors
+//   down-peak   evening departures, mostly floors -> lobby
+//   lunch       both directions through the lobby
+//   interfloor  mostly floor -> floor, some lobby traffic
+//   day         a working day: quiet night, up-peak around 08:30, lunch around
+//               12:45, down-peak around 17:30, interfloor in between
+// The first four keep their pattern and rate around the clock. Returns false
+// for an unknown name.
+bool makeTrafficProfile(const std::string& name, const BuildingConfig& building, double peakPerHour,
+                        TrafficProfile& profile);
+
+// Names accepted by makeTrafficProfile, for usage messages
+extern const char* const TRAFFIC_PROFILE_NAMES;
+
+// One passenger showing up at a floor
+struct TrafficArrival {
+    double time;
+    int origin;
+    int destination;
+};
+
+// Non-homogeneous Poisson arrivals for a profile, produced lazily one chunk
+// of simulated time at a time (thinning against the highest rate in the
+// chunk). Only the current chunk is held, so a run of any length or building
+// size needs memory for chunkSeconds of arrivals. The stream never ends; a
+// profile with zero rate everywhere yields arrivals at infinity.
+class TrafficGenerator {
+public:
+    TrafficGenerator(const TrafficProfile& profile, unsigned seed, double chunkSeconds = 900.0);
+
+    // Next arrival, generating the following chunk when the current one is used up
+    const TrafficArrival& peek();
+    TrafficArrival next();
+
+    long long getGeneratedCount() const { return generated; }
+    const TrafficProfile& getProfile() const { return profile; }
+
+private:
+    TrafficProfile profile;
+    std::mt19937 rng;
+    double chunkSeconds;
+	double chunkEnd;                   // arrivals before this time have been generated
+    std::vector<TrafficArrival> chunk;
+    size_t position;
+    long long generated;
+    bool idle;
+
+    void fillChunk();
+};
@@ -0,0 +1,520 @@
+#include "TrafficStudy.h"
+#include "Simulation.h"
+#include "EventKernel.h"
+#include "PassengerPopulation.h"
+#include "ThreadPool.h"
+#include "RolloutDispatcher.h"
+#include "DestinationDispatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+bool loadScript(const char* path, int floorCount, std::vector<ScriptedCall>& calls) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open script file: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream ss(line);
+        ScriptedCall call;
+        std::string type;
+        if (!(ss >> call.time)) continue; // empty line
+
+        if (!(ss >> type >> call.floor) || (type != "hall" && type != "car") ||
+            call.floor < 0 || call.floor >= floorCount) {
+            std::cerr << "Bad script line " << lineNumber << ": " << line << std::endl;
+            return false;
+        }
+        call.hallCall = (type == "hall");
+        call.car = 0;
+        call.direction = CallDirection::Any;
+        if (call.hallCall) {
+            std::string direction;
+            if (ss >> direction) {
+                if (direction == "up") call.direction = CallDirection::Up;
+                else if (direction == "down") call.direction = CallDirection::Down;
+                else {
+                    std::cerr << "Bad script line " << lineNumber << ": " << line << std::endl;
+                    return false;
+                }
+            }
+        }
+        else if (!(ss >> call.car)) call.car = 0;
+        calls.push_back(call);
+    }
+
+	// calls are issued in time order
+    for (size_t i = 1; i < calls.size(); ++i) {
+        if (calls[i].time < calls[i - 1].time) {
+            std::cerr << "Script is not sorted by time (line " << i + 1 << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void generateHallCalls(std::vector<ScriptedCall>& calls, int floorCount, double duration,
+                       double callsPerHour, std::mt19937& rng) {
+    std::exponential_distribution<double> gap(callsPerHour / 3600.0);
+    std::uniform_int_distribution<int> floorDist(0, floorCount - 1);
+
+    double t = gap(rng);
+    while (t < duration) {
+        calls.push_back({ t, true, floorDist(rng), -1, CallDirection::Any });
+        t += gap(rng);
+    }
+}
+
+struct RunStats {
+    long long ticks = 0;
+    long long events = 0;
+    long long hallCalls = 0;
+    long long carCalls = 0;
+    long long doorCycles = 0;
+	double travel = 0.0; // summed car movement, pixels
+};
+
+// Generated traffic: every generated hall call is a passenger, with the
+// destination from the traffic profile or trace, or else a random one. In a
+// zoned bank the passenger rides to a transfer floor first when no car serves
+// both ends (ElevatorBank::nextLegFloor).
+struct PassengerTraffic {
+    std::mt19937& rng;
+    bool enabled;
+    int floorCount;
+    const ElevatorBank& bank;
+    PassengerPopulation population;
+    std::uniform_int_distribution<int> destDist;
+
+    PassengerTraffic(std::mt19937& rng, bool enabled, int floorCount, const ElevatorBank& bank)
+        : rng(rng), enabled(enabled), floorCount(floorCount), bank(bank), destDist(0, floorCount - 2) {}
+
+	// Button pressed for a hall call: a passenger knows where they go, so a
+	// missing destination is drawn (on the side the call points to) first;
+	// the button is the one toward the end of their first ride
+    CallDirection direction(const ScriptedCall& call, int& destination) {
+        if (!enabled) return call.direction;
+        if (destination < 0) {
+            int floorIndex = call.floor;
+            if (call.direction == CallDirection::Up && floorIndex + 1 < floorCount) {
+                destination = std::uniform_int_distribution<int>(floorIndex + 1, floorCount - 1)(rng);
+            }
+            else if (call.direction == CallDirection::Down && floorIndex > 0) {
+                destination = std::uniform_int_distribution<int>(0, floorIndex - 1)(rng);
+            }
+            else {
+                destination = destDist(rng);
+                if (destination >= floorIndex) ++destination; // never the boarding floor
+            }
+        }
+        int leg = bank.nextLegFloor(call.floor, destination);
+        return leg > call.floor ? CallDirection::Up : CallDirection::Down;
+    }
+
+	// End of the first ride for the hall call (-1 for scripted calls: any car)
+    int legFloor(int floorIndex, int destination) const {
+        return (enabled && destination >= 0) ? bank.nextLegFloor(floorIndex, destination) : -1;
+    }
+
+    void spawn(int floorIndex, int destination, double time) {
+        if (enabled) population.spawn(floorIndex, destination, time, bank.nextLegFloor(floorIndex, destination));
+    }
+
+	// Destination dispatch: the passenger keys in their floor and waits for a car;
+	// returns true when this entry opened a new batch
+    bool enter(DestinationDispatcher& destinations, int floorIndex, int destination, double time) {
+        int id = population.spawn(floorIndex, destination, time, bank.nextLegFloor(floorIndex, destination));
+        population.assignedCar[id] = CAR_PENDING;
+        return reenter(destinations, id, time);
+    }
+
+    bool reenter(DestinationDispatcher& destinations, int id, double time) {
+        bool opens = std::isinf(destinations.getBatchTime());
+        destinations.enter(id, population.originFloor[id], population.legFloor[id], time);
+        return opens;
+    }
+};
+
+// Calls in time order, either from a list (script or pre-generated) or pulled
+// one at a time from a TrafficGenerator or a TraceReader, so profile and trace
+// traffic is never held whole
+class CallStream {
+public:
+    CallStream(const std::vector<ScriptedCall>& calls, TrafficGenerator* generator, TraceReader* trace, int floorCount)
+        : calls(calls), generator(generator), trace(trace), floorCount(floorCount), nextCall(0), traceEvent(), traceReady(false) {
+        if (trace) readTrace();
+    }
+
+    // Time of the next call, infinity when there is none
+    double peekTime() {
+        if (generator) return generator->peek().time;
+        if (trace) return traceReady ? traceEvent.time : std::numeric_limits<double>::infinity();
+        return nextCall < calls.size() ? calls[nextCall].time : std::numeric_limits<double>::infinity();
+    }
+
+	// Take the next call; destination is the passenger's floor for profile and trace traffic, -1 if unknown
+    ScriptedCall next(int& destination) {
+        if (generator) {
+            TrafficArrival arrival = generator->next();
+            destination = arrival.destination;
+            return { arrival.time, true, arrival.origin, -1, CallDirection::Any };
+        }
+        if (trace) {
+            TraceEvent e = traceEvent;
+            readTrace();
+            destination = (e.destination != e.floor) ? e.destination : -1;
+            return { e.time, true, e.floor, -1, e.direction };
+        }
+        destination = -1;
+        return calls[nextCall++];
+    }
+
+private:
+    const std::vector<ScriptedCall>& calls;
+    TrafficGenerator* generator;
+    TraceReader* trace;
+    int floorCount;
+    size_t nextCall;
+    TraceEvent traceEvent;
+    bool traceReady;
+
+	// next trace event inside this building (a log from a taller one keeps its lower floors)
+    void readTrace() {
+        while ((traceReady = trace->next(traceEvent))) {
+            if (traceEvent.floor < floorCount && traceEvent.destination < floorCount) return;
+        }
+    }
+};
+
+static void addTravel(const ElevatorBank& bank, std::vector<float>& prevY, RunStats& stats) {
+    for (int c = 0; c < bank.getCarCount(); ++c) {
+        float y = bank.getCar(c).controller.getElevator().y;
+        stats.travel += std::fabs(y - prevY[c]);
+        prevY[c] = y;
+    }
+}
+
+static bool hallCallHeld(const ElevatorBank& bank, const HallRecall& recall) {
+    for (int c = 0; c < bank.getCarCount(); ++c) {
+        const ElevatorController& controller = bank.getCar(c).controller;
+        if (controller.getCalls().hasHallCall(recall.floor, recall.direction) &&
+            controller.servesFloor(recall.legFloor)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<float> carPositions(const ElevatorBank& bank) {
+    std::vector<float> y(bank.getCarCount());
+    for (int c = 0; c < bank.getCarCount(); ++c) {
+        y[c] = bank.getCar(c).controller.getElevator().y;
+    }
+    return y;
+}
+
+// Fixed timestep: every car is updated every tick
+static double runFixedStep(Simulation& sim, CallStream& calls, double duration, double dt,
+                           PassengerTraffic& traffic, DestinationDispatcher* destinations, RunStats& stats) {
+    ElevatorBank& bank = sim.getBank();
+    std::vector<DestinationAssignment> assignments;
+    std::vector<ElevatorState> prevState(bank.getCarCount(), ElevatorState::Idle);
+    std::vector<float> prevY = carPositions(bank);
+
+    while (sim.getTime() < duration) {
+        while (calls.peekTime() <= sim.getTime()) {
+            int destination = -1;
+            ScriptedCall call = calls.next(destination);
+            if (call.hallCall && destinations) {
+                traffic.direction(call, destination);
+                ++stats.hallCalls;
+                traffic.enter(*destinations, call.floor, destination, sim.getTime());
+            }
+            else if (call.hallCall) {
+                CallDirection direction = traffic.direction(call, destination);
+                sim.hallCall(call.floor, direction, traffic.legFloor(call.floor, destination));
+                ++stats.hallCalls;
+                traffic.spawn(call.floor, destination, sim.getTime());
+            }
+            else {
+                sim.carCall(call.car, call.floor);
+                ++stats.carCalls;
+            }
+        }
+
+        sim.step((float)dt);
+        ++stats.ticks;
+
+        for (int c = 0; c < bank.getCarCount(); ++c) {
+            const Elevator& elevator = bank.getCar(c).controller.getElevator();
+            if (elevator.state == ElevatorState::DoorsOpen && prevState[c] != ElevatorState::DoorsOpen) {
+                ++stats.doorCycles;
+            }
+            prevState[c] = elevator.state;
+        }
+
+        PassengerPopulation& population = traffic.population;
+        population.update(sim.getTime(), bank);
+        for (const CarTransfer& t : population.getTransfers()) {
+            sim.transferPassengers(t.car, t.alighting, t.boarding);
+        }
+        for (int id : population.getBoarded()) {
+            sim.carCall(population.car[id], population.legFloor[id]);
+            ++stats.carCalls;
+        }
+        for (const HallRecall& recall : population.getRecalls()) {
+            if (hallCallHeld(bank, recall)) continue;
+            sim.hallCall(recall.floor, recall.direction, recall.legFloor);
+            ++stats.hallCalls;
+        }
+        if (destinations) {
+            for (int id : population.getReentries()) {
+                traffic.reenter(*destinations, id, sim.getTime());
+                ++stats.hallCalls;
+            }
+            if (destinations->isDue(sim.getTime())) {
+                destinations->assignBatch(bank, population, assignments);
+                for (const DestinationAssignment& a : assignments) {
+                    sim.assignHallCall(a.car, a.origin, a.direction);
+                    population.assignedCar[a.passenger] = (int16_t)a.car;
+                }
+            }
+        }
+        addTravel(bank, prevY, stats);
+    }
+    return sim.getTime();
+}
+
+// Event driven: the clock jumps between state changes and calls
+static double runEventDriven(Simulation& sim, CallStream& calls, double duration,
+                             PassengerTraffic& traffic, DestinationDispatcher* destinations, RunStats& stats) {
+    ElevatorBank& bank = sim.getBank();
+    EventKernel kernel(bank);
+    std::vector<float> prevY = carPositions(bank);
+    std::vector<DestinationAssignment> assignments;
+
+	// only the next call is queued; it is replaced by the one after it when processed
+    int pendingDestination = -1;
+    auto scheduleNext = [&]() {
+        if (calls.peekTime() >= duration) return;
+        ScriptedCall call = calls.next(pendingDestination);
+        if (call.hallCall && destinations) {
+            traffic.direction(call, pendingDestination);
+            kernel.scheduleDestinationCall(call.time, call.floor);
+        }
+        else if (call.hallCall) {
+            CallDirection direction = traffic.direction(call, pendingDestination);
+            kernel.scheduleHallCall(call.time, call.floor, direction, traffic.legFloor(call.floor, pendingDestination));
+        }
+        else kernel.scheduleCarCall(call.time, call.car, call.floor);
+    };
+    scheduleNext();
+
+    PassengerPopulation& population = traffic.population;
+    SimEvent e;
+    while (kernel.processNext(duration, e)) {
+        bool boarding = false;
+        switch (e.type) {
+        case SimEventType::HallCall:
+            ++stats.hallCalls;
+            traffic.spawn(e.floor, pendingDestination, e.time);
+			boarding = true; // a car may already stand open at the floor
+            scheduleNext();
+            break;
+        case SimEventType::CarCall:
+            ++stats.carCalls;
+            scheduleNext();
+            break;
+        case SimEventType::DestinationCall:
+            ++stats.hallCalls;
+            if (traffic.enter(*destinations, e.floor, pendingDestination, e.time)) {
+                kernel.scheduleTimer(destinations->getBatchTime());
+            }
+            scheduleNext();
+            break;
+        case SimEventType::Timer:
+            if (!destinations || !destinations->isDue(e.time)) break;
+            destinations->assignBatch(bank, population, assignments);
+            for (const DestinationAssignment& a : assignments) {
+                kernel.assignHallCall(a.car, a.origin, a.direction);
+                population.assignedCar[a.passenger] = (int16_t)a.car;
+            }
+			boarding = true; // an assigned car may already stand open at the floor
+            break;
+        case SimEventType::DoorsOpened:
+            ++stats.doorCycles;
+            boarding = true;
+            break;
+        default:
+            break;
+        }
+
+        if (boarding) {
+            population.update(e.time, bank);
+            for (const CarTransfer& t : population.getTransfers()) {
+                kernel.transferPassengers(t.car, t.alighting, t.boarding);
+            }
+            for (int id : population.getBoarded()) {
+                kernel.carCall(population.car[id], population.legFloor[id]);
+                ++stats.carCalls;
+            }
+            for (const HallRecall& recall : population.getRecalls()) {
+                if (hallCallHeld(bank, recall)) continue;
+                kernel.hallCall(recall.floor, recall.direction, recall.legFloor);
+                ++stats.hallCalls;
+            }
+            for (int id : population.getReentries()) {
+                if (traffic.reenter(*destinations, id, e.time)) kernel.scheduleTimer(destinations->getBatchTime());
+                ++stats.hallCalls;
+            }
+        }
+        addTravel(bank, prevY, stats);
+    }
+    addTravel(bank, prevY, stats);
+
+    stats.events = kernel.getProcessedCount();
+    return kernel.getTime();
+}
+
+ReplicaSettings::ReplicaSettings()
+    : scheduling(SchedulingMode::Fifo), eventDriven(false), dt(1.0 / 240.0), duration(86400.0),
+      callsPerHour(120.0), script(nullptr), profile(nullptr), trace(nullptr), rolloutCandidates(0), rolloutHorizon(20.0f), rolloutThreads(1),
+      destinationWindow(0.0) {
+}
+
+void runReplica(const ReplicaSettings& settings, unsigned seed, ReplicaResult& result) {
+    auto wallStart = std::chrono::steady_clock::now();
+    int floorCount = settings.building.floorCount;
+    std::mt19937 rng(seed);
+
+    std::vector<ScriptedCall> generated;
+    const std::vector<ScriptedCall>* calls = settings.script;
+    std::unique_ptr<TrafficGenerator> generator;
+    TraceReader trace;
+    bool replay = !calls && settings.trace;
+    if (replay) {
+		replay = trace.open(settings.trace); // every replica maps the file itself
+    }
+    else if (!calls && settings.profile) {
+        generator.reset(new TrafficGenerator(*settings.profile, rng()));
+    }
+    else if (!calls) {
+        generateHallCalls(generated, floorCount, settings.duration, settings.callsPerHour, rng);
+    }
+    CallStream stream(calls ? *calls : generated, generator.get(), replay ? &trace : nullptr, floorCount);
+
+    Simulation sim;
+    sim.initialize(settings.building);
+    sim.getBank().setSchedulingMode(settings.scheduling);
+    if (!settings.script) {
+		// passengers fill the cars: capacity, boarding times and door dwell from the config
+        const BuildingConfig& b = settings.building;
+        sim.getBank().setLoadModel(b.carCapacity, b.boardTime, b.alightTime, b.minDwellTime, b.bypassLoad);
+    }
+    RolloutDispatcher* rollout = nullptr;
+    if (settings.rolloutCandidates > 0) {
+        rollout = new RolloutDispatcher(settings.rolloutHorizon, settings.rolloutCandidates, settings.rolloutThreads);
+        sim.getBank().setDispatcher(std::unique_ptr<Dispatcher>(rollout));
+    }
+
+    std::unique_ptr<DestinationDispatcher> destinations;
+    if (settings.destinationWindow > 0.0 && !settings.script) {
+        destinations.reset(new DestinationDispatcher(settings.destinationWindow));
+    }
+
+    RunStats stats;
+    PassengerTraffic traffic(rng, !settings.script, floorCount, sim.getBank());
+    if (rollout) rollout->setPassengers(&traffic.population);
+    double simulated = settings.eventDriven
+        ? runEventDriven(sim, stream, settings.duration, traffic, destinations.get(), stats)
+        : runFixedStep(sim, stream, settings.duration, settings.dt, traffic, destinations.get(), stats);
+
+    const std::vector<Floor>& floors = sim.getFloors();
+    double floorSpacing = (floors.back().yTop - floors.front().yTop) / (floors.size() - 1);
+
+    result.seed = seed;
+    result.simulated = simulated;
+    result.traceCorrupt = replay && trace.isCorrupt();
+    result.ticks = stats.ticks;
+    result.events = stats.events;
+    result.hallCalls = stats.hallCalls;
+    result.carCalls = stats.carCalls;
+    result.doorCycles = stats.doorCycles;
+    result.travelFloors = stats.travel / floorSpacing;
+    result.travelKm = stats.travel / sim.getPixelsPerMetre() / 1000.0;
+
+    const PassengerPopulation& population = traffic.population;
+    result.passengers = population.size();
+    result.delivered = population.getArrivedCount();
+    result.peakHandling = population.getPeakHandling();
+    result.stats = population.getStats();
+    if (rollout) {
+        result.decisions = rollout->getDecisionCount();
+        result.decisionSeconds = rollout->getDecisionSeconds();
+    }
+    if (destinations) {
+        result.decisions = destinations->getBatchCount();
+        result.decisionSeconds = destinations->getBatchSeconds();
+    }
+
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+}
+
+void runReplicas(const ReplicaSettings& settings, unsigned firstSeed, int count, int threadCount,
+                 std::vector<ReplicaResult>& results) {
+    results.assign(count > 0 ? count : 0, ReplicaResult());
+    if (count <= 0) return;
+
+	// every job writes only its own slot of results
+    ThreadPool pool(std::min(threadCount > 0 ? threadCount : ThreadPool::hardwareThreads(), count));
+    for (int i = 0; i < count; ++i) {
+        ReplicaResult* slot = &results[i];
+        unsigned seed = firstSeed + (unsigned)i;
+        pool.submit([&settings, seed, slot] { runReplica(settings, seed, *slot); });
+    }
+    pool.wait();
+}
+
+void mergeResults(const std::vector<ReplicaResult>& results, StudySummary& summary) {
+    summary = StudySummary();
+    summary.replicas = (int)results.size();
+
+    bool firstMean = true;
+    for (const ReplicaResult& r : results) {
+        summary.simulated += r.simulated;
+        summary.ticks += r.ticks;
+        summary.events += r.events;
+        summary.hallCalls += r.hallCalls;
+        summary.carCalls += r.carCalls;
+        summary.doorCycles += r.doorCycles;
+        summary.travelFloors += r.travelFloors;
+        summary.travelKm += r.travelKm;
+        summary.passengers += r.passengers;
+        summary.delivered += r.delivered;
+        summary.peakHandling = std::max(summary.peakHandling, r.peakHandling);
+        summary.stats.merge(r.stats);
+        summary.decisions += r.decisions;
+        summary.decisionSeconds += r.decisionSeconds;
+        summary.traceCorrupt |= r.traceCorrupt;
+
+        if (r.stats.waitTime.getCount() == 0) continue;
+        double meanWait = r.stats.waitTime.getMean();
+        if (firstMean || meanWait < summary.minMeanWait) summary.minMeanWait = meanWait;
+        if (firstMean || meanWait > summary.maxMeanWait) summary.maxMeanWait = meanWait;
+        firstMean = false;
+    }
+}
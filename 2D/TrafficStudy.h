@@ -0,0 +1,99 @@
+#pragma once
+
+#include "BuildingConfig.h"
+#include "CallRegistry.h"
+#include "Statistics.h"
+#include "TrafficGenerator.h"
+#include "TraceFile.h"
+#include <random>
+#include <vector>
+
+// One call of a script or of generated traffic
+struct ScriptedCall {
+    double time;
+    bool hallCall;  // hall call (from a floor) or car call (from the panel)
+    int floor;
+    int car;        // car calls only
+	CallDirection direction; // hall calls: up/down button, Any if unknown
+};
+
+// Script file: one call per line, "<time_s> hall <floor> [up|down]" or "<time_s> car <floor> [car]",
+// '#' starts a comment. Calls must be sorted by time.
+bool loadScript(const char* path, int floorCount, std::vector<ScriptedCall>& calls);
+
+// Random hall calls with exponential inter-arrival times
+void generateHallCalls(std::vector<ScriptedCall>& calls, int floorCount, double duration,
+                       double callsPerHour, std::mt19937& rng);
+
+// How every replica of a study runs (read only while replicas run)
+struct ReplicaSettings {
+    BuildingConfig building;
+    SchedulingMode scheduling;
+	bool eventDriven;     // EventKernel instead of fixed steps
+	double dt;            // fixed step, seconds
+	double duration;      // simulated seconds per replica
+    double callsPerHour;
+	const std::vector<ScriptedCall>* script; // same calls in every replica, nullptr = random passengers
+	const TrafficProfile* profile;  // passengers from this profile instead of callsPerHour uniform calls
+	const char* trace;              // replay this trace file (TraceFile.h) instead of generated calls
+	int rolloutCandidates;   // > 0: RolloutDispatcher trying that many cars, 0: ETA dispatcher
+	float rolloutHorizon;    // seconds each rollout looks ahead
+	int rolloutThreads;      // worker threads per replica for the rollouts (1: inline)
+	double destinationWindow; // > 0: destination dispatch batching that many seconds, 0: up/down hall calls
+
+    ReplicaSettings();
+};
+
+// Counters and passenger timings of one replica
+struct ReplicaResult {
+    unsigned seed = 0;
+    double simulated = 0.0;
+    double wallSeconds = 0.0;
+    long long ticks = 0;
+    long long events = 0;
+    long long hallCalls = 0;
+    long long carCalls = 0;
+    long long doorCycles = 0;
+	double travelFloors = 0.0;  // summed car movement
+    double travelKm = 0.0;
+    int passengers = 0;
+    int delivered = 0;
+	int peakHandling = 0;          // most deliveries in one HANDLING_WINDOW
+    PassengerStats stats;
+	long long decisions = 0;       // rollout dispatches or destination batches
+    double decisionSeconds = 0.0;
+	bool traceCorrupt = false;     // the replayed trace ended early (TraceReader::isCorrupt)
+};
+
+// One independent run with its own Simulation, bank and random generator
+// (seeded with `seed`); nothing is shared with other replicas.
+void runReplica(const ReplicaSettings& settings, unsigned seed, ReplicaResult& result);
+
+// Run `count` replicas with seeds firstSeed, firstSeed + 1, ... on a thread
+// pool (threadCount <= 0: all hardware threads). results[i] belongs to seed firstSeed + i.
+void runReplicas(const ReplicaSettings& settings, unsigned firstSeed, int count, int threadCount,
+                 std::vector<ReplicaResult>& results);
+
+// All replicas merged
+struct StudySummary {
+    int replicas = 0;
+    double simulated = 0.0;
+    long long ticks = 0;
+    long long events = 0;
+    long long hallCalls = 0;
+    long long carCalls = 0;
+    long long doorCycles = 0;
+    double travelFloors = 0.0;
+    double travelKm = 0.0;
+    int passengers = 0;
+    int delivered = 0;
+	int peakHandling = 0;        // busiest replica
+	PassengerStats stats;        // histograms of every replica added up
+	double minMeanWait = 0.0;    // spread of the per-replica mean wait
+    double maxMeanWait = 0.0;
+    long long decisions = 0;
+    double decisionSeconds = 0.0;
+	bool traceCorrupt = false;   // in any replica
+};
+
+void mergeResults(const std::vector<ReplicaResult>& results, StudySummary& summary);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free hand-off of the newest value from one writer thread to one reader
+// thread. Three slots: the writer fills its own, publish() swaps it with the
+// shared middle slot, acquire() swaps the middle slot with the reader's when a
+// new value is there. Neither side ever waits; the reader may skip values.
+template <typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial = T())
+        : writeIndex(0), middle(1), readIndex(2) {
+        slots[0] = initial;
+        slots[1] = initial;
+        slots[2] = initial;
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Writer: the slot to fill next (holds an old value)
+    T& writeSlot() { return slots[writeIndex]; }
+
+	// Writer: make the filled slot the newest value
+    void publish() {
+        unsigned previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+	// Reader: take the newest value if one was published since the last call
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        unsigned previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+	// Reader: the value taken by the last acquire()
+    const T& read() const { return slots[readIndex]; }
+
+private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned FRESH = 4;
+
+    T slots[3];
+	unsigned writeIndex;           // writer only
+	std::atomic<unsigned> middle;  // slot index | FRESH
+	unsigned readIndex;            // reader only
+};
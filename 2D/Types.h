@@ -1,5 +1,6 @@
 #pragma once
 
+#include "CarCycle.h"
 #include <vector>
 
 // Vertex structure for rendering
@@ -8,46 +9,25 @@ struct Vertex {
     float u, v;  // texture coordinates
 };
 
-// Floor index
-enum FloorIndex {
-    FLOOR_SU = 0,
-    FLOOR_PR = 1,
-    FLOOR_1 = 2,
-    FLOOR_2 = 3,
-    FLOOR_3 = 4,
-    FLOOR_4 = 5,
-    FLOOR_5 = 6,
-    FLOOR_6 = 7
-};
-
 // Floor structure
 struct Floor {
 	float yBottom; // bottom edge of the platform
 	float yTop;    // upper edge of the platform
 };
 
-// Elevator state enumeration
-enum class ElevatorState {
-    Idle,
-    Moving,
-    DoorsOpening,
-    DoorsOpen,
-    DoorsClosing,
-    Stopped
-};
-
 // Elevator structure
 struct Elevator {
 	float x;      // bottom left corner of the cabin
 	float y;      // bottom left corner of the cabin
     float width;
     float height;
-    int   currentFloor;   // index in [0..7]
+    int   currentFloor;   // floor index, 0 = lowest
 
     ElevatorState state;  
-	float speed;          // speed of elevator movement in pixels per second
+	float speed;          // current speed of the car in pixels per second
 	float doorOpenTimer;  // door opening/closing timer
     float doorOpenRatio; 
+	int   load;           // passengers inside (headless passenger model)
 };
 
 // Person structure
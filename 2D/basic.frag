@@ -1,20 +1,13 @@
 #version 330 core
 
 in vec2 TexCoord;
+in vec4 Color;
 out vec4 FragColor;
 
-uniform vec4 uColor;
+// plain colored sprites sample a white texture
 uniform sampler2D uTexture;
-uniform bool uUseTexture;
 
 void main()
 {
-    vec4 color = uColor;
-
-    if (uUseTexture)
-    {
-        color = texture(uTexture, TexCoord);
-    }
-
-    FragColor = color;
+    FragColor = texture(uTexture, TexCoord) * Color;
 }
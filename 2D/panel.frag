@@ -0,0 +1,50 @@
+#version 330 core
+
+in vec2 Pixel;
+flat in vec4 Rect;
+flat in vec4 IconUV;
+flat in vec2 IconSize;
+flat in uvec4 State;
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform vec2 uMouse;
+uniform int uHoverEnabled;  // the person is in a car
+
+const vec3 BORDER_COLOR = vec3(0.05, 0.05, 0.08);
+const vec3 NOT_SERVED_COLOR = vec3(0.3, 0.3, 0.33);
+
+// ButtonType order: Floor, OpenDoor, CloseDoor, Stop, Ventilation
+vec3 faceColor(uint type, bool pressed)
+{
+    if (type == 0u) return pressed ? vec3(0.85, 0.85, 0.95) : vec3(0.55, 0.55, 0.65);
+    if (type == 3u) return pressed ? vec3(0.95, 0.25, 0.25) : vec3(0.7, 0.2, 0.2);
+    if (type == 4u) return pressed ? vec3(0.35, 0.95, 0.35) : vec3(0.25, 0.6, 0.25);
+    return pressed ? vec3(0.8, 0.8, 0.5) : vec3(0.55, 0.55, 0.4);
+}
+
+bool inside(vec2 p, vec2 lo, vec2 hi)
+{
+    return all(greaterThanEqual(p, lo)) && all(lessThanEqual(p, hi));
+}
+
+void main()
+{
+    // floors the car doesn't stop at are greyed out and don't react
+    bool served = State.z != 0u;
+    vec3 face = served ? faceColor(State.x, State.y != 0u) : NOT_SERVED_COLOR;
+    if (uHoverEnabled != 0 && served && inside(uMouse, Rect.xy, Rect.zw)) {
+        face = min(face + vec3(0.1), vec3(1.0));
+    }
+
+    // icon centered on the face; sampled on every pixel so the mip level
+    // is right at its edges, used only inside it
+    vec2 halfSize = 0.5 * IconSize * (Rect.zw - Rect.xy);
+    vec2 iconLow = 0.5 * (Rect.xy + Rect.zw) - halfSize;
+    vec2 local = (Pixel - iconLow) / max(2.0 * halfSize, vec2(1e-4));
+    vec4 icon = texture(uTexture, mix(IconUV.xy, IconUV.zw, clamp(local, 0.0, 1.0)));
+    float iconAlpha = inside(local, vec2(0.0), vec2(1.0)) ? icon.a : 0.0;
+    vec3 color = mix(face, icon.rgb, iconAlpha);
+
+    FragColor = vec4(inside(Pixel, Rect.xy, Rect.zw) ? color : BORDER_COLOR, 1.0);
+}
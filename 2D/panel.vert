@@ -0,0 +1,29 @@
+#version 330 core
+
+// shared unit quad, (0, 0) .. (1, 1)
+layout (location = 0) in vec2 aCorner;
+// per button
+layout (location = 1) in vec4 aRect;      // face x0, y0, x1, y1 in pixels
+layout (location = 2) in vec4 aIconUV;    // icon u0, v0, u1, v1 in the atlas page
+layout (location = 3) in vec2 aIconSize;  // icon size as a part of the face, 0 without icon
+layout (location = 4) in uvec4 aState;    // type, pressed, served, unused
+
+uniform mat4 uProjection;
+uniform float uBorder;
+
+out vec2 Pixel;
+flat out vec4 Rect;
+flat out vec4 IconUV;
+flat out vec2 IconSize;
+flat out uvec4 State;
+
+void main()
+{
+    // the quad covers the face and its border
+    Pixel = mix(aRect.xy - vec2(uBorder), aRect.zw + vec2(uBorder), aCorner);
+    gl_Position = uProjection * vec4(Pixel, 0.0, 1.0);
+    Rect = aRect;
+    IconUV = aIconUV;
+    IconSize = aIconSize;
+    State = aState;
+}
@@ -0,0 +1,220 @@
+#include "BuildingConfig.h"
+#include "CallRegistry.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static const int DEFAULT_FLOOR_COUNT = 8;        // SU, PR, 1, 2, 3, 4, 5, 6
+static const float DEFAULT_STOREY_HEIGHT = 3.0f;
+
+BuildingConfig::BuildingConfig()
+    : floorCount(DEFAULT_FLOOR_COUNT),
+      storeyHeights(DEFAULT_FLOOR_COUNT - 1, DEFAULT_STOREY_HEIGHT),
+      carCount(4),
+      carSpeed(6.6585f),
+      carAccel(1.2f),
+      carJerk(2.0f),
+      doorAnimDuration(0.3f),
+      doorOpenTime(5.0f),
+      carCapacity(13),
+      boardTime(1.2f),
+      alightTime(1.0f),
+      minDwellTime(1.5f),
+      bypassLoad(0.8f),
+      startFloor(2),
+      lobbyFloor(1) {
+}
+
+float BuildingConfig::getFloorElevation(int floorIndex) const {
+    float y = 0.0f;
+    for (int i = 0; i < floorIndex && i < (int)storeyHeights.size(); ++i) {
+        y += storeyHeights[i];
+    }
+    return y;
+}
+
+float BuildingConfig::getMinStoreyHeight() const {
+    float h = storeyHeights.empty() ? DEFAULT_STOREY_HEIGHT : storeyHeights[0];
+    for (float s : storeyHeights) {
+        if (s < h) h = s;
+    }
+    return h;
+}
+
+std::string BuildingConfig::getFloorLabel(int floorIndex) const {
+    if (floorIndex == lobbyFloor) return "PR";
+    if (floorIndex < lobbyFloor) {
+        int depth = lobbyFloor - floorIndex;
+        return depth == 1 ? "SU" : "SU" + std::to_string(depth);
+    }
+    return std::to_string(floorIndex - lobbyFloor);
+}
+
+// Zone of a car, nullptr for the cars after the last zone
+static const CarZone* zoneOf(const BuildingConfig& config, int carIndex) {
+    int first = 0;
+    for (const CarZone& zone : config.zones) {
+        if (carIndex < first + zone.carCount) return &zone;
+        first += zone.carCount;
+    }
+    return nullptr;
+}
+
+bool BuildingConfig::servesFloor(int carIndex, int floorIndex) const {
+    const CarZone* zone = zoneOf(*this, carIndex);
+    if (!zone || floorIndex == lobbyFloor) return true;
+    return floorIndex >= zone->lowest && floorIndex <= zone->highest;
+}
+
+float BuildingConfig::getCarSpeed(int carIndex) const {
+    const CarZone* zone = zoneOf(*this, carIndex);
+    return (zone && zone->carSpeed > 0.0f) ? zone->carSpeed : carSpeed;
+}
+
+int BuildingConfig::firstUnservedFloor() const {
+    for (int f = 0; f < floorCount; ++f) {
+        bool served = false;
+        for (int c = 0; c < carCount && !served; ++c) {
+            served = servesFloor(c, f);
+        }
+        if (!served) return f;
+    }
+    return -1;
+}
+
+static bool badValue(int lineNumber, const std::string& line) {
+    std::cerr << "Bad building config line " << lineNumber << ": " << line << std::endl;
+    return false;
+}
+
+bool loadBuildingConfig(const char* path, BuildingConfig& config) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open building config: " << path << std::endl;
+        return false;
+    }
+
+    BuildingConfig loaded = config;
+    loaded.zones.clear();
+    float floorHeight = loaded.storeyHeights.empty() ? DEFAULT_STOREY_HEIGHT : loaded.storeyHeights[0];
+    std::vector<float> storeyHeights;
+    bool uniformHeight = false;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        size_t eq = line.find('=');
+        std::istringstream keyStream(line.substr(0, eq));
+        std::string key;
+        if (!(keyStream >> key)) continue; // empty line
+        if (eq == std::string::npos) return badValue(lineNumber, line);
+
+        std::istringstream ss(line.substr(eq + 1));
+        bool ok;
+        if (key == "floors") ok = (bool)(ss >> loaded.floorCount);
+        else if (key == "floor_height") {
+            ok = (bool)(ss >> floorHeight);
+            uniformHeight = true;
+        }
+        else if (key == "storey_heights") {
+            storeyHeights.clear();
+            float h;
+            while (ss >> h) storeyHeights.push_back(h);
+            ok = !storeyHeights.empty() && ss.eof();
+        }
+        else if (key == "cars") ok = (bool)(ss >> loaded.carCount);
+        else if (key == "car_speed") ok = (bool)(ss >> loaded.carSpeed);
+        else if (key == "car_accel") ok = (bool)(ss >> loaded.carAccel);
+        else if (key == "car_jerk") ok = (bool)(ss >> loaded.carJerk);
+        else if (key == "door_anim_time") ok = (bool)(ss >> loaded.doorAnimDuration);
+        else if (key == "door_open_time") ok = (bool)(ss >> loaded.doorOpenTime);
+        else if (key == "car_capacity") ok = (bool)(ss >> loaded.carCapacity);
+        else if (key == "board_time") ok = (bool)(ss >> loaded.boardTime);
+        else if (key == "alight_time") ok = (bool)(ss >> loaded.alightTime);
+        else if (key == "min_dwell_time") ok = (bool)(ss >> loaded.minDwellTime);
+        else if (key == "bypass_load") ok = (bool)(ss >> loaded.bypassLoad);
+        else if (key == "start_floor") ok = (bool)(ss >> loaded.startFloor);
+        else if (key == "lobby_floor") ok = (bool)(ss >> loaded.lobbyFloor);
+        else if (key == "zone") {
+            CarZone zone = { 0, 0, 0, 0.0f };
+            ok = (bool)(ss >> zone.carCount >> zone.lowest >> zone.highest);
+            if (ok && !(ss >> zone.carSpeed)) zone.carSpeed = 0.0f;
+            ok = ok && zone.carCount > 0 && zone.lowest <= zone.highest && zone.carSpeed >= 0.0f;
+            if (ok) loaded.zones.push_back(zone);
+        }
+        else {
+            std::cerr << "Unknown building config key on line " << lineNumber << ": " << key << std::endl;
+            return false;
+        }
+        if (!ok) return badValue(lineNumber, line);
+    }
+
+    if (loaded.floorCount < 2 || loaded.floorCount > CallRegistry::MAX_FLOORS) {
+        std::cerr << "floors must be between 2 and " << CallRegistry::MAX_FLOORS << std::endl;
+        return false;
+    }
+    if (storeyHeights.size() > (size_t)loaded.floorCount - 1) {
+        std::cerr << "storey_heights has more values than the building has storeys" << std::endl;
+        return false;
+    }
+
+	// storeys not listed in storey_heights get floor_height
+    if (uniformHeight || loaded.storeyHeights.size() != (size_t)loaded.floorCount - 1) {
+        loaded.storeyHeights.assign(loaded.floorCount - 1, floorHeight);
+    }
+    for (size_t i = 0; i < storeyHeights.size(); ++i) {
+        loaded.storeyHeights[i] = storeyHeights[i];
+    }
+    for (float h : loaded.storeyHeights) {
+        if (h <= 0.0f) {
+            std::cerr << "Floor heights must be positive" << std::endl;
+            return false;
+        }
+    }
+
+    if (loaded.carCount < 1 || loaded.carSpeed <= 0.0f || loaded.doorAnimDuration <= 0.0f || loaded.doorOpenTime < 0.0f) {
+        std::cerr << "cars, car_speed and door_anim_time must be positive, door_open_time not negative" << std::endl;
+        return false;
+    }
+    if (loaded.carAccel < 0.0f || loaded.carJerk < 0.0f) {
+        std::cerr << "car_accel and car_jerk must not be negative" << std::endl;
+        return false;
+    }
+    if (loaded.carCapacity < 1 || loaded.boardTime < 0.0f || loaded.alightTime < 0.0f || loaded.minDwellTime <= 0.0f) {
+        std::cerr << "car_capacity and min_dwell_time must be positive, board_time and alight_time not negative" << std::endl;
+        return false;
+    }
+    if (loaded.bypassLoad <= 0.0f || loaded.bypassLoad > 1.0f) {
+        std::cerr << "bypass_load must be in (0, 1]" << std::endl;
+        return false;
+    }
+    if (loaded.startFloor < 0 || loaded.startFloor >= loaded.floorCount ||
+        loaded.lobbyFloor < 0 || loaded.lobbyFloor >= loaded.floorCount) {
+        std::cerr << "start_floor and lobby_floor must be floors of the building" << std::endl;
+        return false;
+    }
+    int zonedCars = 0;
+    for (const CarZone& zone : loaded.zones) {
+        if (zone.lowest < 0 || zone.highest >= loaded.floorCount) {
+            std::cerr << "zone floors must be floors of the building" << std::endl;
+            return false;
+        }
+        zonedCars += zone.carCount;
+    }
+    if (zonedCars > loaded.carCount) {
+        std::cerr << "zones have " << zonedCars << " cars, the building " << loaded.carCount << std::endl;
+        return false;
+    }
+    int unserved = loaded.firstUnservedFloor();
+    if (unserved >= 0) {
+        std::cerr << "No car serves floor " << unserved << std::endl;
+        return false;
+    }
+
+    config = loaded;
+    return true;
+}
@@ -0,0 +1,18 @@
+#include "CarCycle.h"
+
+DoorEvent stepDoors(ElevatorState& state, float& ratio, float& timer, float dt, float animDuration, float openTime) {
+    switch (state) {
+    case ElevatorState::DoorsOpening:
+        ratio += dt / animDuration;
+        break;
+    case ElevatorState::DoorsOpen:
+        timer -= dt;
+        break;
+    case ElevatorState::DoorsClosing:
+        ratio -= dt / animDuration;
+        break;
+    default:
+        return DoorEvent::None;
+    }
+    return doorTransition(state, ratio, timer, openTime);
+}
@@ -1,22 +1,30 @@
 #include "Elevator.h"
 #include <cmath>
 
-static const float MOVE_SPEED = 2.0f;    // jedinica: world units / s
-static const float DOOR_SPEED = 1.8f;    // koliko brzo doorOpen ide ka 0/1 (1/s)
-static const float DOOR_OPEN_TIME = 5.0f;
-
-Elevator::Elevator(int numFloors_, float floorHeight, int startFloorIdx)
-    : numFloors(numFloors_), floorH(floorHeight),
+Elevator::Elevator(const std::vector<float>& floorY_, int startFloorIdx,
+                   const MotionLimits& limits_, float doorAnimTime, float doorOpenTime_)
+    : numFloors((int)floorY_.size()), floorY(floorY_),
+    limits(limits_),
+    motionTime(0.0f),
+    moveStartY(0.0f),
+    moveDir(1.0f),
+    doorSpeed(1.0f / doorAnimTime),
+    doorOpenTime(doorOpenTime_),
     state(ElevatorState::Idle),
-    currentFloor(clampi(startFloorIdx, 0, numFloors_ - 1)),
+    currentFloor(clampi(startFloorIdx, 0, (int)floorY_.size() - 1)),
     targetFloor(currentFloor),
-    cabinBaseY(currentFloor* floorH),
+    travelDir(0),
+    stopDir(CallDirection::Any),
+    scheduling(SchedulingMode::Fifo),
+    cabinBaseY(floorY_[currentFloor]),
     doorOpen(0.0f),
     doorTimer(0.0f),
     doorExtendedThisCycle(false),
     ventOn(false),
     ventAutoOffFloor(currentFloor)
 {
+    moveStartY = cabinBaseY;
+    for (uint64_t& word : served.words) word = ~0ull;
 }
 
 int Elevator::clampi(int v, int lo, int hi) {
@@ -25,30 +33,55 @@ int Elevator::clampi(int v, int lo, int hi) {
     return v;
 }
 
-bool Elevator::containsInQueue(int floorIdx) const {
-    for (int f : queue) if (f == floorIdx) return true;
-    return false;
-}
-
 bool Elevator::IsExactlyAtFloor(int floorIdx) const {
-    float y = floorIdx * floorH;
+    if (floorIdx < 0 || floorIdx >= numFloors) return false;
+    float y = floorY[floorIdx];
     return std::fabs(cabinBaseY - y) < 0.001f;
 }
 
 void Elevator::RequestFloor(int floorIdx) {
+    registerCall(floorIdx, false, CallDirection::Any);
+}
+
+void Elevator::CallToFloor(int floorIdx, CallDirection dir) {
+    registerCall(floorIdx, true, dir);
+}
+
+CallDirection Elevator::LeavingDirection() const {
+    if (scheduling == SchedulingMode::Fifo) return CallDirection::Any;
+    if (stopDir != CallDirection::Any) return stopDir;
+
+    // nije najavljen: smer sledeceg LOOK stajanja, ako ga ima
+    int dir = travelDir;
+    int next = calls.nextLookStop(currentFloor, dir);
+    if (next < 0) return CallDirection::Any;
+    return next > currentFloor ? CallDirection::Up : CallDirection::Down;
+}
+
+void Elevator::registerCall(int floorIdx, bool hallCall, CallDirection dir) {
     floorIdx = clampi(floorIdx, 0, numFloors - 1);
+    if (!served.test(floorIdx)) return; // van zone: lift tu ne staje
 
-    // ako je vec target ili vec u redu - ignorisi
-    if (floorIdx == targetFloor && (state == ElevatorState::Moving || state == ElevatorState::Stopped)) return;
-    if (containsInQueue(floorIdx)) return;
+    // LOOK kabina koja sa ovog sprata krece na drugu stranu ne otvara za poziv, vraca se po njega
+    CallDirection leaving = LeavingDirection();
+    bool otherWay = hallCall && dir != CallDirection::Any && leaving != CallDirection::Any && leaving != dir;
 
     // ako smo idle i vec smo na tom spratu i vrata zatvorena - samo otvori
-    if (state == ElevatorState::Idle && floorIdx == currentFloor && doorOpen <= 0.0f) {
+    if (state == ElevatorState::Idle && floorIdx == currentFloor && doorOpen <= 0.0f && !otherWay) {
+        if (hallCall && scheduling == SchedulingMode::Look) stopDir = dir;
         state = ElevatorState::DoorsOpening;
         return;
     }
 
-    queue.push_back(floorIdx);
+    // ako je vec target ili vec registrovan - registry ga ne dodaje ponovo
+    bool added = hallCall ? calls.addHallCall(floorIdx, dir) : calls.addCarCall(floorIdx);
+    if (!added) return;
+
+    // LOOK: novi sprat izmedju kabine i cilja -> staje usput
+    if (scheduling == SchedulingMode::Look &&
+        (state == ElevatorState::Moving || state == ElevatorState::Stopped)) {
+        retargetAhead();
+    }
 
     // ako trenutno miruje sa zatvorenim vratima -> odmah kreni
     if (state == ElevatorState::Idle && doorOpen <= 0.0f) {
@@ -56,9 +89,6 @@ void Elevator::RequestFloor(int floorIdx) {
     }
 }
 
-void Elevator::CallToFloor(int floorIdx) {
-    RequestFloor(floorIdx);
-}
 void Elevator::PressOpen() {
     // Ne otvaramo vrata dok se lift krece (ili je stopiran usred kretanja)
     if (state == ElevatorState::Moving || state == ElevatorState::Stopped) {
@@ -80,7 +110,7 @@ void Elevator::PressOpen() {
 
     // Ako su vec otvorena -> PRODUZI +5s, ali samo jednom po ciklusu
     if (state == ElevatorState::DoorsOpen && !doorExtendedThisCycle) {
-        doorTimer += DOOR_OPEN_TIME;     // +5 sekundi
+        doorTimer += doorOpenTime;       // +5 sekundi
         doorExtendedThisCycle = true;    // maksimalno jednom po ciklusu
         return;
     }
@@ -99,8 +129,9 @@ void Elevator::PressClose() {
 }
 
 void Elevator::PressStopToggle() {
+    // STOP koci odmah; nastavak je nova voznja od mesta gde je stao
     if (state == ElevatorState::Moving) state = ElevatorState::Stopped;
-    else if (state == ElevatorState::Stopped) state = ElevatorState::Moving;
+    else if (state == ElevatorState::Stopped) startMove();
 }
 
 void Elevator::ToggleVent() {
@@ -110,38 +141,124 @@ void Elevator::ToggleVent() {
         if (state == ElevatorState::Moving || state == ElevatorState::Stopped) {
             ventAutoOffFloor = targetFloor;
         }
-        else if (!queue.empty()) {
-            ventAutoOffFloor = queue.front();
-        }
         else {
-            ventAutoOffFloor = currentFloor;
+            int queued[CallRegistry::MAX_FLOORS];
+            ventAutoOffFloor = (calls.getQueued(queued) > 0) ? queued[0] : currentFloor;
         }
     }
 }
 
+void Elevator::SetScheduling(SchedulingMode mode) {
+    scheduling = mode;
+    if (scheduling == SchedulingMode::Look &&
+        (state == ElevatorState::Moving || state == ElevatorState::Stopped)) {
+        retargetAhead();
+    }
+}
+
+void Elevator::startMove() {
+    float targetY = floorY[targetFloor];
+    moveStartY = cabinBaseY;
+    moveDir = (targetY > cabinBaseY) ? 1.0f : -1.0f;
+    motion.plan(std::fabs(targetY - cabinBaseY), limits);
+    motionTime = 0.0f;
+    state = ElevatorState::Moving;
+    stopDir = CallDirection::Any;
+}
+
+bool Elevator::retargetMotion(int floorIdx) {
+    if (state == ElevatorState::Stopped) {
+        // stoji; nastavak ionako planira novu voznju, dovoljno je da sprat nije prodjen
+        return (floorY[floorIdx] - cabinBaseY) * moveDir >= 0.0f;
+    }
+    float runDistance = (floorY[floorIdx] - moveStartY) * moveDir;
+    return runDistance >= 0.0f && motion.retarget(motionTime, runDistance, limits);
+}
+
+void Elevator::retargetAhead() {
+    bool up = travelDir > 0;
+
+    // prvi LOOK sprat za koji kabina jos stigne da zakoci (prodjeni otpadaju)
+    int candidate = calls.nextInDirection(currentFloor, up);
+    while (candidate >= 0 && candidate != targetFloor && !retargetMotion(candidate)) {
+        candidate = calls.nextInDirection(candidate, up);
+    }
+
+    if (candidate >= 0 && (up ? candidate < targetFloor : candidate > targetFloor)) {
+        targetFloor = candidate;
+    }
+}
+
 void Elevator::startNextMoveIfAny() {
-    while (!queue.empty() && queue.front() == currentFloor) {
-        queue.pop_front();
-        // ako je neko kliknuo "sprat na kom smo" -> samo otvori vrata
-        state = ElevatorState::DoorsOpening;
-        return;
+    int next;
+    CallDirection here = CallDirection::Any; // kako se opsluzuje sprat na kom vec stojimo
+    if (scheduling == SchedulingMode::Look) {
+        // LOOK: isti smer dok ima poziva ispred, pa okret; najavljeni smer stajanja ima prednost
+        int dir = travelDir;
+        if (stopDir != CallDirection::Any) dir = (stopDir == CallDirection::Up) ? 1 : -1;
+        CallDirection leaving = (dir > 0) ? CallDirection::Up : (dir < 0) ? CallDirection::Down : CallDirection::Any;
+
+        // poziv iz kabine ili poziv u smeru polaska na ovom spratu: otvori ponovo
+        bool servedHere = calls.hasCarCall(currentFloor) ||
+            (leaving == CallDirection::Any ? calls.isRequested(currentFloor) : calls.hasHallCall(currentFloor, leaving));
+        if (servedHere) {
+            next = currentFloor;
+            here = leaving;
+        }
+        else {
+            next = calls.nextLookStop(currentFloor, dir);
+            travelDir = dir;
+            // nista drugo: poziv za suprotan smer koji je ostao na ovom spratu dolazi na red sada
+            if (next < 0 && calls.isRequested(currentFloor)) next = currentFloor;
+        }
+    }
+    else {
+        next = calls.takeOldest();
+        if (next < 0 && !calls.empty()) {
+            // pozivi primljeni dok je radio LOOK nisu u FIFO redu
+            int dir = 0;
+            next = calls.nextLookStop(currentFloor, dir);
+        }
     }
 
-    if (queue.empty()) {
+    if (next < 0) {
+        travelDir = 0;
+        stopDir = CallDirection::Any;
         state = ElevatorState::Idle;
         return;
     }
 
-    targetFloor = queue.front();
-    state = ElevatorState::Moving;
+    if (next == currentFloor) {
+        stopDir = here;
+        calls.clearStop(next, here);
+        // ako je neko kliknuo "sprat na kom smo" -> samo otvori vrata
+        state = ElevatorState::DoorsOpening;
+        return;
+    }
+
+    targetFloor = next;
+    travelDir = (next > currentFloor) ? 1 : -1;
+    startMove();
 }
 
 void Elevator::arriveAtTarget() {
-    cabinBaseY = targetFloor * floorH;
+    cabinBaseY = floorY[targetFloor];
     currentFloor = targetFloor;
 
-    if (!queue.empty() && queue.front() == targetFloor) {
-        queue.pop_front();
+    if (scheduling == SchedulingMode::Look) {
+        // LOOK najavljuje smer stajanja: nastavlja ako neko ceka u smeru voznje,
+        // okrece se ako ceka samo suprotan smer a ispred nema nista; poziv za
+        // drugi smer ostaje za neki sledeci prolaz
+        bool up = travelDir > 0;
+        CallDirection along = up ? CallDirection::Up : CallDirection::Down;
+        CallDirection back = up ? CallDirection::Down : CallDirection::Up;
+        stopDir = CallDirection::Any;
+        if (calls.hasHallCall(currentFloor, along)) stopDir = along;
+        else if (calls.hasHallCall(currentFloor, back) && calls.nextInDirection(currentFloor, up) < 0) stopDir = back;
+        calls.clearStop(currentFloor, LeavingDirection());
+    }
+    else {
+        calls.clearFloor(targetFloor);
     }
 
     // ventilacija auto-off
@@ -159,50 +276,32 @@ void Elevator::Update(float dt) {
     switch (state) {
     case ElevatorState::Idle:
         // ako ima nesto u redu i vrata su zatvorena, kreni
-        if (doorOpen <= 0.0f && !queue.empty()) startNextMoveIfAny();
+        if (doorOpen <= 0.0f && !calls.empty()) startNextMoveIfAny();
         break;
 
-    case ElevatorState::Moving: {
-        float targetY = targetFloor * floorH;
-        float dir = (targetY > cabinBaseY) ? 1.0f : -1.0f;
-
-        cabinBaseY += dir * MOVE_SPEED * dt;
-
-        // overshoot check
-        if ((dir > 0.0f && cabinBaseY >= targetY) || (dir < 0.0f && cabinBaseY <= targetY)) {
+    case ElevatorState::Moving:
+        // polozaj direktno iz profila (ubrzanje, voznja, kocenje)
+        motionTime += dt;
+        if (motionTime >= motion.getDuration()) {
             arriveAtTarget();
         }
+        else {
+            cabinBaseY = moveStartY + moveDir * motion.positionAt(motionTime);
+        }
         break;
-    }
 
     case ElevatorState::Stopped:
         // ne radimo nista - ceka STOP ponovo
         break;
 
     case ElevatorState::DoorsOpening:
-        doorOpen += DOOR_SPEED * dt;
-        if (doorOpen >= 1.0f) {
-            doorOpen = 1.0f;
-            doorTimer = DOOR_OPEN_TIME;
-            doorExtendedThisCycle = false;
-            state = ElevatorState::DoorsOpen;
-        }
-        break;
-
     case ElevatorState::DoorsOpen:
-        doorTimer -= dt;
-        if (doorTimer <= 0.0f) {
-            state = ElevatorState::DoorsClosing;
-        }
-        break;
-
-    case ElevatorState::DoorsClosing:
-        doorOpen -= DOOR_SPEED * dt;
-        if (doorOpen <= 0.0f) {
-            doorOpen = 0.0f;
-            state = ElevatorState::Idle;
-            startNextMoveIfAny();
-        }
+    case ElevatorState::DoorsClosing: {
+        // vrata: isti prelazi kao u 2D simulaciji (CarCycle.h)
+        DoorEvent event = stepDoors(state, doorOpen, doorTimer, dt, 1.0f / doorSpeed, doorOpenTime);
+        if (event == DoorEvent::Opened) doorExtendedThisCycle = false;
+        else if (event == DoorEvent::Closed) startNextMoveIfAny();
         break;
     }
+    }
 }
@@ -1,29 +1,34 @@
 ﻿#pragma once
-#include <deque>
-
-enum class ElevatorState {
-    Idle,
-    Moving,
-    DoorsOpening,
-    DoorsOpen,
-    DoorsClosing,
-    Stopped
-};
+#include "CallRegistry.h"
+#include "CarCycle.h"
+#include "MotionProfile.h"
+#include <vector>
 
 class Elevator {
 public:
-    Elevator(int numFloors, float floorHeight, int startFloorIdx);
+    // floorY: visina poda svakog sprata (rastuce), ogranicenja kretanja u m i s, vremena u sekundama
+    Elevator(const std::vector<float>& floorY, int startFloorIdx,
+             const MotionLimits& limits, float doorAnimTime, float doorOpenTime);
 
     void Update(float dt);
 
-    void RequestFloor(int floorIdx);  // dodaj sprat u red (FIFO)
-    void CallToFloor(int floorIdx);   // isto kao RequestFloor za sada
+    void RequestFloor(int floorIdx);  // poziv iz kabine (FIFO redosled)
+    void CallToFloor(int floorIdx, CallDirection dir = CallDirection::Any); // poziv sa sprata (taster gore/dole)
 
     void PressOpen();        // produzi otvorena vrata +5s (samo jednom po ciklusu)
     void PressClose();       // odmah zatvori
     void PressStopToggle();  // pauza/resume dok se kreće
     void ToggleVent();       // ukljuci/iskljuci ventilaciju (auto-off na prvom target spratu)
 
+    void SetScheduling(SchedulingMode mode); // FIFO ili LOOK, moze u toku rada
+
+    // Spratovi na kojima lift staje (zona iz building.cfg); pozive za ostale odbija. Podrazumevano svi.
+    void SetServedFloors(const FloorMask& floors) { served = floors; }
+    bool ServesFloor(int floorIdx) const { return floorIdx >= 0 && floorIdx < numFloors && served.test(floorIdx); }
+    SchedulingMode Scheduling() const { return scheduling; }
+
+    int NumFloors() const { return numFloors; }
+    float FloorY(int floorIdx) const { return floorY[floorIdx]; }
     int CurrentFloor() const { return currentFloor; }
     float CabinBaseY() const { return cabinBaseY; }
     float DoorOpen() const { return doorOpen; }   // 0..1
@@ -31,20 +36,38 @@ public:
     ElevatorState State() const { return state; }
 
     bool IsExactlyAtFloor(int floorIdx) const; // kabina tacno na spratu (koristi se za spoljna vrata)
+    bool IsFloorRequested(int floorIdx) const { return calls.isRequested(floorIdx); }
+    const CallRegistry& Calls() const { return calls; }
+
+    // Smer u kom kabina napusta sprat na kom stoji (LOOK najavljuje smer na
+    // stajanju); Any kad ide bilo kuda ili nema dalje poziva (i uvek za FIFO)
+    CallDirection LeavingDirection() const;
 
 private:
     int numFloors;
-    float floorH;
+    std::vector<float> floorY;
+
+    MotionLimits limits;   // brzina, ubrzanje, trzaj (world units, s)
+    MotionProfile motion;  // trenutna voznja, vazi dok je Moving
+    float motionTime;      // sekunde od pocetka voznje
+    float moveStartY;      // odakle je voznja krenula
+    float moveDir;         // +1 gore, -1 dole
+    float doorSpeed;     // koliko brzo doorOpen ide ka 0/1 (1/s)
+    float doorOpenTime;
 
     ElevatorState state;
 
     int currentFloor;
     int targetFloor;
+    int travelDir;    // +1 gore, -1 dole, 0 nema cilja
+    CallDirection stopDir; // smer najavljen na ovom stajanju (LOOK), Any dok nije najavljen
+    SchedulingMode scheduling;
 
     float cabinBaseY; // donja ivica kabine (Y)
     float doorOpen;   // 0..1
 
-    std::deque<int> queue;
+    CallRegistry calls;  // registrovani pozivi (bit po spratu), ukljucujuci targetFloor dok se vozi
+    FloorMask served;    // spratovi na kojima staje
 
     // tajmeri / flagovi
     float doorTimer;            // koliko jos drzimo otvoreno
@@ -55,8 +78,11 @@ private:
     int ventAutoOffFloor; // na kom spratu se gasi
 
 private:
+    void registerCall(int floorIdx, bool hallCall, CallDirection dir);
     void startNextMoveIfAny();
+    void startMove();
+    bool retargetMotion(int floorIdx);
+    void retargetAhead();
     void arriveAtTarget();
-    bool containsInQueue(int floorIdx) const;
     static int clampi(int v, int lo, int hi);
 };
@@ -0,0 +1,148 @@
+#include "SimThread.h"
+#include <chrono>
+
+SimThread::SimThread(Elevator& elevator_, const TrafficProfile* profile)
+    : elevator(elevator_), running(false), trafficOn(false), trafficTime(0.0),
+      waiting(elevator_.NumFloors())
+{
+    if (profile) traffic.reset(new TrafficGenerator(*profile, (unsigned)std::chrono::steady_clock::now().time_since_epoch().count()));
+    publish(); // prozor ima stanje i pre prvog koraka
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&SimThread::run, this);
+}
+
+void SimThread::stop() {
+    running.store(false);
+    if (thread.joinable()) thread.join();
+}
+
+void SimThread::run() {
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SIM_TICK));
+    Clock::duration maxLag = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SIM_MAX_LAG));
+
+    Clock::time_point nextTick = Clock::now();
+    while (running.load()) {
+        std::this_thread::sleep_until(nextTick);
+
+        ElevatorCommand command;
+        while (commands.pop(command)) {
+            apply(command);
+        }
+        elevator.Update((float)SIM_TICK);
+        updateTraffic();
+        publish();
+
+        nextTick += tick;
+        Clock::time_point now = Clock::now();
+        if (now - nextTick > maxLag) nextTick = now;
+    }
+}
+
+void SimThread::apply(const ElevatorCommand& command) {
+    switch (command.type) {
+    case ElevatorCommandType::RequestFloor:
+        elevator.RequestFloor(command.floor);
+        break;
+    case ElevatorCommandType::CallToFloor:
+        elevator.CallToFloor(command.floor);
+        break;
+    case ElevatorCommandType::CallUp:
+        elevator.CallToFloor(command.floor, CallDirection::Up);
+        break;
+    case ElevatorCommandType::CallDown:
+        elevator.CallToFloor(command.floor, CallDirection::Down);
+        break;
+    case ElevatorCommandType::PanelFloor:
+        elevator.RequestFloor(command.floor);
+        // Ako biras DRUGI sprat, zatvori vrata odmah da krene bez cekanja
+        if (command.floor != elevator.CurrentFloor()) {
+            elevator.PressClose();   // radi samo ako su vrata otvorena/otvaraju se
+        }
+        break;
+    case ElevatorCommandType::Open:
+        elevator.PressOpen();
+        break;
+    case ElevatorCommandType::Close:
+        elevator.PressClose();
+        break;
+    case ElevatorCommandType::StopToggle:
+        elevator.PressStopToggle();
+        break;
+    case ElevatorCommandType::Vent:
+        elevator.ToggleVent();
+        break;
+    case ElevatorCommandType::ToggleScheduling: {
+        bool look = (elevator.Scheduling() == SchedulingMode::Fifo);
+        elevator.SetScheduling(look ? SchedulingMode::Look : SchedulingMode::Fifo);
+        break;
+    }
+    case ElevatorCommandType::ToggleTraffic:
+        trafficOn = traffic && !trafficOn;
+        break;
+    }
+}
+
+void SimThread::updateTraffic() {
+    if (!trafficOn) return;
+    trafficTime += SIM_TICK;
+
+    // novi putnici pozivaju lift sa svog sprata
+    while (traffic->peek().time <= trafficTime) {
+        TrafficArrival arrival = traffic->next();
+        // putnici sa sprata ili za sprat van zone idu drugim liftom
+        if (!elevator.ServesFloor(arrival.origin) || !elevator.ServesFloor(arrival.destination)) continue;
+        elevator.CallToFloor(arrival.origin, arrival.destination > arrival.origin ? CallDirection::Up : CallDirection::Down);
+        waiting[arrival.origin].push_back(arrival.destination);
+    }
+
+    // kad se vrata otvore na spratu, udju svi koji tu cekaju da idu u smeru kabine
+    // i biraju cilj; ostali cekaju da se vrati
+    if (elevator.State() != ElevatorState::DoorsOpen) return;
+    int floorIdx = elevator.CurrentFloor();
+    if (!elevator.IsExactlyAtFloor(floorIdx) || waiting[floorIdx].empty()) return;
+    std::vector<int>& here = waiting[floorIdx];
+    size_t kept = 0;
+    for (int destination : here) {
+        CallDirection leaving = elevator.LeavingDirection();
+        CallDirection wanted = destination > floorIdx ? CallDirection::Up : CallDirection::Down;
+        if (leaving == CallDirection::Any || leaving == wanted) {
+            elevator.RequestFloor(destination);
+        }
+        else {
+            // kabina se u medjuvremenu opredelila za drugi smer: poziv ponovo, za povratak
+            elevator.CallToFloor(floorIdx, wanted);
+            here[kept++] = destination;
+        }
+    }
+    here.resize(kept);
+}
+
+void SimThread::publish() {
+    ElevatorSnapshot& s = snapshots.writeSlot();
+    s.cabinBaseY = elevator.CabinBaseY();
+    s.doorOpen = elevator.DoorOpen();
+    s.currentFloor = elevator.CurrentFloor();
+    s.exactFloor = -1;
+    for (int i = 0; i < elevator.NumFloors(); ++i) {
+        if (elevator.IsExactlyAtFloor(i)) {
+            s.exactFloor = i;
+            break;
+        }
+    }
+    s.state = elevator.State();
+    s.ventOn = elevator.VentOn();
+    s.scheduling = elevator.Scheduling();
+    s.trafficOn = trafficOn;
+    s.carCalls = elevator.Calls().getCarCalls();
+    s.hallUp = elevator.Calls().getHallUp();
+    s.hallDown = elevator.Calls().getHallDown();
+    snapshots.publish();
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "Elevator.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+#include "TrafficGenerator.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Simulacija lifta ide svojim tempom, nezavisno od crtanja
+const double SIM_TICK_RATE = 240.0;
+const double SIM_TICK = 1.0 / SIM_TICK_RATE;
+const double SIM_MAX_LAG = 0.25;   // duzi zastoj (debugger, prevlacenje prozora) se ne nadoknadjuje
+
+// Komande iz prozora (tastatura, klik na panel) ka liftu
+enum class ElevatorCommandType {
+    RequestFloor,     // poziv iz kabine
+    CallToFloor,      // poziv sa sprata, bez smera
+    CallUp,           // taster gore pored vrata lifta
+    CallDown,         // taster dole pored vrata lifta
+    PanelFloor,       // taster sprata na panelu: poziv + zatvori vrata ako je drugi sprat
+    Open,
+    Close,
+    StopToggle,
+    Vent,
+    ToggleScheduling, // FIFO <-> LOOK
+    ToggleTraffic     // generisani putnici ukljuceni/iskljuceni
+};
+
+struct ElevatorCommand {
+    ElevatorCommandType type;
+    int floor;   // samo za pozive
+};
+
+// Stanje lifta posle jednog koraka: samo ono sto crtanje, kamera i panel citaju
+struct ElevatorSnapshot {
+    float cabinBaseY;
+    float doorOpen;      // 0..1
+    int currentFloor;
+    int exactFloor;      // sprat na kom kabina tacno stoji, -1 izmedju spratova
+    ElevatorState state;
+    bool ventOn;
+    SchedulingMode scheduling;
+    bool trafficOn;      // generisani putnici ukljuceni (T)
+    FloorMask carCalls;  // upaljeni tasteri spratova
+    FloorMask hallUp;    // upaljeni pozivni tasteri u hodnicima
+    FloorMask hallDown;
+
+    bool IsExactlyAtFloor(int floorIdx) const { return floorIdx == exactFloor; }
+};
+
+// Vrti Elevator::Update na svojoj niti sa SIM_TICK korakom. Komande stizu kroz
+// lock-free red, stanje izlazi kroz trostruki bafer, pa spor frejm ne koci
+// simulaciju niti korak simulacije koci frejm. Dok nit radi, lift pripada njoj.
+class SimThread {
+public:
+    // traffic: profil generisanih putnika (nullptr = samo rucni pozivi), iskljucen dok ga ne ukljuci ToggleTraffic
+    explicit SimThread(Elevator& elevator, const TrafficProfile* traffic = nullptr);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    void start();
+    void stop();
+
+    // Nit prozora: posalji komandu; false ako je red pun (komanda se gubi)
+    bool post(ElevatorCommandType type, int floor = -1) { return commands.push({ type, floor }); }
+
+    // Nit prozora: najnovije objavljeno stanje, vazi do sledeceg poziva
+    const ElevatorSnapshot& latest() {
+        snapshots.acquire();
+        return snapshots.read();
+    }
+
+private:
+    Elevator& elevator;
+    SpscQueue<ElevatorCommand, 64> commands;
+    TripleBuffer<ElevatorSnapshot> snapshots;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    // Generisani putnici: dolazak na sprat je CallToFloor u smeru cilja, ulazak u kabinu RequestFloor cilja
+    std::unique_ptr<TrafficGenerator> traffic;
+    bool trafficOn;
+    double trafficTime;                       // sekunde saobracaja, stoji dok je iskljucen
+    std::vector<std::vector<int>> waiting;    // po spratu: ciljevi putnika koji cekaju
+
+    void run();
+    void updateTraffic();
+    void apply(const ElevatorCommand& command);
+    void publish();
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Where a packed image lies: the page texture and the image's corners in
+// texture coordinates (v up, images are flipped on load like loadImageToTexture)
+struct AtlasRegion {
+    unsigned int texture;  // 0 if the image is unknown or didn't load
+    float u0, v0, u1, v1;
+};
+
+// Packs many small images into a few large textures (pages) at startup, so a
+// frame binds one or two textures instead of one per image. Images are placed
+// on shelves, tallest first. Each one starts on a multiple of ALIGN texels and
+// is surrounded by PADDING texels copied from its own edge, so neither
+// bilinear filtering nor the first MIP_LEVELS mip levels ever blend in a
+// neighbour. Images larger than maxImageSize are halved on load; they are
+// drawn far smaller than that anyway.
+class TextureAtlas {
+public:
+    static const int ALIGN = 8;
+    static const int PADDING = 8;
+    static const int MIP_LEVELS = 3;
+
+    TextureAtlas();
+
+    // Queue a file under a name (the lookup key); nothing is read before build
+    void add(const std::string& name, const std::string& path);
+    // Queue an image from memory (width x height RGBA, bottom row first)
+    void addPixels(const std::string& name, int width, int height, const unsigned char* rgba);
+
+    // Load, pack and upload everything queued (needs a current context), once.
+    // Pages are at most pageSize texels square. Returns the number of pages.
+    int build(int pageSize = 2048, int maxImageSize = 1024);
+
+    // Region of an image by name; texture 0 when it is unknown or failed to load
+    const AtlasRegion& get(const std::string& name) const;
+    bool has(const std::string& name) const;
+
+    int getPageCount() const { return (int)pages.size(); }
+
+private:
+    struct Image {
+        std::string name;
+        std::string path;  // empty for addPixels
+        int width, height;
+        std::vector<unsigned char> pixels;
+        int page, x, y;    // placement, x/y of the padded cell
+    };
+
+    std::vector<Image> images;
+    std::vector<unsigned int> pages;
+    std::unordered_map<std::string, AtlasRegion> regions;
+};
@@ -10,6 +10,8 @@ uniform mat4 uP;
 
 // koliko puta se ponavlja tekstura po U i V
 uniform vec2 uTexScale;
+// pocetak podoblasti u atlasu (0,0 za obicnu teksturu)
+uniform vec2 uTexOffset;
 
 out vec4 channelCol;
 out vec2 channelTex;
@@ -17,5 +19,5 @@ out vec2 channelTex;
 void main() {
     gl_Position = uP * uV * uM * vec4(inPos, 1.0);
     channelCol = inCol;
-    channelTex = inTex * uTexScale;
+    channelTex = uTexOffset + inTex * uTexScale;
 }
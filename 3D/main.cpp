@@ -1,5 +1,7 @@
-﻿#include <iostream>
+﻿#include <fstream>
+#include <iostream>
 #include <string>
+#include <vector>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -12,14 +14,17 @@
 #include "Camera.h"
 
 #include "Elevator.h"
+#include "BuildingConfig.h"
+#include "SimThread.h"
+#include "TextureAtlas.h"
 #include <cmath>
 #include <algorithm>
 
 static bool gInElevator = false;
 static int gHoverBtn = -1;   // koje dugme panel-a "gađaš" pogledom (centar ekrana)
+static int gHoverHall = 0;   // pozivni taster u hodniku pod pogledom: +1 gore, -1 dole, 0 nijedan
 
 // Dimenzije kabine lifta
-static const int ELEV_START_FLOOR_IDX = 2; // početak: sprat "1" (SU=0, PR=1, 1=2)
 static const float CABIN_W = 2.4f;
 static const float CABIN_H = 2.2f;
 static const float CABIN_D = 2.8f;
@@ -29,6 +34,14 @@ static const float DOOR_THICK = 0.06f;
 static const float PORTAL_W = 2.4f;
 static const float PORTAL_H = 2.2f;
 
+// Pozivni tasteri gore/dole na stubu pored otvora (strana -Z), visine od poda sprata
+static const float HALL_BTN_SIZE = 0.12f;
+static const float HALL_BTN_THICK = 0.03f;
+static const float HALL_BTN_Z = -(PORTAL_W * 0.5f + 0.3f);
+static const float HALL_BTN_UP_Y = 1.20f;
+static const float HALL_BTN_DOWN_Y = 1.00f;
+static const float HALL_BTN_REACH = 2.5f;   // dokle se taster "dohvata" pogledom
+
 // Vrata na zidu sprata (to su "spoljna" vrata lifta)
 static const float HALL_DOOR_THICK = 0.08f;
 
@@ -43,49 +56,80 @@ static const float PANEL_THICK = 0.03f;
 
 static const float BTN_THICK = 0.03f;
 
-static bool gBtnLit[12] = { false }; // da svetle tasteri dok se ne stigne do sprata
-
-
+// id dugmeta: spratovi su 0..brojSpratova-1, kontrole su iza najveceg moguceg sprata
 enum PanelBtnId {
-    BTN_F0 = 0, BTN_F1, BTN_F2, BTN_F3, BTN_F4, BTN_F5, BTN_F6, BTN_F7, // spratovi 0..7
-    BTN_OPEN = 8,
-    BTN_CLOSE = 9,
-    BTN_STOP = 10,
-    BTN_VENT = 11
+    BTN_OPEN = CallRegistry::MAX_FLOORS,
+    BTN_CLOSE,
+    BTN_STOP,
+    BTN_VENT
 };
 
 struct PanelBtn {
     int id;
     float cx, cy;  // lokalno na panelu (x,y)
     float w, h;
+    AtlasRegion icon;  // ikonica iz atlasa (texture 0 = bez ikonice)
 };
 
-// Raspored:
-//  Row0: SU, PR
-//  Row1: 1, 2
-//  Row2: 3, 4
-//  Row3: 5, 6
-//  Row4: OPEN, CLOSE
-//  Row5: STOP, VENT
-static const PanelBtn gPanelBtns[] = {
-    { BTN_F0, -0.14f, +0.50f, 0.22f, 0.12f },
-    { BTN_F1, +0.14f, +0.50f, 0.22f, 0.12f },
+// Raspored (pravi ga buildPanelButtons):
+//  spratovi u mrezi, najnizi gore (SU, PR / 1, 2 / 3, 4 / 5, 6 za 8 spratova)
+//  ispod: OPEN, CLOSE
+//         STOP, VENT
+static std::vector<PanelBtn> gPanelBtns;
 
-    { BTN_F2, -0.14f, +0.32f, 0.22f, 0.12f },
-    { BTN_F3, +0.14f, +0.32f, 0.22f, 0.12f },
-
-    { BTN_F4, -0.14f, +0.14f, 0.22f, 0.12f },
-    { BTN_F5, +0.14f, +0.14f, 0.22f, 0.12f },
+static bool isFloorButton(int id) {
+    return id >= 0 && id < BTN_OPEN;
+}
 
-    { BTN_F6, -0.14f, -0.04f, 0.22f, 0.12f },
-    { BTN_F7, +0.14f, -0.04f, 0.22f, 0.12f },
+static void buildPanelButtons(const std::vector<AtlasRegion>& floorIcons, const AtlasRegion controlIcons[4]) {
+    const float cellW = 0.28f;       // razmak kolona
+    const float cellH = 0.18f;       // razmak redova
+    const float gridW = 2.0f * cellW;
+    const float gridH = 4.0f * cellH;
+    const float gridTop = 0.59f;
+
+    // 2 kolone x 4 reda za 8 spratova; za vise spratova vise kolona i manja dugmad
+    int numFloors = (int)floorIcons.size();
+    int cols = 2;
+    float scale = 1.0f;
+    for (bool fits = false; !fits && scale > 0.05f;) {
+        int maxCols = (int)(gridW / (cellW * scale) + 0.001f);
+        for (cols = 2; cols <= maxCols || cols == 2; ++cols) {
+            int rows = (numFloors + cols - 1) / cols;
+            if (rows * cellH * scale <= gridH + 0.001f) {
+                fits = true;
+                break;
+            }
+        }
+        if (!fits) scale *= 0.95f;
+    }
 
-    { BTN_OPEN,  -0.14f, -0.22f, 0.22f, 0.12f },
-    { BTN_CLOSE, +0.14f, -0.22f, 0.22f, 0.12f },
+    gPanelBtns.clear();
+    for (int f = 0; f < numFloors; ++f) {
+        int row = f / cols;
+        int col = f % cols;
+        PanelBtn b;
+        b.id = f;
+        b.cx = (col - 0.5f * (cols - 1)) * cellW * scale;
+        b.cy = gridTop - (row + 0.5f) * cellH * scale;
+        b.w = 0.22f * scale;
+        b.h = 0.12f * scale;
+        b.icon = floorIcons[f];
+        gPanelBtns.push_back(b);
+    }
 
-    { BTN_STOP,  -0.14f, -0.40f, 0.22f, 0.12f },
-    { BTN_VENT,  +0.14f, -0.40f, 0.22f, 0.12f },
-};
+    const int controlIds[4] = { BTN_OPEN, BTN_CLOSE, BTN_STOP, BTN_VENT };
+    for (int i = 0; i < 4; ++i) {
+        PanelBtn b;
+        b.id = controlIds[i];
+        b.cx = (i % 2 == 0) ? -0.14f : +0.14f;
+        b.cy = (i < 2) ? -0.22f : -0.40f;
+        b.w = 0.22f;
+        b.h = 0.12f;
+        b.icon = controlIcons[i];
+        gPanelBtns.push_back(b);
+    }
+}
 
 // -------------------- Globalno za mouse callback --------------------
 static Camera* gCamera = nullptr;
@@ -117,8 +161,8 @@ static void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
 }
 
 // ---------- ETAPA 2: dimenzije scene ----------
-static const int NUM_FLOORS = 8;          // SU, PR, 1..6
-static const float FLOOR_H = 3.0f;        // visina sprata
+// broj i visine spratova dolaze iz building.cfg
+static std::vector<float> gFloorY;        // visina poda svakog sprata
 static const float SLAB_THICK = 0.12f;
 
 static const float HALL_W = 12.0f;        // širina hodnika (x)
@@ -134,18 +178,23 @@ static const float SHAFT_D = 2.6f;
 static float getShaftX() {
     return HALL_W * 0.5f + SHAFT_W * 0.5f - 0.35f;
 }
-static Elevator* gElev = nullptr;
+static SimThread* gSim = nullptr;      // lift se vrti na svojoj niti, ovde idu samo komande
+static ElevatorSnapshot gElevState{};  // poslednje stanje lifta koje je prozor procitao
+static FloorMask gServedFloors;        // spratovi na kojima lift staje (zona iz building.cfg), ostali tasteri su ugaseni
 
 static int floorFromCameraY() {
     // kamera je na visini +1.7, uzmi "pod" sprata kao reference
     float yFloor = gCamera ? (gCamera->Position.y - 1.7f) : 0.0f;
-    int idx = (int)std::round(yFloor / FLOOR_H);
-    if (idx < 0) idx = 0;
-    if (idx > NUM_FLOORS - 1) idx = NUM_FLOORS - 1;
+    if (gFloorY.empty()) return 0;
+
+    // najblizi sprat (binarna pretraga, visine ne moraju biti iste)
+    int idx = (int)(std::upper_bound(gFloorY.begin(), gFloorY.end(), yFloor) - gFloorY.begin());
+    if (idx >= (int)gFloorY.size()) return (int)gFloorY.size() - 1;
+    if (idx > 0 && yFloor - gFloorY[idx - 1] < gFloorY[idx] - yFloor) --idx;
     return idx;
 }
 
-static bool isAtElevatorEntrance(const Camera& cam, const Elevator& elev) {
+static bool isAtElevatorEntrance(const Camera& cam, const ElevatorSnapshot& elev) {
     float wallX = HALL_W * 0.5f;
     float x = cam.Position.x;
     float z = cam.Position.z;
@@ -153,7 +202,7 @@ static bool isAtElevatorEntrance(const Camera& cam, const Elevator& elev) {
     // Proširi opseg detekcije da bi "hvatao" trenutak prolaska kroz vrata
     bool nearX = std::fabs(x - wallX) < 1.0f;
     bool nearZ = std::fabs(z - 0.0f) < (PORTAL_W * 0.6f);
-    bool doorsOpen = elev.DoorOpen() > 0.80f;
+    bool doorsOpen = elev.doorOpen > 0.80f;
     bool atFloor = elev.IsExactlyAtFloor(floorFromCameraY());
 
     return nearX && nearZ && doorsOpen && atFloor;
@@ -161,25 +210,25 @@ static bool isAtElevatorEntrance(const Camera& cam, const Elevator& elev) {
 
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action != GLFW_PRESS) return;
-    if (!gElev) return;
+    if (!gSim) return;
 
-    // Spratovi: F1..F8 = SU, PR, 1,2,3,4,5,6
-    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F8) {
-        int idx = key - GLFW_KEY_F1; // 0..7
-        gElev->RequestFloor(idx);
+    // Spratovi: F1..F12 = prvih 12 spratova (SU, PR, 1, 2, ...)
+    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F12) {
+        int idx = key - GLFW_KEY_F1;
+        if (idx < (int)gFloorY.size()) gSim->post(ElevatorCommandType::RequestFloor, idx);
         return;
     }
     // Pozovi lift na sprat na kom si (dev test) - C
     if (key == GLFW_KEY_C) {
         // Ako si van lifta -> pozovi lift na svoj sprat
         if (!gInElevator) {
-            gElev->CallToFloor(floorFromCameraY());
+            gSim->post(ElevatorCommandType::CallToFloor, floorFromCameraY());
         }
         // Ako si na ulazu i vrata su otvorena -> udji/izadji
         else {
             // ako si unutra i vrata otvorena, izlazak je dozvoljen
             // (izlazak ćemo rešiti tako što te teleportujemo malo u hodnik)
-            if (gCamera && isAtElevatorEntrance(*gCamera, *gElev)) {
+            if (gCamera && isAtElevatorEntrance(*gCamera, gElevState)) {
                 gInElevator = false;
                 // izbaci malo u hodnik (ka -X)
                 gCamera->Position.x -= 1.2f;
@@ -188,14 +237,21 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
         return;
     }
     // Vrata: E = OPEN (extend), Q = CLOSE
-    if (key == GLFW_KEY_E) { gElev->PressOpen(); return; }
-    if (key == GLFW_KEY_Q) { gElev->PressClose(); return; }
+    if (key == GLFW_KEY_E) { gSim->post(ElevatorCommandType::Open); return; }
+    if (key == GLFW_KEY_Q) { gSim->post(ElevatorCommandType::Close); return; }
 
     // STOP: Space (pauza/resume tokom kretanja)
-    if (key == GLFW_KEY_SPACE) { gElev->PressStopToggle(); return; }
+    if (key == GLFW_KEY_SPACE) { gSim->post(ElevatorCommandType::StopToggle); return; }
 
     // Vent: V (auto-off na prvom target spratu)
-    if (key == GLFW_KEY_V) { gElev->ToggleVent(); return; }
+    if (key == GLFW_KEY_V) { gSim->post(ElevatorCommandType::Vent); return; }
+
+    // Raspored opsluzivanja: L = FIFO <-> LOOK
+    if (key == GLFW_KEY_L) { gSim->post(ElevatorCommandType::ToggleScheduling); return; }
+
+    // Generisani putnici (profil iz main): T = ukljuci/iskljuci
+    // (poruku ispisuje glavna petlja kad nit zaista promeni stanje)
+    if (key == GLFW_KEY_T) { gSim->post(ElevatorCommandType::ToggleTraffic); return; }
 }
 
 
@@ -227,6 +283,23 @@ static void drawBox(GLint uM, const glm::vec3& pos, const glm::vec3& scale) {
     drawCube();
 }
 
+// Oznake i ikonice su u jednom atlasu: vezuje stranu atlasa i preko
+// uTexOffset/uTexScale svodi UV 0..1 na podoblast slike
+static GLint gTexOffsetLoc = -1, gTexScaleLoc = -1;
+
+static void bindAtlasRegion(const AtlasRegion& region) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, region.texture);
+    glUniform2f(gTexOffsetLoc, region.u0, region.v0);
+    glUniform2f(gTexScaleLoc, region.u1 - region.u0, region.v1 - region.v0);
+}
+
+// vraca UV na celu teksturu (bez tilovanja)
+static void unbindAtlasRegion() {
+    glUniform2f(gTexOffsetLoc, 0.0f, 0.0f);
+    glUniform2f(gTexScaleLoc, 1.0f, 1.0f);
+}
+
 static glm::vec3 cameraForwardFromView(const Camera& cam) {
     // forward iz view matrice (ne zavisi od toga da li Camera ima "Front" polje)
     glm::mat4 invV = glm::inverse(cam.GetViewMatrix());
@@ -239,12 +312,12 @@ static bool pointInRect(float x, float y, float cx, float cy, float w, float h)
         y >= cy - h * 0.5f && y <= cy + h * 0.5f);
 }
 
-// Vraca id dugmeta (0..11) ili -1 ako ne "gađa" panel.
-static int hitTestPanelCenterRay(const Camera& cam, const Elevator& elev) {
+// Vraca id dugmeta (sprat ili BTN_*) ili -1 ako ne "gađa" panel.
+static int hitTestPanelCenterRay(const Camera& cam, const ElevatorSnapshot& elev) {
     if (!gInElevator) return -1; // Klik radi samo kad smo unutra
 
     float shaftX = getShaftX();
-    float cabinBaseY = elev.CabinBaseY();
+    float cabinBaseY = elev.cabinBaseY;
 
     float leftWallZ = -CABIN_D * 0.5f;
     float panelCenterZ = leftWallZ + (PANEL_THICK * 0.5f) + 0.01f;
@@ -279,44 +352,109 @@ static int hitTestPanelCenterRay(const Camera& cam, const Elevator& elev) {
     return -1;
 }
 
+// Pozivni taster na spratu kamere koji "gađaš" pogledom: +1 gore, -1 dole, 0 nijedan.
+// Najnizi sprat nema taster dole, najvisi nema gore.
+static int hitTestHallCenterRay(const Camera& cam) {
+    if (gInElevator || gFloorY.empty()) return 0;
+
+    int floorIdx = floorFromCameraY();
+    float faceX = HALL_W * 0.5f - WALL_THICK * 0.5f - HALL_BTN_THICK;
+
+    glm::vec3 O = cam.Position;
+    glm::vec3 D = glm::normalize(cameraForwardFromView(cam));
+    if (D.x < 1e-4f) return 0;   // tasteri gledaju ka -X, pogled mora biti ka zidu
+
+    float t = (faceX - O.x) / D.x;
+    if (t < 0.0f || t > HALL_BTN_REACH) return 0;
+
+    glm::vec3 hit = O + D * t;
+    float v = hit.y - gFloorY[floorIdx];
+    float half = HALL_BTN_SIZE * 0.5f;
+    if (std::fabs(hit.z - HALL_BTN_Z) > half) return 0;
+    if (floorIdx + 1 < (int)gFloorY.size() && std::fabs(v - HALL_BTN_UP_Y) <= half) return 1;
+    if (floorIdx > 0 && std::fabs(v - HALL_BTN_DOWN_Y) <= half) return -1;
+    return 0;
+}
+
 static void activatePanelButton(int id) {
-    if (!gElev) return;
+    if (!gSim) return;
 
-    // Spratovi (SU=0, PR=1, 1=2, ... 6=7)
-    if (id >= BTN_F0 && id <= BTN_F7) {
+    // Spratovi (SU=0, PR=1, 1=2, ...): poziv, a vrata se zatvaraju ako je drugi sprat
+    if (isFloorButton(id)) {
         int floorIdx = id;                 // direktno mapiranje (kod tebe je već tako)
-        gElev->RequestFloor(floorIdx);
-
-        // Ako biras DRUGI sprat, zatvori vrata odmah da krene bez čekanja
-        if (floorIdx != gElev->CurrentFloor()) {
-            gBtnLit[id] = true;
-            gElev->PressClose();            // radi samo ako su vrata otvorena/otvaraju se
-        }
+        if (!gServedFloors.test(floorIdx)) return; // ugasen taster, lift tu ne staje
+        gSim->post(ElevatorCommandType::PanelFloor, floorIdx);
         return;
     }
 
     // Ostali tasteri
-    if (id == BTN_OPEN) { gElev->PressOpen(); return; }
-    if (id == BTN_CLOSE) { gElev->PressClose(); return; }
-    if (id == BTN_STOP) { gElev->PressStopToggle(); return; }
-    if (id == BTN_VENT) { gElev->ToggleVent(); return; }
+    if (id == BTN_OPEN) { gSim->post(ElevatorCommandType::Open); return; }
+    if (id == BTN_CLOSE) { gSim->post(ElevatorCommandType::Close); return; }
+    if (id == BTN_STOP) { gSim->post(ElevatorCommandType::StopToggle); return; }
+    if (id == BTN_VENT) { gSim->post(ElevatorCommandType::Vent); return; }
 }
 
 
 static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
-    if (!gCamera || !gElev) return;
-    if (!gInElevator) return;
+    if (!gCamera || !gSim) return;
+
+    // u hodniku: pozivni taster gore/dole pored vrata lifta
+    if (!gInElevator) {
+        int hall = hitTestHallCenterRay(*gCamera);
+        if (hall != 0 && gServedFloors.test(floorFromCameraY())) {
+            gSim->post(hall > 0 ? ElevatorCommandType::CallUp : ElevatorCommandType::CallDown, floorFromCameraY());
+        }
+        return;
+    }
 
-    int id = hitTestPanelCenterRay(*gCamera, *gElev);
+    int id = hitTestPanelCenterRay(*gCamera, gElevState);
     if (id != -1) {
         activatePanelButton(id);
     }
 }
 
+// Pozivni tasteri jednog sprata; svetle dok lift ne dodje u tom smeru
+static void drawHallButtons(GLint uM, GLint uColor, GLint uUseTex, int floorIdx, const ElevatorSnapshot& elev) {
+    float x = HALL_W * 0.5f - WALL_THICK * 0.5f - HALL_BTN_THICK * 0.5f;
+    float y = gFloorY[floorIdx];
+    bool cameraFloor = !gInElevator && floorIdx == floorFromCameraY();
+
+    glUniform1i(uUseTex, 0);
+
+    // plocica ispod tastera
+    glUniform4f(uColor, 0.15f, 0.15f, 0.17f, 1.0f);
+    drawBox(uM,
+        glm::vec3(x + HALL_BTN_THICK * 0.25f, y + 0.5f * (HALL_BTN_UP_Y + HALL_BTN_DOWN_Y), HALL_BTN_Z),
+        glm::vec3(HALL_BTN_THICK * 0.5f, HALL_BTN_UP_Y - HALL_BTN_DOWN_Y + 2.0f * HALL_BTN_SIZE, 2.0f * HALL_BTN_SIZE));
+
+    for (int dir = 1; dir >= -1; dir -= 2) {
+        if (dir > 0 && floorIdx + 1 >= (int)gFloorY.size()) continue;
+        if (dir < 0 && floorIdx == 0) continue;
+
+        bool lit = (dir > 0) ? elev.hallUp.test(floorIdx) : elev.hallDown.test(floorIdx);
+        bool hover = cameraFloor && gHoverHall == dir;
+        if (!gServedFloors.test(floorIdx)) {
+            // lift ovde ne staje: ugasen taster
+            glUniform4f(uColor, 0.22f, 0.22f, 0.24f, 1.0f);
+        }
+        else if (lit) {
+            if (hover) glUniform4f(uColor, 1.00f, 0.95f, 0.55f, 1.0f);
+            else       glUniform4f(uColor, 0.95f, 0.85f, 0.30f, 1.0f);
+        }
+        else {
+            if (hover) glUniform4f(uColor, 0.70f, 0.70f, 0.72f, 1.0f);
+            else       glUniform4f(uColor, 0.50f, 0.50f, 0.52f, 1.0f);
+        }
+
+        float by = y + ((dir > 0) ? HALL_BTN_UP_Y : HALL_BTN_DOWN_Y);
+        drawBox(uM, glm::vec3(x, by, HALL_BTN_Z), glm::vec3(HALL_BTN_THICK, HALL_BTN_SIZE, HALL_BTN_SIZE));
+    }
+}
+
 // Crta panel + dugmad (sa hover highlight) , jako komplikovano jer crta teksturu na vrh dugmeta a ne sa strabe
 static void drawElevatorPanel(GLint uM, GLint uColor, GLint uUseTex, GLint uTransparent,
-    const GLuint* btnTextures, const Elevator& elev)
+    const ElevatorSnapshot& elev)
 {
     // --- Jedan mali VAO/VBO za "nalepnicu" (quad) sa ispravnim atributima:
     // layout(location=0)=pos, (1)=col, (2)=tex
@@ -362,7 +500,7 @@ static void drawElevatorPanel(GLint uM, GLint uColor, GLint uUseTex, GLint uTran
     glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &prevVAO);
 
     float shaftX = getShaftX();
-    float cabinBaseY = elev.CabinBaseY();
+    float cabinBaseY = elev.cabinBaseY;
 
     float leftWallZ = -CABIN_D * 0.5f;
     float panelCenterZ = leftWallZ + (PANEL_THICK * 0.5f) + 0.01f;
@@ -381,7 +519,9 @@ static void drawElevatorPanel(GLint uM, GLint uColor, GLint uUseTex, GLint uTran
     for (const PanelBtn& b : gPanelBtns)
     {
         bool hover = (b.id == gHoverBtn);
-        bool lit = (b.id >= BTN_F0 && b.id <= BTN_F7) ? gBtnLit[b.id] : false;
+        // taster sprata svetli dok se ne stigne do sprata
+        bool lit = isFloorButton(b.id) && elev.carCalls.test(b.id);
+        bool served = !isFloorButton(b.id) || gServedFloors.test(b.id);
 
         glm::vec3 btnPos(
             panelCenter.x + b.cx,
@@ -392,7 +532,11 @@ static void drawElevatorPanel(GLint uM, GLint uColor, GLint uUseTex, GLint uTran
         // 2) Telo dugmeta (bez teksture)
         glUniform1i(uUseTex, 0);
         glUniform1i(uTransparent, 0);
-        if (lit) {
+        if (!served) {
+            // sprat van zone: ugaseno
+            glUniform4f(uColor, 0.22f, 0.22f, 0.24f, 1.0f);
+        }
+        else if (lit) {
             // "svetli" (topla žuta)
             if (hover) glUniform4f(uColor, 1.00f, 0.95f, 0.55f, 1.0f);
             else       glUniform4f(uColor, 0.95f, 0.85f, 0.30f, 1.0f);
@@ -407,15 +551,13 @@ static void drawElevatorPanel(GLint uM, GLint uColor, GLint uUseTex, GLint uTran
         drawBox(uM, btnPos, glm::vec3(b.w, b.h, BTN_THICK));
 
         // 3) Ikonica (tekstura) kao JEDAN QUAD, tačno na PREDNJOJ strani dugmeta
-        GLuint tex = btnTextures[b.id];
-        if (tex != 0)
+        if (b.icon.texture != 0)
         {
             glUniform1i(uUseTex, 1);
             glUniform1i(uTransparent, 1);
             glUniform4f(uColor, 1.0f, 1.0f, 1.0f, 1.0f);
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, tex);
+            bindAtlasRegion(b.icon);
 
             // Najbitniji fix: stavi nalepnicu ISPRED prednje face dugmeta
             float zFront = btnPos.z + (BTN_THICK * 0.5f) + 0.0015f;
@@ -427,6 +569,7 @@ static void drawElevatorPanel(GLint uM, GLint uColor, GLint uUseTex, GLint uTran
 
             glBindVertexArray(sQuadVAO);
             glDrawArrays(GL_TRIANGLES, 0, 6);
+            unbindAtlasRegion();
 
             // vrati cube VAO da sledeci drawBox radi normalno
             glBindVertexArray((GLuint)prevVAO);
@@ -461,17 +604,17 @@ static void drawCrosshairHUD(GLint uM, GLint uV, GLint uP, GLint uColor) {
 
 // Crta pravougaonu tablicu sa teksturom oznake sprata
 static void drawFloorSign(GLint uM, GLint uUseTex, GLint uColor, GLint uTransparent,
-    GLuint texture, const glm::vec3& pos, float width, float height) {
-    if (texture != 0) {
+    const AtlasRegion& sign, const glm::vec3& pos, float width, float height) {
+    if (sign.texture != 0) {
         glUniform1i(uUseTex, 1);
         glUniform1i(uTransparent, 1);  // omogući transparency za PNG
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        bindAtlasRegion(sign);
         glUniform4f(uColor, 1.0f, 1.0f, 1.0f, 1.0f);
 
         // Tablica je tanka (po X osi jer je na zidu)
         drawBox(uM, pos, glm::vec3(0.02f, -height, -width));
 
+        unbindAtlasRegion();
         glUniform1i(uUseTex, 0);
         glUniform1i(uTransparent, 0);
     }
@@ -531,6 +674,15 @@ static void drawTexturedQuad(GLuint shader, GLint uM, GLuint tex,
 }
 
 int main() {
+    // Zgrada (spratovi, visine, brzina, vrata, zone) iz building.cfg; 3D prikazuje prvi lift grupe
+    BuildingConfig building;
+    building.carCount = 1;
+    building.carSpeed = 2.0f;
+    building.doorAnimDuration = 1.0f / 1.8f;
+    if (!loadBuildingConfig("building.cfg", building)) {
+        std::cout << "Koristim podrazumevanu zgradu.\n";
+    }
+
     if (!glfwInit()) {
         std::cout << "GLFW nije inicijalizovan.\n";
         return 1;
@@ -584,50 +736,77 @@ int main() {
     int uUseTex = glGetUniformLocation(shader, "useTex");
     int uTexScale = glGetUniformLocation(shader, "uTexScale");
     int uTransparent = glGetUniformLocation(shader, "transparent");
+    gTexScaleLoc = uTexScale;
+    gTexOffsetLoc = glGetUniformLocation(shader, "uTexOffset");
 
     // default stanje
     glUniform1i(uTex, 0);
     glUniform1i(uUseTex, 0);
     glUniform2f(uTexScale, 1.0f, 1.0f);
+    glUniform2f(gTexOffsetLoc, 0.0f, 0.0f);
     glUniform1i(uTransparent, 0);
 
     // --- ucitaj teksture (iz res foldera) ---
     GLuint texFloor = loadImageToTexture("res/pod2.jpg");
     GLuint texWall = loadImageToTexture("res/zid.jpg");
 
-    // Oznake spratova
-    GLuint texFloorSigns[NUM_FLOORS];
-    texFloorSigns[0] = loadImageToTexture("res/floor_SU.png");
-    texFloorSigns[1] = loadImageToTexture("res/floor_PR.png");
-    texFloorSigns[2] = loadImageToTexture("res/floor1.png");
-    texFloorSigns[3] = loadImageToTexture("res/floor2.png");
-    texFloorSigns[4] = loadImageToTexture("res/floor3.png");
-    texFloorSigns[5] = loadImageToTexture("res/floor4.png");
-    texFloorSigns[6] = loadImageToTexture("res/floor5.png");
-    texFloorSigns[7] = loadImageToTexture("res/floor6.png");
-
-    // --- U main funkciji, kod ucitavanja tekstura ---
-    GLuint texPanelBtns[12]; // 0-7 su spratovi, 8 OPEN, 9 CLOSE, 10 STOP, 11 VENT
-    texPanelBtns[0] = loadImageToTexture("res/floor_SU.png");
-    texPanelBtns[1] = loadImageToTexture("res/floor_PR.png");
-    texPanelBtns[2] = loadImageToTexture("res/floor1.png");
-    texPanelBtns[3] = loadImageToTexture("res/floor2.png");
-    texPanelBtns[4] = loadImageToTexture("res/floor3.png");
-    texPanelBtns[5] = loadImageToTexture("res/floor4.png");
-    texPanelBtns[6] = loadImageToTexture("res/floor5.png");
-    texPanelBtns[7] = loadImageToTexture("res/floor6.png");
-    texPanelBtns[8] = loadImageToTexture("res/open.png");
-    texPanelBtns[9] = loadImageToTexture("res/close.png");
-    texPanelBtns[10] = loadImageToTexture("res/stop.png");
-    texPanelBtns[11] = loadImageToTexture("res/fan.png");
-
-    // --- Kamera ---
-    float prY = 2.0f * FLOOR_H; // PR je index 1: SU(0), PR(1)
-    Camera camera(glm::vec3(-2.0f, prY + 1.7f, 4.0f));
+    // Oznake spratova i ikonice dugmadi idu u jedan atlas (pod i zid ostaju
+    // zasebne teksture jer se tiluju)
+    // Oznake spratova: res/floor_SU.png, floor_PR.png, floor1.png, ... (sprat bez slike nema oznaku)
+    int numFloors = building.floorCount;
+    TextureAtlas atlas;
+    std::vector<std::string> floorSignNames(numFloors);
+    for (int i = 0; i < numFloors; ++i) {
+        std::string label = building.getFloorLabel(i);
+        bool numbered = (label[0] >= '0' && label[0] <= '9');
+        std::string path = "res/floor" + (numbered ? label : "_" + label) + ".png";
+        if (std::ifstream(path)) {
+            floorSignNames[i] = "floor" + label;
+            atlas.add(floorSignNames[i], path);
+        }
+    }
+
+    // Dugmad panela: spratovi koriste iste oznake, pa OPEN, CLOSE, STOP, VENT
+    atlas.add("open", "res/open.png");
+    atlas.add("close", "res/close.png");
+    atlas.add("stop", "res/stop.png");
+    atlas.add("fan", "res/fan.png");
+    atlas.build();
+
+    std::vector<AtlasRegion> texFloorSigns(numFloors);
+    for (int i = 0; i < numFloors; ++i) {
+        texFloorSigns[i] = atlas.get(floorSignNames[i]);
+    }
+    AtlasRegion texControlBtns[4] = { atlas.get("open"), atlas.get("close"), atlas.get("stop"), atlas.get("fan") };
+    buildPanelButtons(texFloorSigns, texControlBtns);
+
+    // --- Spratovi ---
+    gFloorY.resize(numFloors);
+    for (int i = 0; i < numFloors; ++i) {
+        gFloorY[i] = building.getFloorElevation(i);
+    }
+
+    // --- Kamera --- (na spratu na kom lift krece)
+    float startY = gFloorY[building.startFloor];
+    Camera camera(glm::vec3(-2.0f, startY + 1.7f, 4.0f));
     gCamera = &camera;
 
-    Elevator elevator(NUM_FLOORS, FLOOR_H, ELEV_START_FLOOR_IDX);
-    gElev = &elevator;
+    Elevator elevator(gFloorY, building.startFloor,
+                      MotionLimits(building.carSpeed, building.carAccel, building.carJerk),
+                      building.doorAnimDuration, building.doorOpenTime);
+    // 3D prikazuje prvi lift grupe: staje samo u njegovoj zoni
+    gServedFloors.clear();
+    for (int i = 0; i < numFloors; ++i) {
+        if (building.servesFloor(0, i)) gServedFloors.set(i);
+    }
+    elevator.SetServedFloors(gServedFloors);
+    // generisani putnici za T: medjuspratni saobracaj, 60 putnika na sat
+    TrafficProfile trafficProfile;
+    makeTrafficProfile("interfloor", building, 60.0, trafficProfile);
+    SimThread simThread(elevator, &trafficProfile);
+    gSim = &simThread;
+    gElevState = simThread.latest();
+    simThread.start();
 
     // --- Kocka VAO (format: pos(3), col(4), tex(2)) ---
     float v[] = {
@@ -703,27 +882,12 @@ int main() {
         gLastFrame = current;
 
         processInput(window);
-        elevator.Update(gDeltaTime);
-
-        // Ugasi taster sprata kad lift stigne i vrata su potpuno otvorena
-        static bool sWasFullyOpen = false;
-
-        bool fullyOpen = (elevator.DoorOpen() > 0.99f);
-
-        // detektuj prelaz "nije bilo potpuno otvoreno" -> "sad je potpuno otvoreno"
-        if (fullyOpen && !sWasFullyOpen) {
-            int idx = (int)std::round(elevator.CabinBaseY() / FLOOR_H);
-            if (idx < 0) idx = 0;
-            if (idx > NUM_FLOORS - 1) idx = NUM_FLOORS - 1;
-
-            // spratovi su BTN_F0..BTN_F7 == 0..7
-            if (idx >= 0 && idx <= 7) {
-                gBtnLit[idx] = false;
-            }
+        bool trafficWasOn = gElevState.trafficOn;
+        gElevState = simThread.latest();
+        if (gElevState.trafficOn != trafficWasOn) {
+            std::cout << (gElevState.trafficOn ? "Saobracaj ukljucen.\n" : "Saobracaj iskljucen.\n");
         }
 
-        sWasFullyOpen = fullyOpen;
-
 
         // --- Unutar main while petlje, pre crtanja ---
 
@@ -732,7 +896,7 @@ int main() {
             float shaftX = getShaftX();
             // Ako je kamera prešla granicu hodnika i ušla u prostor kabine po X osi
             // i ako su vrata otvorena (to proverava isAtElevatorEntrance)
-            if (gCamera->Position.x > (HALL_W * 0.5f - 0.2f) && isAtElevatorEntrance(*gCamera, *gElev)) {
+            if (gCamera->Position.x > (HALL_W * 0.5f - 0.2f) && isAtElevatorEntrance(*gCamera, gElevState)) {
                 gInElevator = true;
             }
         }
@@ -748,7 +912,7 @@ int main() {
         // 3. Logika za "zaključavanje" unutar lifta dok se on kreće ili dok si unutra
         if (gInElevator && gCamera) {
             // Y osa uvek prati pod lifta
-            gCamera->Position.y = elevator.CabinBaseY() + 1.7f;
+            gCamera->Position.y = gElevState.cabinBaseY + 1.7f;
 
             // OGRANIČENJE KRETANJA UNUTAR KABINE
             // Ne dozvoljavamo kameri da izađe kroz zadnji ili bočne zidove kabine
@@ -760,7 +924,7 @@ int main() {
 
             if (gCamera->Position.x > maxX) gCamera->Position.x = maxX;
             // Ako su vrata zatvorena, ne možeš ni napred (ka hodniku)
-            if (gElev->DoorOpen() < 0.1f) {
+            if (gElevState.doorOpen < 0.1f) {
                 if (gCamera->Position.x < minX) gCamera->Position.x = minX;
             }
 
@@ -768,9 +932,10 @@ int main() {
             if (gCamera->Position.z > maxZ) gCamera->Position.z = maxZ;
         }
         gHoverBtn = -1;
-        if (gCamera && gElev && gInElevator) {
-            gHoverBtn = hitTestPanelCenterRay(*gCamera, *gElev);
+        if (gCamera && gInElevator) {
+            gHoverBtn = hitTestPanelCenterRay(*gCamera, gElevState);
         }
+        gHoverHall = gCamera ? hitTestHallCenterRay(*gCamera) : 0;
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -790,8 +955,8 @@ int main() {
         glBindVertexArray(VAO);
 
         // ---------- Spratovi ----------
-        for (int i = 0; i < NUM_FLOORS; i++) {
-            float y = i * FLOOR_H;
+        for (int i = 0; i < numFloors; i++) {
+            float y = gFloorY[i];
 
             // POD (tekstura)
             if (texFloor != 0) {
@@ -877,6 +1042,7 @@ int main() {
             glUniform1i(uUseTex, 0);
             glUniform2f(uTexScale, 1.0f, 1.0f);
 
+            drawHallButtons(uM, uColor, uUseTex, i, gElevState);
 
             // Spoljna vrata lifta na spratu (za sada ZATVORENA)
             // Stojimo malo unutar hodnika (pomeri po X ka unutra)
@@ -884,7 +1050,7 @@ int main() {
 
             float doorX = wallX - (WALL_THICK * 0.5f) - (HALL_DOOR_THICK * 0.5f) - 0.01f;
 
-            float open = (elevator.IsExactlyAtFloor(i) ? elevator.DoorOpen() : 0.0f);
+            float open = (gElevState.IsExactlyAtFloor(i) ? gElevState.doorOpen : 0.0f);
 
             // otvara se od sredine ka spolja
             float zShift = open * (PORTAL_W * 0.25f);
@@ -937,8 +1103,8 @@ int main() {
         // ---------- Okvir okna lifta (NE kao puna kocka, da se vidi kabina) ----------
         float shaftX = getShaftX();
         // ---------- Kabina lifta (obojena) ----------
-        float cabinBaseY = elevator.CabinBaseY();
-        float openCabin = elevator.DoorOpen();
+        float cabinBaseY = gElevState.cabinBaseY;
+        float openCabin = gElevState.doorOpen;
 
 
         // telo kabine - teksturisano (da se jasno razlikuje od hodnika)
@@ -1026,7 +1192,7 @@ int main() {
             glm::vec3(CABIN_DOOR_DEPTH, CABIN_H, CABIN_D * 0.5f - CABIN_DOOR_GAP)
         );
 
-        drawElevatorPanel(uM, uColor, uUseTex, uTransparent, texPanelBtns, elevator);
+        drawElevatorPanel(uM, uColor, uUseTex, uTransparent, gElevState);
         glUniform4f(uColor, 0.9f, 0.2f, 0.9f, 1.0f);
 
         drawCrosshairHUD(uM, uV, uP, uColor);
@@ -1038,6 +1204,8 @@ int main() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteProgram(shader);
 
+    simThread.stop();
+    gSim = nullptr;
     glfwTerminate();
     return 0;
 }